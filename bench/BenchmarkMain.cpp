@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+#include "Log.h"
+#include <cstring>
+#include <vector>
+
+// Same as BENCHMARK_MAIN, except results go to stdout as JSON unless a
+// format is given, so runs can be diffed between releases as they are.
+// The log writes INFO to stdout too, so only warnings and errors are
+// let through, and those go to stderr.
+int main(int argc, char* argv[]) {
+    Log::setLevel(LogLevel::WARN);
+    std::vector<char*> args(argv, argv + argc);
+    bool hasFormat = false;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--benchmark_format", 18) == 0) {
+            hasFormat = true;
+        }
+    }
+    char jsonFormat[] = "--benchmark_format=json";
+    if (!hasFormat) {
+        args.push_back(jsonFormat);
+    }
+    int count = (int)args.size();
+
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
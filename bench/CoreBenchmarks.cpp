@@ -0,0 +1,182 @@
+#include <benchmark/benchmark.h>
+#include "Economy.h"
+#include "Geodesy.h"
+#include "Scenario.h"
+#include "Snapshot.h"
+#include "Timetable.h"
+#include "Train.h"
+#include "TrainLine.h"
+#include "World.h"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+static const float TICK = 1.0f / 60.0f;
+
+// range(0): trains, one per line. One iteration advances the clock a tick
+// and reads every train's state from the timetable, as a world tick does.
+static void BM_TrainState(benchmark::State& state) {
+    int count = state.range(0);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> lengthDist(1.0, 50.0);
+
+    std::vector<TrainLine> lines;
+    std::vector<Train> trains;
+    lines.reserve(count);
+    trains.reserve(count);
+    for (int i = 0; i < count; i++) {
+        lines.emplace_back(i, 2 * i, 2 * i + 1);
+        lines.back().setLength(lengthDist(gen));
+        trains.emplace_back(i, i, World::TRAIN_CAPACITY);
+    }
+    Timetable timetable;
+    timetable.compile(lines, trains, 0.0);
+
+    double simTime = 0.0;
+    for (auto _ : state) {
+        simTime += TICK;
+        for (int i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(timetable.getTrainState(i, simTime));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_TrainState)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): entities per account kind. One iteration records a tick of
+// revenue for every entity, then settles the month.
+static void BM_EconomySettlement(benchmark::State& state) {
+    int count = state.range(0);
+    Economy economy;
+    Ledger& ledger = economy.getLedger();
+    for (int i = 0; i < count; i++) {
+        ledger.setUpkeep(LedgerAccount::STATION, i, 100.0);
+        ledger.setUpkeep(LedgerAccount::LINE, i, 250.0);
+        ledger.setUpkeep(LedgerAccount::TRAIN, i, 200.0);
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            economy.recordRevenue(LedgerAccount::STATION, i, 1.0);
+            economy.recordRevenue(LedgerAccount::LINE, i, 1.0);
+            economy.recordRevenue(LedgerAccount::TRAIN, i, 1.0);
+        }
+        economy.update(30.0f);
+        benchmark::DoNotOptimize(economy.getMoney());
+    }
+    state.SetItemsProcessed(state.iterations() * count * 3);
+}
+BENCHMARK(BM_EconomySettlement)->RangeMultiplier(8)->Range(64, 32768);
+
+// Destinations scattered over Europe, the same for every distance benchmark
+static void makeDestinations(int count, std::vector<double>& lats, std::vector<double>& lons) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> latDist(35.0, 60.0);
+    std::uniform_real_distribution<double> lonDist(-10.0, 25.0);
+    lats.resize(count);
+    lons.resize(count);
+    for (int i = 0; i < count; i++) {
+        lats[i] = latDist(gen);
+        lons[i] = lonDist(gen);
+    }
+}
+
+// range(0): destinations per batch
+static void BM_HaversineBatch(benchmark::State& state) {
+    int count = state.range(0);
+    std::vector<double> lats, lons, out(count);
+    makeDestinations(count, lats, lons);
+
+    for (auto _ : state) {
+        haversineKmBatch(52.37, 4.90, lats.data(), lons.data(), count, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HaversineBatch)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): destinations, one haversineKm call each; the baseline for
+// BM_HaversineBatch at the same sizes
+static void BM_HaversineScalar(benchmark::State& state) {
+    int count = state.range(0);
+    std::vector<double> lats, lons, out(count);
+    makeDestinations(count, lats, lons);
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            out[i] = haversineKm(52.37, 4.90, lats[i], lons[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HaversineScalar)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): destinations, one fastDistanceKm call each. Most of Europe is
+// beyond SHORT_RANGE_KM, so this mixes both branches.
+static void BM_FastDistance(benchmark::State& state) {
+    int count = state.range(0);
+    std::vector<double> lats, lons, out(count);
+    makeDestinations(count, lats, lons);
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            out[i] = fastDistanceKm(52.37, 4.90, lats[i], lons[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FastDistance)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): stations in a synthetic scenario with two trains per line
+static void BM_WorldTick(benchmark::State& state) {
+    World world;
+    world.setReporting(false);
+    ScenarioOptions options;
+    options.stationCount = state.range(0);
+    options.extraLineCount = state.range(0) / 2;
+    buildScenario(world, options);
+    // The first tick builds every routing tree; time the steady state
+    world.update(TICK);
+
+    for (auto _ : state) {
+        world.update(TICK);
+    }
+    state.counters["trains"] = world.getTrains().size();
+}
+BENCHMARK(BM_WorldTick)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+
+// range(0): stations in a saved scenario; times open, validation and load
+static void BM_SnapshotLoad(benchmark::State& state) {
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("trainbuilder_bench_" + std::to_string(state.range(0)) + ".tbsave")).string();
+    {
+        World world;
+        world.setReporting(false);
+        ScenarioOptions options;
+        options.stationCount = state.range(0);
+        options.extraLineCount = state.range(0) / 2;
+        buildScenario(world, options);
+        world.update(TICK);
+        if (!world.writeSnapshot(path, SnapshotWorld{})) {
+            state.SkipWithError("could not write the snapshot");
+            return;
+        }
+    }
+
+    World world;
+    world.setReporting(false);
+    for (auto _ : state) {
+        SnapshotReader reader;
+        if (!reader.open(path) || !World::validateSnapshot(reader)) {
+            state.SkipWithError("could not read the snapshot");
+            break;
+        }
+        world.loadSnapshot(reader);
+    }
+    std::remove(path.c_str());
+    state.counters["stations"] = world.getStations().size();
+}
+BENCHMARK(BM_SnapshotLoad)->RangeMultiplier(4)->Range(64, 4096)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,229 @@
+#include <benchmark/benchmark.h>
+#include "CityRenderer.h"
+#include "MapRenderer.h"
+#include "UI.h"
+#include <SDL2/SDL_image.h>
+#include <random>
+#include <string>
+#include <vector>
+
+// Front-end benchmarks draw with the software renderer into an offscreen
+// surface, so they need no display or GPU
+
+static const int BENCH_ZOOM = 10;
+static const char* const BENCH_COUNTRY = "bench";
+
+static SDL_Renderer* getBenchRenderer() {
+    static SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, 1280, 720, 32, SDL_PIXELFORMAT_RGBA32);
+    static SDL_Renderer* renderer = target ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    return renderer;
+}
+
+static void randomPoints(int count, std::vector<double>& lats, std::vector<double>& lons) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> latDist(52.0, 52.8);
+    std::uniform_real_distribution<double> lonDist(4.3, 5.3);
+    lats.resize(count);
+    lons.resize(count);
+    for (int i = 0; i < count; i++) {
+        lats[i] = latDist(gen);
+        lons[i] = lonDist(gen);
+    }
+}
+
+// Write count distinct tiles of the given size into the bench country's
+// tile directory; returns false when SDL_image cannot encode them
+static bool writeBenchTiles(int count, int size) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return false;
+
+    bool ok = true;
+    std::string directory = std::string("data/") + BENCH_COUNTRY;
+    for (int i = 0; i < count && ok; i++) {
+        // Stripes give the encoder something to compress, like real tiles
+        for (int y = 0; y < size; y += 8) {
+            SDL_Rect stripe = {0, y, size, 4};
+            SDL_FillRect(surface, &stripe, 0xFF000000u | (uint32_t)(i * 2654435761u >> 8));
+        }
+        std::string path = directory + "/" + std::to_string(BENCH_ZOOM) + "_" + std::to_string(i) + "_0.png";
+        ok = IMG_SavePNG(surface, path.c_str()) == 0;
+    }
+    SDL_FreeSurface(surface);
+    return ok;
+}
+
+static std::unique_ptr<MapRenderer> makeMapRenderer() {
+    auto mapRenderer = std::make_unique<MapRenderer>(getBenchRenderer());
+    mapRenderer->init(52.37, 4.90, BENCH_ZOOM);
+    mapRenderer->setCountry(BENCH_COUNTRY);
+    return mapRenderer;
+}
+
+// range(0): points
+static void BM_LatLonToScreen(benchmark::State& state) {
+    int count = state.range(0);
+    MapRenderer mapRenderer(getBenchRenderer());
+    std::vector<double> lats, lons;
+    randomPoints(count, lats, lons);
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(mapRenderer.latLonToScreen(lats[i], lons[i], 52.37, 4.90, BENCH_ZOOM));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_LatLonToScreen)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): points
+static void BM_LatLonToScreenBatch(benchmark::State& state) {
+    int count = state.range(0);
+    MapRenderer mapRenderer(getBenchRenderer());
+    std::vector<double> lats, lons;
+    randomPoints(count, lats, lons);
+    std::vector<ScreenCoordinate> out(count);
+
+    for (auto _ : state) {
+        mapRenderer.latLonToScreen(lats.data(), lons.data(), count, 52.37, 4.90, BENCH_ZOOM, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_LatLonToScreenBatch)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): points
+static void BM_ScreenToLatLon(benchmark::State& state) {
+    int count = state.range(0);
+    MapRenderer mapRenderer(getBenchRenderer());
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> xDist(0, 1279), yDist(0, 719);
+    std::vector<int> xs(count), ys(count);
+    for (int i = 0; i < count; i++) {
+        xs[i] = xDist(gen);
+        ys[i] = yDist(gen);
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(mapRenderer.screenToLatLon(xs[i], ys[i], 52.37, 4.90, BENCH_ZOOM));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ScreenToLatLon)->RangeMultiplier(8)->Range(64, 32768);
+
+// range(0): distinct cached tiles looked up per iteration
+static void BM_GetTileHit(benchmark::State& state) {
+    int count = state.range(0);
+    auto mapRenderer = makeMapRenderer();
+    if (!writeBenchTiles(count, 256)) {
+        state.SkipWithError("cannot write bench tiles");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        mapRenderer->getTile(BENCH_ZOOM, i, 0); // warm the cache
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(mapRenderer->getTile(BENCH_ZOOM, i, 0));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GetTileHit)->RangeMultiplier(4)->Range(16, 256);
+
+// range(0): tiles that exist neither in the cache nor on disk
+static void BM_GetTileMiss(benchmark::State& state) {
+    int count = state.range(0);
+    auto mapRenderer = makeMapRenderer();
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(mapRenderer->getTile(BENCH_ZOOM, i, 1));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GetTileMiss)->RangeMultiplier(4)->Range(16, 256);
+
+// range(0): tile edge in pixels. PNG decode plus texture upload, the work
+// getTile does on a cache miss for a tile on disk.
+static void BM_TileDecode(benchmark::State& state) {
+    int size = state.range(0);
+    auto mapRenderer = makeMapRenderer();
+    if (!writeBenchTiles(1, size)) {
+        state.SkipWithError("cannot write bench tiles");
+        return;
+    }
+    std::string path = std::string("data/") + BENCH_COUNTRY + "/" + std::to_string(BENCH_ZOOM) + "_0_0.png";
+
+    for (auto _ : state) {
+        SDL_Surface* surface = IMG_Load(path.c_str());
+        SDL_Texture* texture = surface ? SDL_CreateTextureFromSurface(getBenchRenderer(), surface) : nullptr;
+        benchmark::DoNotOptimize(texture);
+        if (texture) SDL_DestroyTexture(texture);
+        if (surface) SDL_FreeSurface(surface);
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * 4);
+}
+BENCHMARK(BM_TileDecode)->Arg(256)->Arg(512)->Unit(benchmark::kMicrosecond);
+
+// range(0): bounding box edge in hundredths of a degree; districts grow
+// with the area
+static void BM_GenerateDistricts(benchmark::State& state) {
+    double extent = state.range(0) / 100.0;
+    for (auto _ : state) {
+        CityRenderer city(getBenchRenderer());
+        city.generateDistricts(50.0, 50.0 + extent, 5.0, 5.0 + extent, 1);
+        benchmark::DoNotOptimize(city.getDistricts().data());
+    }
+}
+BENCHMARK(BM_GenerateDistricts)->RangeMultiplier(2)->Range(100, 1600)->Unit(benchmark::kMicrosecond);
+
+// range(0): bounding box edge in hundredths of a degree
+static void BM_GenerateRoads(benchmark::State& state) {
+    double extent = state.range(0) / 100.0;
+    size_t districts = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        CityRenderer city(getBenchRenderer());
+        city.generateDistricts(50.0, 50.0 + extent, 5.0, 5.0 + extent, 1);
+        districts = city.getDistricts().size();
+        state.ResumeTiming();
+
+        city.generateRoads();
+        benchmark::DoNotOptimize(city.getRoads().data());
+    }
+    state.counters["districts"] = districts;
+}
+BENCHMARK(BM_GenerateRoads)->RangeMultiplier(2)->Range(100, 1600)->Unit(benchmark::kMicrosecond);
+
+// range(0): characters per string, range(1): distinct strings per frame.
+// Strings repeat every frame, as a settled UI's do.
+static void BM_DrawText(benchmark::State& state) {
+    int length = state.range(0);
+    int count = state.range(1);
+    UIRenderer ui(getBenchRenderer());
+    if (!ui.init()) {
+        state.SkipWithError("no font");
+        return;
+    }
+
+    std::vector<std::string> strings;
+    for (int i = 0; i < count; i++) {
+        std::string text;
+        for (int c = 0; c < length; c++) {
+            text += (char)('A' + (i + c) % 26);
+        }
+        strings.push_back(text);
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            ui.renderText(strings[i], 20, 20 + (i % 30) * 20, 16);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DrawText)->ArgsProduct({{8, 32}, {4, 16, 64}})->Unit(benchmark::kMicrosecond);
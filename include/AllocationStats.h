@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// What a heap allocation was made for, by the code that made it
+enum class AllocSubsystem {
+    OTHER,
+    SIMULATION,
+    MAP,
+    NETWORK,
+    UI,
+    COUNT
+};
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Heap allocation counters fed by a replacement global operator new. The
+// hook is compiled in only with TRAINBUILDER_ALLOC_STATS; without it
+// enabled() is false and every count reads zero.
+//
+// Counts only ever grow; profile a frame by taking the difference of two
+// reads. Allocations are attributed to the innermost Scope on the
+// allocating thread, so work handed to scheduler threads counts as OTHER.
+class AllocationStats {
+public:
+    static bool enabled();
+    static AllocationCounts get(AllocSubsystem subsystem);
+    static AllocationCounts total();
+    static const char* name(AllocSubsystem subsystem);
+
+    // Attributes this thread's allocations to subsystem while alive
+    class Scope {
+    public:
+        explicit Scope(AllocSubsystem subsystem);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        AllocSubsystem previous;
+    };
+};
@@ -26,11 +26,15 @@ public:
     CityRenderer(SDL_Renderer* renderer);
     ~CityRenderer();
 
+    // The same seed always produces the same districts
     void generateCity(const std::string& countryCode,
                      double minLat, double maxLat,
-                     double minLon, double maxLon);
+                     double minLon, double maxLon,
+                     unsigned seed);
 
     void render(double centerLat, double centerLon, int zoom);
+    // Size of the area the city fills, in screen coordinates
+    void setViewSize(int width, int height);
 
     // Coordinate conversions
     struct ScreenPos { int x, y; };
@@ -39,15 +43,18 @@ public:
     LatLon screenToLatLon(int x, int y, double centerLat, double centerLon, int zoom);
 
     const std::vector<District>& getDistricts() const { return districts; }
+    const std::vector<Road>& getRoads() const { return roads; }
+
+    // Generation stages of generateCity, exposed so they can be timed apart
+    void generateDistricts(double minLat, double maxLat, double minLon, double maxLon, unsigned seed);
+    void generateRoads();
 
 private:
     SDL_Renderer* renderer;
     std::vector<District> districts;
     std::vector<Road> roads;
 
-    const int SCREEN_WIDTH = 1280;
-    const int SCREEN_HEIGHT = 720;
-
-    void generateDistricts(double minLat, double maxLat, double minLon, double maxLon);
-    void generateRoads();
+    const int TILE_SIZE = 256;
+    int viewWidth;
+    int viewHeight;
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ColumnType : uint32_t {
+    FLOAT64 = 0,
+    INT64 = 1
+};
+
+// Results table stored column by column, written either as CSV or as a
+// compact binary columnar file. The binary layout is little-endian with
+// every field 8-byte aligned, so each column maps straight into an array
+// (numpy.frombuffer, Arrow, or a plain mmap):
+//
+//   char magic[8]                  "TBCOLS1"
+//   uint64 rowCount, columnCount
+//   columnCount descriptors:
+//     char name[48]                NUL-padded
+//     uint32 type                  ColumnType
+//     uint32 reserved
+//     uint64 offset                of the column's rowCount values
+//   column data
+class ColumnTable {
+public:
+    explicit ColumnTable(size_t rowCount = 0);
+
+    // Index of the new column, zero-filled
+    int addColumn(const std::string& name, ColumnType type);
+
+    void set(int column, size_t row, double value) { columns[column].values[row].f64 = value; }
+    void set(int column, size_t row, int64_t value) { columns[column].values[row].i64 = value; }
+
+    size_t getRowCount() const { return rowCount; }
+    size_t getColumnCount() const { return columns.size(); }
+
+    // Both write a temporary file and rename it into place
+    bool writeColumnar(const std::string& path) const;
+    bool writeCsv(const std::string& path) const;
+
+    static constexpr size_t NAME_LENGTH = 48;
+
+private:
+    union Value {
+        double f64;
+        int64_t i64;
+    };
+
+    struct Column {
+        std::string name;
+        ColumnType type;
+        std::vector<Value> values;
+    };
+
+    size_t rowCount;
+    std::vector<Column> columns;
+};
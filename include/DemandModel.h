@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class NetworkGraph;
+
+// Source of population for station catchments (a city district or a
+// population raster cell)
+struct PopulationCenter {
+    double lat;
+    double lon;
+    double radius; // in km
+    int population;
+};
+
+// Sparse row entry of the origin-destination matrix
+struct DemandEntry {
+    int destination;
+    float rate;    // trips per second
+    float pending; // fractional trips not yet spawned
+};
+
+// Whole trips started during one generate() call
+struct TripRequest {
+    int origin;
+    int destination;
+    int count;
+};
+
+// Origin-destination demand from a gravity model:
+//   rate(i, j) = K * catchment(i) * catchment(j) / distance(i, j)^BETA
+// Pairs below MIN_RATE are dropped and each origin keeps at most
+// MAX_DESTINATIONS entries, so memory stays linear in the station count.
+class DemandModel {
+public:
+    DemandModel();
+
+    void setPopulation(const std::vector<PopulationCenter>& centers);
+    const std::vector<PopulationCenter>& getPopulation() const { return centers; }
+    void clear();
+
+    // Full parallel rebuild of catchments and the OD matrix
+    void rebuild(const NetworkGraph& graph);
+
+    // Incremental update: computes one new row and appends the new column
+    // to every existing row instead of rebuilding
+    void addStation(int stationId, double lat, double lon);
+    // Drop the station's row and its column from every other row. A row
+    // that had evicted weaker destinations to make room keeps the slot
+    // free rather than recomputing them.
+    void removeStation(int stationId);
+
+    // Put back one origin exactly as saved, accumulators included, so a
+    // loaded game spawns the trips the original would have. Restoring every
+    // station replaces rebuild().
+    void restoreStation(int stationId, double lat, double lon, double catchment, double rowTotal,
+                        double spawnAccumulator, const std::vector<DemandEntry>& row);
+    double getSpawnAccumulator(int stationId) const { return spawnAccumulator[stationId]; }
+
+    int getStationCount() const { return (int)catchment.size(); }
+    double getCatchment(int stationId) const { return catchment[stationId]; }
+    const std::vector<DemandEntry>& getDemandFrom(int stationId) const { return rows[stationId]; }
+    double getTripRate(int stationId) const { return rowTotals[stationId]; }
+    size_t getNonZeroCount() const;
+
+    // Advance by deltaTime and append whole trips per OD pair. Only origins
+    // whose accumulated demand crossed a whole trip touch their row.
+    void generate(float deltaTime, std::vector<TripRequest>& trips);
+
+private:
+    double computeCatchment(double lat, double lon) const;
+    float gravity(int from, int to, double distance) const;
+    void computeRow(int stationId, int count);
+    static bool insertEntry(std::vector<DemandEntry>& row, DemandEntry entry, float& evicted);
+
+    std::vector<PopulationCenter> centers;
+
+    std::vector<double> stationLat;
+    std::vector<double> stationLon;
+    std::vector<double> catchment;
+    std::vector<std::vector<DemandEntry>> rows;
+    std::vector<double> rowTotals;
+    std::vector<double> spawnAccumulator;
+
+    static constexpr double CATCHMENT_RADIUS_KM = 1.5;
+    static constexpr double GRAVITY_K = 1e-5;
+    static constexpr double GRAVITY_BETA = 2.0;
+    static constexpr double MIN_DISTANCE_KM = 1.0;
+    static constexpr float MIN_RATE = 1e-6f;
+    static constexpr size_t MAX_DESTINATIONS = 256;
+};
@@ -1,52 +1,99 @@
 #pragma once
 
+#include <string>
 #include <vector>
+#include "Ledger.h"
+
+// Prices and costs. The defaults are the game's balance; tools and
+// parameter sweeps vary them at runtime. Upkeep is monthly.
+struct EconomyConfig {
+    double startingMoney = 100000.0;
+    double stationBuildCost = 5000.0;
+    double stationMaintenance = 100.0;
+    double lineBuildCostPerKm = 1000.0;
+    double lineMaintenancePerKm = 10.0;
+    double trainPurchaseCost = 10000.0;
+    double trainMaintenance = 200.0;
+    double ticketPricePerKm = 0.5;
+
+    // Field by its hyphenated name, e.g. "ticket-price-per-km"; null when
+    // there is no such field
+    double* field(const std::string& name);
+    static const std::vector<std::string>& fieldNames();
+};
 
 class Economy {
 public:
-    Economy();
+    explicit Economy(const EconomyConfig& config = EconomyConfig());
+    const EconomyConfig& getConfig() const { return config; }
 
     // Budget management
     double getMoney() const { return money; }
     bool spendMoney(double amount);
+    // A purchase for one entity: paid now and recorded in the ledger
+    // against it, but not charged again at settlement
+    bool spendMoney(LedgerAccount account, int id, double amount);
     void earnMoney(double amount);
+    // Let purchases take the balance below zero, for building scenarios
+    void setOverdraft(bool allowed) { overdraft = allowed; }
+
+    // Attributed revenue and charges, recorded in the ledger
+    void recordRevenue(LedgerAccount account, int id, double amount);
+    void recordCost(LedgerAccount account, int id, double amount);
+    Ledger& getLedger() { return ledger; }
+    const Ledger& getLedger() const { return ledger; }
 
-    // Income/expense tracking
+    // Close the tick in the ledger and settle the month when it is due.
+    // Call after the tick's revenue and costs are recorded.
     void update(float deltaTime);
     double getMonthlyIncome() const { return monthlyIncome; }
     double getMonthlyExpenses() const { return monthlyExpenses; }
     double getNetIncome() const { return monthlyIncome - monthlyExpenses; }
+    // Since creation or the last restore(); not saved with the game
+    double getTotalIncome() const { return totalIncome; }
+    double getTotalSpent() const { return totalSpent; }
+    float getTimeAccumulator() const { return timeAccumulator; }
+
+    // Balance and month totals in the process-wide metrics, on by default
+    void setPublishMetrics(bool enabled) { publishMetrics = enabled; }
+
+    // Resume a saved game's balance and month progress
+    void restore(double money, double monthlyIncome, double monthlyExpenses, float timeAccumulator);
+    // Forget the running month's recorded costs and purchases, for a
+    // network that was handed over rather than bought
+    void waiveRecordedCosts();
 
     // Station costs
     bool canBuildStation() const;
-    double getStationBuildCost() const { return stationBuildCost; }
-    double getStationMaintenanceCost() const { return stationMaintenanceCost; }
+    double getStationBuildCost() const { return config.stationBuildCost; }
+    double getStationMaintenanceCost() const { return config.stationMaintenance; }
 
     // Line costs (per km)
-    double getLineBuildCostPerKm() const { return lineBuildCostPerKm; }
-    double getLineMaintenanceCostPerKm() const { return lineMaintenanceCostPerKm; }
+    double getLineBuildCostPerKm() const { return config.lineBuildCostPerKm; }
+    double getLineMaintenanceCostPerKm() const { return config.lineMaintenancePerKm; }
+    // Whole units, as upkeep has always been charged
+    double getLineMaintenanceCost(double lengthKm) const;
+
+    // Train costs
+    double getTrainPurchaseCost() const { return config.trainPurchaseCost; }
+    double getTrainMaintenanceCost() const { return config.trainMaintenance; }
 
     // Revenue
+    double getTicketPricePerKm() const { return config.ticketPricePerKm; }
     double calculateTicketRevenue(int passengers, double distance) const;
 
 private:
+    EconomyConfig config;
     double money;
-    double monthlyIncome;
-    double monthlyExpenses;
-
-    // Constants
-    static constexpr double STARTING_MONEY = 100000.0;
-    static constexpr double STATION_BUILD_COST = 5000.0;
-    static constexpr double STATION_MAINTENANCE = 100.0;
-    static constexpr double LINE_BUILD_COST_PER_KM = 1000.0;
-    static constexpr double LINE_MAINTENANCE_PER_KM = 10.0;
-    static constexpr double TICKET_PRICE_PER_KM = 0.5;
-
-    double stationBuildCost = STATION_BUILD_COST;
-    double stationMaintenanceCost = STATION_MAINTENANCE;
-    double lineBuildCostPerKm = LINE_BUILD_COST_PER_KM;
-    double lineMaintenanceCostPerKm = LINE_MAINTENANCE_PER_KM;
+    double monthlyIncome;   // running total for the current month
+    double monthlyExpenses; // charges recorded so far this month
+    Ledger ledger;
+    double totalIncome;
+    double totalSpent; // purchases and settled costs
+    double paidCosts;  // purchases this month, already out of the balance
 
     // Time tracking
     float timeAccumulator;
+    bool publishMetrics = true;
+    bool overdraft = false;
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "PassengerCohort.h"
+
+// Station-pair great-circle distance cache used for line building and
+// ticket billing. Small networks keep a dense symmetric matrix that grows
+// by one row/column per new station (a loaded network fills its entries on
+// first lookup); past DENSE_LIMIT stations it switches
+// to a hashed map filled on first use, so memory follows the pairs that
+// are actually travelled.
+class FareTable {
+public:
+    FareTable();
+
+    void clear();
+    void addStation(int stationId, double lat, double lon);
+    // Forget a removed station's memoized pairs. Dense entries are simply
+    // overwritten when the id is reused.
+    void removeStation(int stationId);
+    // Replace every station at once, e.g. on load. Rather than paying
+    // O(stations^2) distances up front, dense entries are computed on first
+    // lookup.
+    void setStations(const std::vector<double>& stationLats, const std::vector<double>& stationLons);
+
+    int getStationCount() const { return (int)lats.size(); }
+    bool isDense() const { return dense; }
+
+    double getDistance(int from, int to);
+
+    // Price a tick's completed trips in one pass: distances are gathered
+    // first, then fares[i] = count * distance * pricePerKm runs as a flat
+    // loop. Returns the total.
+    double billTrips(const std::vector<CompletedTrip>& trips, double pricePerKm,
+                     std::vector<double>& fares);
+
+private:
+    double computeDistance(int from, int to) const;
+    void growDense(int count, int filled);
+
+    std::vector<double> lats;
+    std::vector<double> lons;
+
+    bool dense;
+    int stride;                  // row length of the dense matrix
+    std::vector<float> matrix;   // stride x stride, row-major
+
+    std::unordered_map<uint64_t, float> sparse;
+
+    // Scratch reused between station adds and billing passes
+    std::vector<double> rowDistances;
+    std::vector<float> tripDistances;
+
+    static constexpr int DENSE_LIMIT = 2048; // 2048^2 floats = 16 MB
+    static constexpr float UNKNOWN = -1.0f;  // dense entry not computed yet
+};
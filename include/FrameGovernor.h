@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Optional rendering work, in the order it is given up
+enum class SheddableWork {
+    OVERLAY_UPDATES, // info panel redrawn twice a second instead of on change
+    TILE_PREFETCH,   // map tiles just outside the view decoded ahead of time
+    TRAIN_DETAIL,    // train markers on lines too short to see them apart
+    COUNT
+};
+
+struct FrameGovernorOptions {
+    bool enabled = true;
+    double budgetMs = 1000.0 / 60.0;
+    bool dynamicResolution = true; // scale the scene, not just shed work
+    float minScale = 0.5f;
+    float scaleStep = 0.1f;
+};
+
+// Holds frame work time under a budget. Each frame reports how long its
+// work took (not the wait for vsync or the frame limiter). When a running
+// average stays over budget the governor steps down one level: first it
+// sheds optional work, cheapest to lose first, then it lowers the scene's
+// internal resolution. When frames stay well under budget it steps back
+// up, in reverse. Every step is printed.
+class FrameGovernor {
+public:
+    explicit FrameGovernor(const FrameGovernorOptions& options = FrameGovernorOptions());
+
+    void setOptions(const FrameGovernorOptions& newOptions);
+    const FrameGovernorOptions& getOptions() const { return options; }
+
+    void endFrame(double workMs);
+
+    // Scene resolution relative to the window, 1.0 at full quality
+    float getResolutionScale() const;
+    bool isShed(SheddableWork work) const;
+
+    int getLevel() const { return level; }
+    double getAverageMs() const { return averageMs; }
+    uint64_t getShedFrames(SheddableWork work) const { return shedFrames[(int)work]; }
+    uint64_t getScaledFrames() const { return scaledFrames; }
+    // Current state, e.g. "scene at 80%, shedding overlay updates, tile prefetch"
+    std::string describe() const;
+
+    static const char* name(SheddableWork work);
+
+private:
+    static const int SHED_LEVELS = (int)SheddableWork::COUNT;
+    static const int OVER_BUDGET_FRAMES = 30;   // before stepping down
+    static const int UNDER_BUDGET_FRAMES = 120; // before stepping back up
+
+    int maxLevel() const;
+    void announce(int oldLevel) const;
+
+    FrameGovernorOptions options;
+    int level;
+    double averageMs;
+    int overFrames;
+    int underFrames;
+    uint64_t shedFrames[SHED_LEVELS];
+    uint64_t scaledFrames;
+};
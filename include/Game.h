@@ -1,29 +1,74 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 #include "MapRenderer.h"
-#include "Station.h"
-#include "TrainLine.h"
-#include "Economy.h"
-#include "Train.h"
+#include "CityRenderer.h"
+#include "World.h"
+#include "Journal.h"
+#include "InputLog.h"
 #include "GameState.h"
 #include "UI.h"
+#include "FrameGovernor.h"
+
+struct GameOptions {
+    std::string recordPath;  // log input here for later replay
+    std::string replayPath;  // drive the game from a recorded log
+    bool headless = false;   // no window or drawing; requires a replay
+
+    // Offscreen render benchmark: a synthetic network in benchCountry,
+    // drawn along a scripted camera path for this many frames
+    int renderBenchFrames = 0;
+    std::string benchCountry = "NL";
+    int benchStations = 200;
+
+    // Initial window size; the window can be resized while playing
+    int windowWidth = 1280;
+    int windowHeight = 720;
+    // Frame work the governor holds frames to. 0 means 60 fps when
+    // playing and no governor in the render benchmark.
+    double frameBudgetMs = 0.0;
+    bool dynamicResolution = true; // may lower the scene resolution
+};
 
 class Game {
 public:
     Game();
     ~Game();
 
-    bool init();
+    bool init(const GameOptions& options = GameOptions());
     void run();
     void cleanup();
 
+    // Non-zero when a replay ended on a different world state
+    int getExitCode() const { return exitCode; }
+
 private:
+    bool createWindow();
     void handleEvents();
+    void dispatchEvent(const SDL_Event& event);
+    void step();
+    void runHeadless();
+    void runRenderBenchmark();
+    void finishReplay();
+    uint64_t computeWorldHash() const;
     void update(float deltaTime);
     void render();
+    void draw(); // render() without presenting
+
+    // The window's logical size: where clicks land and what the map fills
+    void setViewSize(int width, int height);
+    // Gameplay is drawn into a scaled-down target while the governor asks
+    // for reduced resolution; beginScene() is false when drawing directly
+    bool beginScene();
+    void endScene();
 
     // Event handlers
     void handleMouseClick(int x, int y, bool leftClick);
@@ -43,19 +88,80 @@ private:
 
     // Game initialization
     void startNewGame(const Country& country);
+    bool resetWorld(const Country& country);
+
+    // Snapshot save/load
+    std::string getSavePath() const;
+    bool saveGame(const std::string& path);
+    bool writeSnapshot(const std::string& path, int journalSegment) const;
+    bool makeSnapshotHeader(int journalSegment, SnapshotWorld& header) const;
+    bool loadGame(const std::string& path, int* journalSegment = nullptr);
+
+    // Autosave: journal between snapshots, compacted on a writer thread.
+    // Snapshots are never serialized on the game thread: writeBase saves
+    // the first one on the writer, and compaction folds the finished
+    // journal segments into the last one there.
+    std::string getAutosavePath() const;
+    std::string getJournalPath() const;
+    bool startAutosave(std::function<bool(const SnapshotWorld& header)> writeBase);
+    // The current world as loaded from basePath, with journal segments
+    // [replayFrom, replayEnd) replayed onto it
+    bool startAutosave(const std::string& basePath, int replayFrom = 0, int replayEnd = 0);
+    void stopAutosave();
+    void journalEconomy();
+    void updateAutosave(float deltaTime);
+    void compactAutosave();
+    void pollCompaction();
+    bool recoverAutosave();
+    void applyJournalRecord(const JournalRecord& record);
+
+    // Network helpers
+    StationHandle findStationAt(int x, int y) const;
+    // along, when given, receives how far along the line the click landed,
+    // 0.0 at station1 and 1.0 at station2
+    int findLineAt(int x, int y, double* along = nullptr) const;
 
     SDL_Window* window;
     SDL_Renderer* renderer;
+    SDL_Surface* offscreen; // render target when there is no window
+    int viewWidth;
+    int viewHeight;
+    bool menuLayout;          // menus drawn at UIRenderer's layout size
+    SDL_Texture* sceneTarget; // reduced-resolution gameplay scene
+    int sceneWidth;
+    int sceneHeight;
+    FrameGovernor governor;
+    uint64_t frameCount;
     bool running;
+    bool headless;
+    int exitCode;
+    int renderBenchFrames;
+    std::string benchCountry;
+    int benchStations;
+
+    // Deterministic stepping: fixed ticks, seeded generation, input log
+    uint64_t tick;
+    uint32_t worldSeed;
+    std::mt19937 seedSource; // per-game seeds drawn from worldSeed
+    std::unique_ptr<InputRecorder> recorder;
+    std::unique_ptr<InputReplay> replay;
 
     std::unique_ptr<MapRenderer> mapRenderer;
-    std::unique_ptr<Economy> economy;
+    std::unique_ptr<CityRenderer> cityRenderer; // procedural population for demand
     std::unique_ptr<GameStateManager> gameState;
     std::unique_ptr<UIRenderer> uiRenderer;
 
-    std::vector<Station> stations;
-    std::vector<TrainLine> trainLines;
-    std::vector<Train> trains;
+    World world;
+    std::vector<ScreenCoordinate> nodeScreenPos; // per-frame projection scratch
+    Journal journal;
+    // Builds snapshots from files and the journal alone; nothing else is
+    // shared with it
+    std::thread compactionWriter;
+    std::atomic<int> compactionResult; // COMPACTION_RUNNING, then 1 on success or 0
+    int compactionSegment;  // first journal segment it makes redundant
+    int autosaveSegment;    // where the autosave on disk replays from; -1 until written
+    float autosaveTimer;
+    float compactionTimer;
 
     // UI elements
     std::vector<Button> mainMenuButtons;
@@ -66,11 +172,14 @@ private:
     enum class Mode {
         VIEW,
         PLACE_STATION,
-        DRAW_LINE
+        DRAW_LINE,
+        PLACE_TRAIN,
+        REMOVE_TRAIN,
+        DEMOLISH
     };
 
     Mode currentMode;
-    Station* selectedStation;
+    StationHandle selectedStation; // first end of a line being drawn
     bool isDragging;
     int dragStartX, dragStartY;
 
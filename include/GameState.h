@@ -36,6 +36,7 @@ public:
     const std::vector<Country>& getAvailableCountries() const { return availableCountries; }
     void selectCountry(const Country& country);
     const Country* getSelectedCountry() const { return selectedCountry; }
+    const Country* findCountry(const std::string& code) const;
 
     // Save/Load
     std::string getCurrentSaveName() const { return currentSaveName; }
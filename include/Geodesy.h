@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+
+// Distances and projections on the spherical earth, shared by the map, the
+// demand model and fare billing so every module agrees on the same numbers.
+// Angles are in degrees, distances in km.
+
+constexpr double EARTH_RADIUS_KM = 6371.0;
+
+// Great-circle distance. Exact on the sphere at any range.
+double haversineKm(double lat1, double lon1, double lat2, double lon2);
+
+// Great-circle distance from one point to count others. Uses AVX2 when the
+// build enables it (agrees with haversineKm to ~1e-10 relative), scalar
+// otherwise.
+void haversineKmBatch(double lat, double lon, const double* lats, const double* lons,
+                      size_t count, double* out);
+
+// Flat-earth distance at the pair's mean latitude. Error grows with range
+// and latitude; only use it where a rough figure is enough.
+double equirectangularKm(double lat1, double lon1, double lat2, double lon2);
+
+// Equirectangular inside SHORT_RANGE_KM, haversine beyond it, so the
+// relative error stays below FAST_DISTANCE_MAX_ERROR up to 80 degrees of
+// latitude.
+constexpr double SHORT_RANGE_KM = 100.0;
+constexpr double FAST_DISTANCE_MAX_ERROR = 1e-3;
+double fastDistanceKm(double lat1, double lon1, double lat2, double lon2);
+
+// Local east/north tangent plane (ENU without the up axis) around an
+// origin. Cheap per point once built, but the east scale is fixed at the
+// origin's latitude: distances are within ~0.1% inside 20 km below 60
+// degrees, degrading to ~1% at 100 km near the poles.
+class LocalFrame {
+public:
+    LocalFrame(double originLat, double originLon);
+
+    void toLocal(double lat, double lon, double& eastKm, double& northKm) const;
+    void toLatLon(double eastKm, double northKm, double& lat, double& lon) const;
+
+private:
+    double originLat;
+    double originLon;
+    double kmPerDegLon;
+};
+
+// Web Mercator in normalized units: x and y in [0, 1], y growing south.
+// Multiply by 2^zoom for tile coordinates.
+double lonToMercatorX(double lon);
+double latToMercatorY(double lat);
+double mercatorXToLon(double x);
+double mercatorYToLat(double y);
+
+void latLonToMercatorBatch(const double* lats, const double* lons, size_t count,
+                           double* xs, double* ys);
+
+// Ground metres covered by one 256px tile pixel at this latitude and zoom
+double groundResolution(double lat, int zoom);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// One recorded input event, stamped with the simulation tick it was
+// handled before. Only the fields the game reads are kept.
+struct InputEvent {
+    uint64_t tick;
+    uint32_t type;   // SDL event type, or INPUT_LOG_END
+    int32_t x;
+    int32_t y;
+    int32_t button;  // mouse button, motion button mask, or key code
+    int32_t wheelY;
+    uint32_t reserved;
+};
+
+// Trailer record: x/y hold the low/high halves of the world hash
+const uint32_t INPUT_LOG_END = 0xFFFFFFFFu;
+
+// Writes the input of an interactive session so it can be replayed tick
+// for tick. The seed makes procedural generation repeat as well.
+class InputRecorder {
+public:
+    bool open(const std::string& path, uint32_t seed, double tickSeconds);
+    void record(uint64_t tick, const SDL_Event& event);
+    // Close the log with the final tick and the world hash reached there
+    void finish(uint64_t tick, uint64_t worldHash);
+
+private:
+    std::ofstream file;
+};
+
+class InputReplay {
+public:
+    bool open(const std::string& path);
+
+    uint32_t getSeed() const { return seed; }
+    double getTickSeconds() const { return tickSeconds; }
+    uint64_t getEndTick() const { return endTick; }
+    uint64_t getExpectedHash() const { return expectedHash; }
+    bool isFinished(uint64_t tick) const { return tick >= endTick; }
+
+    // Next recorded event for this tick, as an SDL event; false when the
+    // tick has no more events
+    bool poll(uint64_t tick, SDL_Event& event);
+
+private:
+    std::vector<InputEvent> events;
+    size_t next = 0;
+    uint32_t seed = 0;
+    double tickSeconds = 0.0;
+    uint64_t endTick = 0;
+    uint64_t expectedHash = 0;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class JournalRecordType : uint32_t {
+    PLACE_STATION = 1, // values: lat, lon, money before
+    BUILD_LINE = 2,    // ids: station1, station2; values: money before
+    ADD_TRAIN = 3,     // ids: line; values: money before
+    ECONOMY = 4,       // values: money, monthly income, monthly expenses, month timer
+    CAMERA = 5,        // ids: zoom; values: lat, lon
+    ROTATE = 6,        // internal: close this segment and start the next
+    REMOVE_TRAIN = 7,  // ids: train
+    REMOVE_LINE = 8,   // ids: line
+    REMOVE_STATION = 9 // ids: station
+};
+
+// Fixed-size so a torn write at the tail is detectable by length alone,
+// and checksummed so a damaged record stops replay instead of corrupting it
+struct JournalRecord {
+    JournalRecordType type;
+    uint32_t checksum;
+    double simClock;
+    int32_t ids[4];
+    double values[4];
+};
+
+// Append-only autosave journal. The game thread only queues records; a
+// background thread writes and syncs them, so journaling costs the game
+// thread one short lock per record. The journal is split into numbered
+// segments: rotate() starts a new segment, and a snapshot taken at that
+// moment makes every earlier segment redundant.
+class Journal {
+public:
+    Journal();
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Start appending to basePath.<segment>
+    bool open(const std::string& basePath, int segment);
+    // Flush queued records and stop the writer
+    void close();
+    bool isOpen() const { return writer.joinable(); }
+
+    // No-op while closed, so replaying commands never journals them again
+    void append(JournalRecordType type, double simClock,
+                std::initializer_list<int32_t> ids, std::initializer_list<double> values);
+
+    // Later records go to the next segment; returns its number
+    int rotate();
+    int getSegment() const { return segment; }
+    // Block until every record before segment `number` is on disk, or the
+    // journal is closed; for readers of finished segments on other threads
+    void waitForSegment(int number);
+
+    static std::string segmentPath(const std::string& basePath, int segment);
+    // Records of one segment up to the first torn or damaged one
+    static bool readSegment(const std::string& path, std::vector<JournalRecord>& records);
+    // Highest segment number on disk, or -1
+    static int findLastSegment(const std::string& basePath);
+    static void removeSegmentsBefore(const std::string& basePath, int firstKept);
+
+private:
+    void writerLoop();
+    bool openSegment(int number);
+    static uint32_t computeChecksum(const JournalRecord& record);
+
+    std::string basePath;
+    int segment;      // segment that new records belong to
+    FILE* file;       // owned by the writer thread once it runs
+
+    std::vector<JournalRecord> pending;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable segmentDone;
+    int completeBefore; // segments below this are closed and synced
+    bool stopping;
+    std::thread writer;
+};
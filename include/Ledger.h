@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+enum class LedgerAccount {
+    STATION,
+    LINE,
+    TRAIN
+};
+
+struct LedgerPeriod {
+    double revenue;
+    double costs;
+};
+
+// Fixed-capacity ring of period totals, stored as one column per measure.
+// Once full, the oldest period is overwritten, so memory never grows.
+class LedgerSeries {
+public:
+    explicit LedgerSeries(size_t capacity);
+
+    void push(double revenue, double costs);
+    void clear();
+
+    size_t getCount() const { return count; }
+    size_t getCapacity() const { return revenue.size(); }
+
+    // i = 0 is the most recent period
+    LedgerPeriod get(size_t i) const;
+    // Totals over the most recent n periods
+    LedgerPeriod sum(size_t n) const;
+
+private:
+    std::vector<double> revenue;
+    std::vector<double> costs;
+    size_t head;  // next write position
+    size_t count;
+};
+
+// Per-entity revenue and costs for the running month, kept as flat columns
+// per account kind, plus downsampled history at tick, month and year
+// resolution.
+//
+// Revenue is attributed to all three views (the origin station, and the
+// line and train that delivered the trip), so each revenue column sums to
+// the same total. Costs are disjoint: every charge belongs to one entity.
+class Ledger {
+public:
+    Ledger();
+
+    void clear();
+
+    // Monthly upkeep charged at settlement
+    void setUpkeep(LedgerAccount account, int id, double monthlyCost);
+
+    void recordRevenue(LedgerAccount account, int id, double amount);
+    void recordCost(LedgerAccount account, int id, double amount);
+    // Drop the running month's recorded costs; upkeep is kept
+    void clearCosts();
+
+    // Close the current tick into the tick series
+    void endTick();
+
+    // Charge upkeep, reduce every column into one month record, roll months
+    // into years and reset the running columns. Returns the month's totals.
+    LedgerPeriod settleMonth();
+
+    double getRevenue(LedgerAccount account, int id) const;
+    double getCosts(LedgerAccount account, int id) const;
+
+    const LedgerSeries& getTicks() const { return ticks; }
+    const LedgerSeries& getMonths() const { return months; }
+    const LedgerSeries& getYears() const { return years; }
+
+private:
+    struct Columns {
+        std::vector<double> revenue;
+        std::vector<double> costs;
+        std::vector<double> upkeep;
+    };
+
+    Columns& columns(LedgerAccount account);
+    const Columns& columns(LedgerAccount account) const;
+    static void ensureSize(Columns& cols, int id);
+    static double reduce(const std::vector<double>& column);
+
+    Columns stations;
+    Columns lines;
+    Columns trains;
+
+    double tickRevenue;
+    double tickCosts;
+    int monthsInYear;
+
+    LedgerSeries ticks;
+    LedgerSeries months;
+    LedgerSeries years;
+
+    static constexpr size_t TICK_HISTORY = 1024;
+    static constexpr size_t MONTH_HISTORY = 120;
+    static constexpr size_t YEAR_HISTORY = 100;
+    static constexpr int REDUCE_CHUNK = 4096; // fixed so sums don't depend on core count
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Listening sockets for local control and monitoring endpoints. An address
+// is "unix:<path>" for a Unix socket, or "[host:]port" for TCP, bound to
+// 127.0.0.1 unless a host is given.
+//
+// Returns the listening descriptor, or -1 after printing why. For a Unix
+// socket, unixPath receives the socket file, which the caller unlinks once
+// it stops listening; a stale file left by a crashed run is replaced.
+int listenLocal(const std::string& address, std::string& unixPath);
+
+// Write all of data, riding out short writes. False once the peer is gone;
+// never raises SIGPIPE.
+bool sendAll(int fd, const char* data, size_t size);
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class LogLevel : uint8_t {
+    TRACE = 0,
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 3,
+    ERROR = 4
+};
+
+// Lowest level compiled in; calls below it vanish along with their
+// arguments. Defaults to DEBUG in debug builds and INFO otherwise.
+#ifndef TRAINBUILDER_LOG_LEVEL
+#ifdef NDEBUG
+#define TRAINBUILDER_LOG_LEVEL 2
+#else
+#define TRAINBUILDER_LOG_LEVEL 1
+#endif
+#endif
+
+// One queued message. Only the format's pointer is stored, so it must be
+// a string literal; "{}" marks each argument. String arguments are copied
+// into the record and cut short when they overflow it.
+struct LogRecord {
+    static constexpr int MAX_ARGS = 8;
+    static constexpr size_t TEXT_CAPACITY = 160;
+
+    enum ArgType : uint8_t { INT, UINT, FLOAT, TEXT };
+
+    struct Arg {
+        ArgType type;
+        union {
+            int64_t i;
+            uint64_t u;
+            double f;
+            uint32_t textOffset;
+        };
+    };
+
+    LogLevel level;
+    uint8_t argCount;
+    uint16_t textUsed;
+    size_t position; // ring slot, for publishing
+    const char* format;
+    Arg args[MAX_ARGS];
+    char text[TEXT_CAPACITY];
+
+    template <typename T>
+    void add(const T& value) {
+        Arg& arg = args[argCount++];
+        if constexpr (std::is_floating_point<T>::value) {
+            arg.type = FLOAT;
+            arg.f = value;
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            arg.type = INT;
+            arg.i = value;
+        } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+            arg.type = UINT;
+            arg.u = (uint64_t)value;
+        } else if constexpr (std::is_pointer<T>::value) {
+            addText(arg, value ? std::string_view(value) : std::string_view("(null)"));
+        } else {
+            addText(arg, std::string_view(value));
+        }
+    }
+
+private:
+    void addText(Arg& arg, std::string_view value);
+};
+
+// Asynchronous logger. Producers on any thread claim a slot in a bounded
+// lock-free ring, store the format pointer and raw arguments, and return;
+// a background thread formats the messages and writes them, INFO and below
+// to stdout and WARN and above to stderr. A full ring drops the message and
+// counts it rather than ever blocking the caller. A forked child has no
+// writer thread, so what it logs is lost. Use the LOG_* macros.
+class Log {
+public:
+    // Runtime floor on top of the compiled one
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+    // "trace" to "error"; false when unknown
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+    template <typename... Args>
+    static void write(LogLevel level, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many log arguments");
+        if (level < getLevel()) return;
+        LogRecord* record = claim();
+        if (!record) return;
+        record->level = level;
+        record->format = format;
+        record->argCount = 0;
+        record->textUsed = 0;
+        (record->add(args), ...);
+        publish(record);
+    }
+
+    // Wait until everything logged so far has been written. Before output
+    // that bypasses the log, and before the process exits.
+    static void flush();
+
+    static uint64_t getDroppedCount();
+
+private:
+    static LogRecord* claim();
+    static void publish(LogRecord* record);
+};
+
+#define TRAINBUILDER_LOG(level, ...) Log::write(level, __VA_ARGS__)
+
+#if TRAINBUILDER_LOG_LEVEL <= 0
+#define LOG_TRACE(...) TRAINBUILDER_LOG(LogLevel::TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if TRAINBUILDER_LOG_LEVEL <= 1
+#define LOG_DEBUG(...) TRAINBUILDER_LOG(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if TRAINBUILDER_LOG_LEVEL <= 2
+#define LOG_INFO(...) TRAINBUILDER_LOG(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if TRAINBUILDER_LOG_LEVEL <= 3
+#define LOG_WARN(...) TRAINBUILDER_LOG(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if TRAINBUILDER_LOG_LEVEL <= 4
+#define LOG_ERROR(...) TRAINBUILDER_LOG(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
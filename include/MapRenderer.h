@@ -1,10 +1,12 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <memory>
 #include <functional>
+#include <vector>
 
 struct MapCoordinate {
     double lat;
@@ -31,6 +33,11 @@ public:
     void setCountry(const std::string& countryName);
     void render(double centerLat, double centerLon, int zoom);
 
+    // Size of the area the map fills, in screen coordinates
+    void setViewSize(int width, int height);
+    // Decode the ring of tiles just outside the view before they scroll in
+    void setPrefetch(bool enabled) { prefetch = enabled; }
+
     // Pre-download tiles for a country
     bool preloadCountryTiles(const std::string& countryCode,
                             double minLat, double maxLat,
@@ -41,21 +48,30 @@ public:
     // Coordinate conversions
     ScreenCoordinate latLonToScreen(double lat, double lon, double centerLat, double centerLon, int zoom);
     MapCoordinate screenToLatLon(int x, int y, double centerLat, double centerLon, int zoom);
+    // Project count points at once into out
+    void latLonToScreen(const double* lats, const double* lons, size_t count,
+                        double centerLat, double centerLon, int zoom, ScreenCoordinate* out);
 
     // Tile management
     SDL_Texture* getTile(int zoom, int x, int y);
 
 private:
     SDL_Renderer* renderer;
-    std::map<std::string, SDL_Texture*> tileCache;
+    std::map<uint64_t, SDL_Texture*> tileCache; // by tileKey(); null for tiles not on disk
     std::string currentCountry;
+    std::vector<double> projectX; // batch projection scratch
+    std::vector<double> projectY;
 
     const int TILE_SIZE = 256;
-    const int SCREEN_WIDTH = 1280;
-    const int SCREEN_HEIGHT = 720;
+    int viewWidth;
+    int viewHeight;
+    bool prefetch;
 
     // Helper functions
     void latLonToTile(double lat, double lon, int zoom, int& tileX, int& tileY);
+    static uint64_t tileKey(int zoom, int x, int y) {
+        return ((uint64_t)zoom << 48) | ((uint64_t)(uint32_t)x << 24) | (uint32_t)y;
+    }
     std::string getTilePath(int zoom, int x, int y);
     std::string getTileURL(int zoom, int x, int y);
     bool downloadTile(int zoom, int x, int y);
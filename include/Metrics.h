@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Monotonic count of events
+class MetricCounter {
+public:
+    void add(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// Last value of something that goes up and down
+class MetricGauge {
+public:
+    void set(double newValue) { value.store(newValue, std::memory_order_relaxed); }
+    void add(double amount);
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value{0.0};
+};
+
+// Distribution of observations over fixed, ascending bucket bounds. Each
+// bucket counts only its own range; the export accumulates them.
+class MetricHistogram {
+public:
+    explicit MetricHistogram(const std::vector<double>& bounds);
+
+    void observe(double value);
+
+    const std::vector<double>& getBounds() const { return bounds; }
+    // Observations <= bounds[i] and above the previous bound; the last
+    // bucket, index bounds.size(), holds the rest
+    uint64_t getBucket(size_t i) const { return buckets[i].load(std::memory_order_relaxed); }
+    uint64_t getCount() const;
+    double getSum() const { return sum.load(std::memory_order_relaxed); }
+
+    // Bounds growing by factor from start, e.g. 0.0001 s doubling
+    static std::vector<double> exponentialBounds(double start, double factor, int count);
+
+private:
+    std::vector<double> bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+    std::atomic<double> sum{0.0};
+};
+
+// Process-wide metrics, exported in the Prometheus text format.
+//
+// Registering takes a lock and is meant for startup: look a metric up
+// once and keep the reference, which stays valid for the life of the
+// registry. Updating a metric is a relaxed atomic operation and never
+// blocks, so the sim loop and renderers publish from their hot paths.
+// Asking for a registered name again returns the same metric. Labels are
+// a Prometheus label list without braces, e.g. subsystem="map".
+class MetricsRegistry {
+public:
+    MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricHistogram& histogram(const std::string& name, const std::string& help,
+                               const std::vector<double>& bounds, const std::string& labels = "");
+
+    // Runs on the exporting thread before every export, to sample values
+    // nothing publishes on its own. It must only touch thread-safe state.
+    void addCollector(const std::function<void()>& collector);
+
+    // Every metric, grouped by name in registration order
+    std::string exportText();
+
+    static MetricsRegistry& global();
+
+private:
+    enum class Kind { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Entry {
+        Kind kind;
+        std::string name;
+        std::string help;
+        std::string labels;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    Entry& find(Kind kind, const std::string& name, const std::string& help, const std::string& labels);
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::vector<std::function<void()>> collectors;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "Metrics.h"
+
+// Publishes a MetricsRegistry from a background thread, either or both:
+//  - served over HTTP on a local socket, for Prometheus or curl to scrape;
+//  - written to a file every interval, replaced atomically, for
+//    node_exporter's textfile collector or plain tail -f.
+// The thread only reads the registry, so the simulation never waits on it.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(MetricsRegistry& registry = MetricsRegistry::global());
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // "unix:<path>" for a Unix socket, or "[host:]port" for TCP. TCP binds
+    // to 127.0.0.1 unless a host is given. Call before start().
+    bool listen(const std::string& address);
+    // Call before start()
+    void writeFile(const std::string& path, double intervalSeconds);
+
+    void start();
+    // Joins the thread, writing the file one last time
+    void stop();
+
+    // Resident memory, dropped log messages, and heap allocations when
+    // they are counted
+    static void registerProcessMetrics(MetricsRegistry& registry);
+
+private:
+    void run();
+    void serveClient(int client);
+    bool writeFileNow();
+
+    MetricsRegistry& registry;
+    int listenFd;
+    std::string unixPath; // unlinked on stop
+    std::string filePath;
+    double fileInterval;
+    std::thread thread;
+    std::atomic<bool> stopping;
+};
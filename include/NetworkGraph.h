@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+class Station;
+class TrainLine;
+class Timetable;
+
+// Immutable compressed-sparse-row view of the network. Neighbors of a node
+// are the contiguous edge range [edgeBegin(node), edgeEnd(node)), and every
+// per-edge attribute lives in its own flat array, so traversals never chase
+// per-station heap allocations.
+//
+// Nodes can optionally be renumbered in Hilbert order so stations that are
+// close on the map are also close in memory. Edits patch the arrays in
+// place and keep the existing numbering, so the order is only refreshed by
+// the next full build. Station ids stay the public currency;
+// toNode/toStation translate between them, and ids left free by removed
+// stations have no node. A node's edges are always in line id order.
+class NetworkGraph {
+public:
+    enum class Ordering {
+        NONE,
+        HILBERT
+    };
+
+    NetworkGraph();
+
+    // Full rebuild from the current network, O(stations + lines)
+    void build(const std::vector<Station>& stations,
+               const std::vector<TrainLine>& lines,
+               const Timetable& timetable,
+               Ordering ordering = Ordering::NONE);
+    void clear();
+
+    // Patches that keep the CSR arrays valid without a rebuild. Each is a
+    // single shift of the arrays behind the edit, with no sorting.
+    void appendStation(const Station& station);
+    // The station must have no lines left
+    void removeStation(int stationId);
+    void addLine(const TrainLine& line, float travelTime);
+    void removeLine(int lineId);
+
+    int getNodeCount() const { return (int)nodeToStation.size(); }
+    int getEdgeCount() const { return (int)targets.size(); }
+
+    // Edge ranges
+    int edgeBegin(int node) const { return offsets[node]; }
+    int edgeEnd(int node) const { return offsets[node + 1]; }
+    int getTarget(int edge) const { return targets[edge]; }
+    int getLine(int edge) const { return edgeLines[edge]; }
+    float getLength(int edge) const { return edgeLengths[edge]; }      // km
+    float getTravelTime(int edge) const { return edgeTimes[edge]; }    // seconds
+
+    // Node attributes
+    double getLat(int node) const { return lats[node]; }
+    double getLon(int node) const { return lons[node]; }
+    const double* getLats() const { return lats.data(); }
+    const double* getLons() const { return lons.data(); }
+
+    // -1 for a removed or unknown station
+    int toNode(int stationId) const {
+        return stationId >= 0 && stationId < (int)stationToNode.size() ? stationToNode[stationId] : -1;
+    }
+    int toStation(int node) const { return nodeToStation[node]; }
+    // One past the highest station id in the graph
+    int getStationSlotCount() const { return (int)stationToNode.size(); }
+
+private:
+    // Positions in the station array, in node order
+    std::vector<int> computeOrder(const std::vector<Station>& stations, Ordering ordering) const;
+    // Open a slot at edge for the edge row of node, or close the one there
+    void insertEdge(int node, int edge, int target, int lineId, float length, float travelTime);
+    void eraseEdge(int node, int edge);
+    static int getSlotCount(const std::vector<Station>& stations);
+
+    std::vector<int> offsets;      // size nodes + 1
+    std::vector<int> targets;
+    std::vector<int> edgeLines;
+    std::vector<float> edgeLengths;
+    std::vector<float> edgeTimes;
+
+    std::vector<double> lats;
+    std::vector<double> lons;
+    std::vector<int> stationToNode;
+    std::vector<int> nodeToStation;
+
+    std::vector<int> lineEdges;    // two directed edges per line, -1 when absent
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+
+// Split [begin, end) into contiguous chunks and run them on all cores
+// through the global work-stealing TaskScheduler. The body receives a
+// half-open sub-range; chunks never overlap, so bodies that only write to
+// their own indices need no locking.
+void parallelFor(int begin, int end, const std::function<void(int, int)>& body,
+                 int minChunk = 64);
+
+int getWorkerCount();
+
+// While alive, parallelFor on this thread runs the whole range inline, on
+// this thread. For threads that own a core and already run independent
+// work side by side, such as server shards, where the shared pool would
+// only add contention.
+class SerialScope {
+public:
+    SerialScope();
+    ~SerialScope();
+
+    SerialScope(const SerialScope&) = delete;
+    SerialScope& operator=(const SerialScope&) = delete;
+
+private:
+    bool previous;
+};
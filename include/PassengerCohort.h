@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// A bucket of passengers sharing the same trip. Cohorts with the same
+// origin, destination and spawn bucket are merged, so the number of live
+// cohorts is bounded by the active OD pairs rather than by rider count.
+struct PassengerCohort {
+    int origin;
+    int destination;
+    int count;
+    float spawnTime; // start of the spawn bucket, simulation seconds
+};
+
+// A finished journey, reported when a cohort alights at its destination
+struct CompletedTrip {
+    int origin;
+    int destination;
+    int count;
+    float spawnTime;
+    int trainId; // train that delivered it
+};
+
+// Slab allocator shared by every pool. Cohorts live in fixed-size blocks
+// that never move, and freed slots are recycled through a free list, so
+// steady-state boarding and alighting does not touch the heap.
+// allocate/release are safe to call from parallel station tasks; get() is
+// lock-free because the block table is reserved up front and never moves.
+class CohortArena {
+public:
+    CohortArena();
+
+    int allocate(const PassengerCohort& cohort);
+    void release(int slot);
+    void clear();
+
+    PassengerCohort& get(int slot) { return blocks[slot / BLOCK_SIZE][slot % BLOCK_SIZE]; }
+    const PassengerCohort& get(int slot) const { return blocks[slot / BLOCK_SIZE][slot % BLOCK_SIZE]; }
+
+    size_t getLiveCount() const { return liveCount; }
+    size_t getCapacity() const { return blocks.size() * BLOCK_SIZE; }
+
+    static float bucketTime(double simTime);
+
+private:
+    std::vector<std::unique_ptr<PassengerCohort[]>> blocks;
+    std::vector<int> freeSlots;
+    int nextSlot;
+    size_t liveCount;
+    std::mutex mutex;
+
+    static constexpr int BLOCK_SIZE = 4096;
+    static constexpr int MAX_BLOCKS = 1 << 16;
+    static constexpr double SPAWN_BUCKET = 300.0; // seconds
+};
+
+// The cohorts waiting at a station or riding a train. The pool only holds
+// arena slots; boarding and alighting cost one step per cohort, and a
+// cohort is found by its key without scanning the pool.
+class CohortPool {
+public:
+    CohortPool();
+
+    int getCount() const { return total; }
+    size_t getCohortCount() const { return slots.size(); }
+    const std::vector<int>& getSlots() const { return slots; }
+
+    // Add passengers, merging into a cohort with the same key if present
+    void add(CohortArena& arena, int origin, int destination, int count, float spawnTime);
+
+    // Move whole cohorts (split at the limit) that satisfy the predicate
+    // into another pool; returns passengers moved
+    int transfer(CohortArena& arena, CohortPool& to, int limit,
+                 const std::function<bool(const PassengerCohort&)>& predicate);
+
+    // Drop the cohorts that set out before cutoff; returns passengers dropped
+    int expire(CohortArena& arena, float cutoff);
+    // Drop the cohorts that satisfy the predicate; returns passengers dropped
+    int remove(CohortArena& arena, const std::function<bool(const PassengerCohort&)>& predicate);
+
+    // Empty the pool, handing every cohort to the callback first
+    void drain(CohortArena& arena, const std::function<void(const PassengerCohort&)>& callback);
+
+    void clear(CohortArena& arena);
+
+private:
+    struct Key {
+        int origin;
+        int destination;
+        float spawnTime;
+        bool operator==(const Key& other) const {
+            return origin == other.origin && destination == other.destination && spawnTime == other.spawnTime;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    static Key keyOf(const PassengerCohort& cohort) { return {cohort.origin, cohort.destination, cohort.spawnTime}; }
+
+    void insert(CohortArena& arena, int slot);
+    // Swap-remove position i, keeping the index in step
+    void erase(CohortArena& arena, size_t i);
+
+    std::vector<int> slots; // arena slots, in arrival order
+    std::unordered_map<Key, int, KeyHash> index; // key -> arena slot
+    int total;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// Render-thread counters for profiling frames: every SDL draw or copy call,
+// every tile decoded from disk and every byte uploaded into a texture.
+// Not synchronized - only the thread that owns the renderer touches them.
+struct RenderStats {
+    uint64_t drawCalls = 0;
+    uint64_t tilesDecoded = 0;
+    uint64_t bytesUploaded = 0;
+
+    void reset() { *this = RenderStats(); }
+
+    static RenderStats& global() {
+        static RenderStats stats;
+        return stats;
+    }
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+class NetworkGraph;
+
+// Fastest-journey routing over the station graph. Every line is a shuttle
+// between two stations, so each boarding costs the expected wait (half the
+// headway) plus a transfer penalty, and Dijkstra over stations already
+// accounts for transfers.
+//
+// Traversal runs over the CSR NetworkGraph. A shortest-path tree per
+// destination answers which line to board next in O(1), but all of them
+// together are O(stations^2), so trees are built on first query and kept
+// in a cache bounded by a byte budget. The budget is a soft limit, checked
+// once per tick: update() evicts the least recently used trees once it is
+// exceeded. Queries hold trees without locks, so a tree cannot be evicted
+// while they run, and the cache can overshoot by the trees first built
+// during one tick. Cached trees persist across ticks:
+// topology edits only mark the ones they can affect, and update()
+// recomputes those in parallel.
+//
+// Queries may run concurrently with each other (a miss builds its tree on
+// the calling thread); edits and update() run between ticks.
+class Router {
+public:
+    Router();
+    ~Router();
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    void clear();
+    // Grow the station id space; cached trees are left as they are, since
+    // a new station is unreachable until a line reaches it
+    void setStationCount(int count);
+    // Soft: enforced by the next update(), not as trees are built
+    void setCacheBudget(size_t bytes) { cacheBudget = bytes; }
+
+    // Add, re-weight or remove a line; cost is the time to ride it in seconds
+    void setLine(int lineId, int station1Id, int station2Id, double rideTime, double headway);
+    void removeLine(int lineId);
+    // Drop a removed station's tree; remove its lines first. The id stays
+    // unreachable until a line reaches whatever station reuses it.
+    void removeStation(int stationId);
+
+    // Recompute every cached tree invalidated by topology edits, then trim
+    // the cache to its budget. The graph must outlive the next queries.
+    void update(const NetworkGraph& graph);
+    int getDirtyCount() const { return dirtyCount; }
+    int getCachedTreeCount() const { return cachedTrees.load(std::memory_order_relaxed); }
+    size_t getCacheBytes() const { return cacheBytes.load(std::memory_order_relaxed); }
+
+    // Queries (valid after update)
+    bool isReachable(int from, int to) const;
+    float getJourneyTime(int from, int to) const;
+    int getNextLine(int at, int to) const;     // -1 when at == to or unreachable
+    int getNextStation(int at, int to) const;
+
+    // Batched many-to-many lookup, e.g. for a whole OD matrix
+    void getJourneyTimes(const std::vector<int>& from, const std::vector<int>& to,
+                         std::vector<float>& times) const;
+
+    static constexpr size_t DEFAULT_CACHE_BUDGET = (size_t)256 << 20;
+
+private:
+    struct LineEdge {
+        int station1Id;
+        int station2Id;
+        float cost;      // ride + wait, used to decide which trees to invalidate
+        float waitCost;  // added to the graph's edge travel time
+        bool active;
+    };
+
+    struct RouteTree {
+        // Sized to the station count when last computed; stations added
+        // since are unreachable
+        std::vector<float> time;    // seconds from each station to the destination
+        std::vector<int> nextLine;  // line to board at each station
+        bool dirty;
+        std::atomic<uint64_t> lastUse; // update() count at the last query
+
+        float getTime(int station) const {
+            return station < (int)time.size() ? time[station] : UNREACHABLE;
+        }
+        int getLine(int station) const {
+            return station < (int)nextLine.size() ? nextLine[station] : -1;
+        }
+        size_t getBytes() const {
+            return sizeof(RouteTree) + time.capacity() * sizeof(float) + nextLine.capacity() * sizeof(int);
+        }
+    };
+
+    // The destination's tree, built and cached on a miss; null before the
+    // first update() or for an unknown station
+    const RouteTree* findTree(int destination) const;
+    void computeTree(int destination, RouteTree& tree) const;
+    void markAffected(int lineId, int station1Id, int station2Id, float newCost);
+    void evict(int destination);
+    void trimCache();
+
+    std::vector<LineEdge> lines;
+    // One slot per destination station, null until its tree is first
+    // queried. Capacity doubles, so adding a station is amortized O(1).
+    std::unique_ptr<std::atomic<RouteTree*>[]> trees;
+    int stationCount;
+    int treeCapacity;
+    int dirtyCount;
+
+    const NetworkGraph* graph;
+    uint64_t useClock;
+    size_t cacheBudget;
+    mutable std::atomic<size_t> cacheBytes;
+    mutable std::atomic<int> cachedTrees;
+
+    static constexpr float TRANSFER_PENALTY = 60.0f; // seconds per boarding
+    static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+class World;
+
+// A synthetic network for headless runs and benchmarks: stations scattered
+// over a bounding box, a random spanning tree of lines plus extra lines,
+// and population centers for demand. The same options and seed always
+// build the same world.
+struct ScenarioOptions {
+    int stationCount = 200;
+    int extraLineCount = 100;  // lines beyond the spanning tree
+    int trainsPerLine = 2;
+    int populationCenters = 50;
+    double minLat = 52.0;
+    double maxLat = 52.8;
+    double minLon = 4.3;
+    double maxLon = 5.3;
+    uint32_t seed = 1;
+    // The network is the same either way. Charged, its construction is
+    // paid at the world's configured costs and counted in the totals, as a
+    // debt where it costs more than the world has. Otherwise the world
+    // starts with its normal balance.
+    bool chargeConstruction = false;
+};
+
+// Replace the world with a freshly built scenario.
+void buildScenario(World& world, const ScenarioOptions& options);
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Metrics.h"
+#include "World.h"
+
+struct SimServerOptions {
+    int shardCount = 0;       // 0 for one per core
+    double tickRate = 60.0;   // ticks per second; 0 runs every shard flat out
+    bool pinShards = true;    // bind shard i to core i (Linux only)
+    std::string snapshotDirectory = "snapshots";
+};
+
+struct ShardStats {
+    int core;          // -1 when not pinned
+    int worlds;
+    uint64_t ticks;
+    uint64_t worldTicks;
+    uint64_t overruns; // ticks that started late by over a whole period
+};
+
+// Hosts many independent worlds in one process. Worlds are spread over
+// shards, one thread per shard, each pinned to its own core. A shard
+// advances all of its worlds one tick at a time on a fixed clock, each
+// world serially on that thread, so shards never contend for the task
+// pool, the metrics or anything else and throughput grows with cores.
+//
+// Commands are text lines, from a client on the socket or execute(). A
+// command that touches a world is queued on the world's shard and runs
+// between ticks. Responses start with "OK" or "ERR <reason>"; LIST and
+// STATS follow their "OK <n>" with n lines.
+//
+//   CREATE [stations=N] [extra-lines=N] [trains-per-line=N] [seed=N]  -> OK <world>
+//   LOAD <snapshot>                   -> OK <world>
+//   DESTROY <world>
+//   STATE <world>                     -> OK world=.. tick=.. clock=.. stations=.. hash=..
+//   STATION <world> <lat> <lon>       -> OK <station>
+//   LINE <world> <station> <station>  -> OK <line>
+//   TRAIN <world> <line>              -> OK <train>
+//   REMOVE_TRAIN <world> <train>
+//   REMOVE_LINE <world> <line>        removes the line's trains too
+//   REMOVE_STATION <world> <station>  removes its lines and their trains too
+//   SNAPSHOT <world> [path]           -> OK <path>
+//   LIST, STATS, PING, QUIT, SHUTDOWN
+class SimServer {
+public:
+    explicit SimServer(const SimServerOptions& options = SimServerOptions());
+    ~SimServer();
+
+    SimServer(const SimServer&) = delete;
+    SimServer& operator=(const SimServer&) = delete;
+
+    // See listenLocal() for the address forms. Call before start().
+    bool listen(const std::string& address);
+    void start();
+    void stop();
+
+    // Run one command line as a client would; safe from any thread
+    std::string execute(const std::string& line);
+
+    // A client sent SHUTDOWN
+    bool isShutdownRequested() const { return shutdownRequested; }
+
+    int getShardCount() const { return (int)shards.size(); }
+    std::vector<ShardStats> getShardStats() const;
+
+    static const double TICK_SECONDS;
+
+private:
+    struct HostedWorld {
+        int id;
+        World world;
+        uint64_t ticks = 0;
+    };
+
+    struct Shard {
+        int index;
+        int core;
+        std::thread thread;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<std::function<void()>> commands; // run between ticks
+        bool closed = true; // no thread to run commands: not started or exited
+
+        // Only the shard's thread touches its worlds
+        std::vector<std::unique_ptr<HostedWorld>> worlds;
+
+        MetricCounter* ticks;
+        MetricCounter* worldTicks;
+        MetricCounter* overruns;
+        MetricGauge* worldCount;
+        MetricHistogram* tickSeconds;
+    };
+
+    struct Client {
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    void runShard(Shard& shard);
+    // Queue work on a shard and wait for its result
+    std::string runOnShard(Shard& shard, const std::function<std::string()>& work);
+    // The world and the shard that owns it; only call from that shard's thread
+    HostedWorld* findWorld(Shard& shard, int worldId);
+    Shard* shardOf(int worldId);
+    int placeWorld();
+
+    std::string createWorld(const std::vector<std::string>& args);
+    std::string loadWorld(const std::vector<std::string>& args);
+    std::string worldCommand(const std::string& command, const std::vector<std::string>& args);
+    std::string listWorlds();
+    std::string describeStats();
+
+    void acceptClients();
+    void serveClient(int client, Client& state);
+
+    SimServerOptions options;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<bool> stopping;
+    std::atomic<bool> shutdownRequested;
+
+    // World directory, on the control path only
+    std::mutex directoryMutex;
+    std::unordered_map<int, int> worldShards;
+    int nextWorldId;
+
+    int listenFd;
+    std::string unixPath;
+    std::thread acceptor;
+    std::mutex clientsMutex;
+    std::vector<std::unique_ptr<Client>> clients;
+};
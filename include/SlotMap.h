@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Stable reference to an entity in a SlotMap<T>. The generation tells a
+// handle to a removed entity apart from one to whatever reused its slot,
+// and the type parameter keeps station, line and train handles apart.
+template <typename T>
+struct Handle {
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    uint32_t index = NONE;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == NONE; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Entities packed in one dense array and addressed through a slot table.
+// Iteration walks the dense array; lookup and erase are O(1) and insert
+// is O(log free slots). Erase moves the last entity into the hole, so
+// pointers into the map only last until the next erase - hold handles or
+// slot indices instead.
+//
+// A slot index is an entity's id for its whole life. Freed slots are
+// reused lowest index first, so a map rebuilt from a saved game hands out
+// the same ids the original would have.
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    // Slot index the next emplace() will use
+    uint32_t nextIndex() const {
+        return freeSlots.empty() ? (uint32_t)slots.size() : freeSlots.front();
+    }
+
+    template <typename... Args>
+    Handle<T> emplace(Args&&... args) {
+        uint32_t index;
+        if (freeSlots.empty()) {
+            index = (uint32_t)slots.size();
+            slots.push_back({FREE, 0});
+        } else {
+            std::pop_heap(freeSlots.begin(), freeSlots.end(), std::greater<uint32_t>());
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        return place(index, std::forward<Args>(args)...);
+    }
+
+    // Insert at index, which must lie past the end of the slot table; the
+    // slots skipped over become free. Restores a map with holes when its
+    // entities are inserted in ascending index order.
+    template <typename... Args>
+    Handle<T> emplaceAt(uint32_t index, Args&&... args) {
+        if (index < slots.size()) return Handle<T>();
+        while (slots.size() < index) {
+            freeSlots.push_back((uint32_t)slots.size());
+            std::push_heap(freeSlots.begin(), freeSlots.end(), std::greater<uint32_t>());
+            slots.push_back({FREE, 0});
+        }
+        slots.push_back({FREE, 0});
+        return place(index, std::forward<Args>(args)...);
+    }
+
+    bool erase(Handle<T> handle) {
+        if (!contains(handle)) return false;
+
+        // Fill the hole with the last entity
+        uint32_t position = slots[handle.index].dense;
+        uint32_t last = (uint32_t)dense.size() - 1;
+        if (position != last) {
+            dense[position] = std::move(dense[last]);
+            denseToSlot[position] = denseToSlot[last];
+            slots[denseToSlot[position]].dense = position;
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+
+        Slot& slot = slots[handle.index];
+        slot.dense = FREE;
+        slot.generation++;
+        freeSlots.push_back(handle.index);
+        std::push_heap(freeSlots.begin(), freeSlots.end(), std::greater<uint32_t>());
+        return true;
+    }
+
+    bool contains(Handle<T> handle) const {
+        return handle.index < slots.size() && slots[handle.index].dense != FREE &&
+               slots[handle.index].generation == handle.generation;
+    }
+
+    T* get(Handle<T> handle) { return contains(handle) ? &dense[slots[handle.index].dense] : nullptr; }
+    const T* get(Handle<T> handle) const { return contains(handle) ? &dense[slots[handle.index].dense] : nullptr; }
+
+    // By slot index, for ids stored inside other entities. atIndex() needs
+    // a live slot.
+    bool containsIndex(int index) const {
+        return index >= 0 && index < (int)slots.size() && slots[index].dense != FREE;
+    }
+    T& atIndex(int index) { return dense[slots[index].dense]; }
+    const T& atIndex(int index) const { return dense[slots[index].dense]; }
+    Handle<T> handleAt(int index) const {
+        return containsIndex(index) ? Handle<T>{(uint32_t)index, slots[index].generation} : Handle<T>();
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+    // One past the highest slot index ever used; sizes tables indexed by id
+    size_t slotCount() const { return slots.size(); }
+
+    void reserve(size_t count) {
+        dense.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    void clear() {
+        dense.clear();
+        denseToSlot.clear();
+        slots.clear();
+        freeSlots.clear();
+    }
+
+    // The dense array, in no particular order once anything was erased
+    const std::vector<T>& values() const { return dense; }
+
+    iterator begin() { return dense.begin(); }
+    iterator end() { return dense.end(); }
+    const_iterator begin() const { return dense.begin(); }
+    const_iterator end() const { return dense.end(); }
+
+private:
+    static constexpr uint32_t FREE = 0xFFFFFFFFu;
+
+    struct Slot {
+        uint32_t dense; // position in the dense array, FREE when unused
+        uint32_t generation;
+    };
+
+    template <typename... Args>
+    Handle<T> place(uint32_t index, Args&&... args) {
+        slots[index].dense = (uint32_t)dense.size();
+        dense.emplace_back(std::forward<Args>(args)...);
+        denseToSlot.push_back(index);
+        return Handle<T>{index, slots[index].generation};
+    }
+
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot; // slot index of each dense entity
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;   // min-heap of free slot indices
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Versioned binary save format. A file is a header, a section table and a
+// run of 16-byte aligned sections, each an array of fixed-size POD records.
+// Loading maps the file and hands out typed views straight into it, so
+// nothing is parsed or copied until the caller builds its own objects.
+//
+// Forward compatibility: readers skip section tags they don't know, and
+// every section records its stride, so a newer writer may append fields
+// to a record without breaking older readers. FORMAT_VERSION only changes
+// when existing fields change meaning.
+
+enum class SnapshotSection : uint32_t {
+    WORLD = 1,          // SnapshotWorld, one record
+    ECONOMY = 2,        // SnapshotEconomy, one record
+    STATIONS = 3,       // SnapshotStation
+    STATION_NAMES = 4,  // char blob addressed by SnapshotStation::nameOffset
+    LINES = 5,          // SnapshotLine
+    TRAINS = 6,         // SnapshotTrain
+    COHORTS = 7,        // SnapshotCohort
+    POPULATION = 8,     // SnapshotPopulation
+    DEMAND = 9,         // SnapshotDemand, one per station in station order
+    DEMAND_ENTRIES = 10 // SnapshotDemandEntry, addressed by SnapshotDemand
+};
+
+struct SnapshotWorld {
+    char countryCode[8];
+    double simClock;
+    double cameraLat;
+    double cameraLon;
+    int32_t zoom;
+    int32_t journalSegment; // first autosave journal segment to replay on top
+};
+
+struct SnapshotEconomy {
+    double money;
+    double monthlyIncome;
+    double monthlyExpenses;
+    float timeAccumulator;
+    int32_t reserved;
+};
+
+struct SnapshotStation {
+    int32_t id;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int32_t reserved;
+    double lat;
+    double lon;
+};
+
+struct SnapshotLine {
+    int32_t id;
+    int32_t station1Id;
+    int32_t station2Id;
+    int32_t reserved;
+    double length;
+};
+
+struct SnapshotTrain {
+    int32_t id;
+    int32_t lineId;
+    int32_t capacity;
+    int32_t reserved;
+    int64_t lastLeg;
+    double epoch; // timetable departure epoch
+};
+
+enum class CohortOwner : int32_t {
+    STATION = 0,
+    TRAIN = 1
+};
+
+struct SnapshotCohort {
+    CohortOwner owner;
+    int32_t ownerId;
+    int32_t origin;
+    int32_t destination;
+    int32_t count;
+    float spawnTime;
+};
+
+struct SnapshotPopulation {
+    double lat;
+    double lon;
+    double radius;
+    int32_t population;
+    int32_t reserved;
+};
+
+// The demand model's state for one origin. Saved rather than rebuilt,
+// since the rebuild is O(stations^2) and would also lose the fractional
+// trips in flight.
+struct SnapshotDemand {
+    int32_t stationId;
+    uint32_t entryOffset;
+    uint32_t entryCount;
+    int32_t reserved;
+    double catchment;
+    double rowTotal;
+    double spawnAccumulator;
+};
+
+struct SnapshotDemandEntry {
+    int32_t destination;
+    float rate;
+    float pending;
+};
+
+// Read-only array view into a mapped section
+template <typename T>
+class SnapshotView {
+public:
+    SnapshotView() : data(nullptr), stride(0), count(0) {}
+    SnapshotView(const unsigned char* data, size_t stride, size_t count)
+        : data(data), stride(stride), count(count) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return *reinterpret_cast<const T*>(data + i * stride); }
+
+private:
+    const unsigned char* data;
+    size_t stride;
+    size_t count;
+};
+
+class SnapshotWriter {
+public:
+    // The record data is referenced, not copied - keep it alive until write()
+    template <typename T>
+    void addSection(SnapshotSection tag, const std::vector<T>& records) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot records must be POD");
+        addSection(tag, records.data(), sizeof(T), records.size());
+    }
+    void addSection(SnapshotSection tag, const void* data, size_t stride, size_t count);
+
+    // Written to a temporary file and renamed, so a crash mid-save never
+    // leaves a truncated snapshot behind
+    bool write(const std::string& path) const;
+    // Lay the whole file out in memory instead, e.g. to hand it to a
+    // writer thread once the records themselves may change
+    void write(std::vector<char>& buffer) const;
+    // write(path) for an already laid out file; safe on any thread
+    static bool writeFile(const std::string& path, const std::vector<char>& buffer);
+
+private:
+    struct PendingSection {
+        SnapshotSection tag;
+        const void* data;
+        size_t stride;
+        size_t count;
+    };
+    std::vector<PendingSection> sections;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader();
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    // Map and validate the file; views stay valid until close()
+    bool open(const std::string& path);
+    void close();
+
+    bool hasSection(SnapshotSection tag) const;
+
+    // Empty when the section is missing or its records are older and
+    // shorter than T
+    template <typename T>
+    SnapshotView<T> getSection(SnapshotSection tag) const {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot records must be POD");
+        const unsigned char* sectionData;
+        size_t stride, count;
+        if (!findSection(tag, sectionData, stride, count) || stride < sizeof(T)) {
+            return SnapshotView<T>();
+        }
+        return SnapshotView<T>(sectionData, stride, count);
+    }
+
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+private:
+    bool findSection(SnapshotSection tag, const unsigned char*& data,
+                     size_t& stride, size_t& count) const;
+
+    const unsigned char* mapping;
+    size_t mappingSize;
+};
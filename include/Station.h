@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include "PassengerCohort.h"
 
 class Station {
 public:
@@ -10,19 +11,17 @@ public:
     int getId() const { return id; }
     double getLat() const { return lat; }
     double getLon() const { return lon; }
-    std::string getName() const { return name; }
+    const std::string& getName() const { return name; }
 
-    // Passenger management
-    void addPassengers(int count);
-    int getPassengerCount() const { return passengerCount; }
-    void removePassengers(int count);
-
-    // Economic data
-    int getBuildCost() const { return buildCost; }
-    int getMaintenanceCost() const { return maintenanceCost; }
+    // Passenger management - waiting passengers are cohorts in the shared arena
+    void addPassengers(CohortArena& arena, int destination, int count, float spawnTime);
+    int getPassengerCount() const { return waiting.getCount(); }
+    CohortPool& getWaiting() { return waiting; }
+    const CohortPool& getWaiting() const { return waiting; }
 
     // Connected lines
     void addConnectedLine(int lineId);
+    void removeConnectedLine(int lineId);
     const std::vector<int>& getConnectedLines() const { return connectedLines; }
 
 private:
@@ -31,9 +30,7 @@ private:
     double lon;
     std::string name;
 
-    int passengerCount;
-    int buildCost;
-    int maintenanceCost;
+    CohortPool waiting;
 
     std::vector<int> connectedLines;
 };
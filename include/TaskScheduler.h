@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. parallelFor cuts a range into grain-sized tasks and
+// deals them across per-worker deques; a worker pops from the back of its
+// own deque and, when that runs dry, steals from the front of the others.
+// The calling thread works too, so nested parallelFor calls cannot deadlock.
+class TaskScheduler {
+public:
+    explicit TaskScheduler(int workerCount);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int getWorkerCount() const { return (int)queues.size(); }
+
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    // Process-wide scheduler sized to the hardware
+    static TaskScheduler& global();
+
+private:
+    struct Job {
+        const std::function<void(int, int)>* body;
+        std::atomic<int> remaining;
+    };
+
+    struct Task {
+        Job* job;
+        int begin;
+        int end;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(int index);
+    bool popOrSteal(int index, Task& task);
+    void runTask(const Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues; // last queue belongs to callers
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> pendingTasks; // queued but not yet started
+    bool stopping;
+};
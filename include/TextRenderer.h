@@ -0,0 +1,85 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Text drawn from one glyph atlas texture per font size. Printable ASCII
+// is rasterized once when a size is first used; after that a string is a
+// run of textured quads appended to a per-atlas vertex batch, and a frame
+// issues one SDL_RenderGeometry call per size on flush().
+//
+// Laid-out strings are kept in a small LRU cache, so a string drawn again
+// is a copy of its quads. Cache entries and batches keep their capacity,
+// so once the UI has settled text rendering allocates nothing.
+class TextRenderer {
+public:
+    TextRenderer(SDL_Renderer* renderer);
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    bool init();
+
+    // Queue text with its top-left corner at x, y. False when no font of
+    // that size could be loaded.
+    bool draw(const std::string& text, int x, int y, int size, SDL_Color color);
+    // Size of the text as draw() would lay it out
+    bool measure(const std::string& text, int size, int& width, int& height);
+
+    // Submit queued text; call before drawing anything that must go on top
+    void flush();
+
+    size_t getCacheHits() const { return cacheHits; }
+    size_t getCacheMisses() const { return cacheMisses; }
+
+private:
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+    static const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+    static const int ATLAS_WIDTH = 512;
+    static const size_t CACHE_SIZE = 64;
+    static const size_t CACHE_TEXT_CAPACITY = 64;
+
+    struct Glyph {
+        float u0, v0, u1, v1; // atlas texture coordinates
+        int width;            // cell size in pixels
+        int height;
+        int advance;
+    };
+
+    struct GlyphAtlas {
+        TTF_Font* font = nullptr;
+        SDL_Texture* texture = nullptr;
+        int lineHeight = 0;
+        Glyph glyphs[GLYPH_COUNT];
+        std::vector<SDL_Vertex> batch; // queued quads, four vertices each
+    };
+
+    // One laid-out string, quads relative to its top-left corner
+    struct CachedText {
+        GlyphAtlas* atlas = nullptr;
+        uint64_t hash = 0;
+        std::string text;
+        std::vector<SDL_Vertex> quads;
+        int width = 0;
+        uint64_t lastUsed = 0;
+    };
+
+    GlyphAtlas* getAtlas(int size);
+    bool buildAtlas(GlyphAtlas& atlas, int size);
+    CachedText& layout(GlyphAtlas* atlas, const std::string& text);
+    const Glyph& glyphFor(const GlyphAtlas& atlas, char c) const;
+
+    SDL_Renderer* renderer;
+    std::map<int, GlyphAtlas> atlases; // by font size; a failed load keeps a null font
+    std::vector<CachedText> cache;
+    std::vector<int> quadIndices;      // 0,1,2, 2,1,3 pattern shared by every batch
+    uint64_t useCounter;
+    size_t cacheHits;
+    size_t cacheMisses;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+class TrainLine;
+class Train;
+
+// Snapshot of a train at a given simulation time
+struct TrainState {
+    double position;        // 0.0 = station1, 1.0 = station2
+    bool movingForward;
+    int nextStationId;
+    double nextArrivalTime; // simulation seconds
+    long legIndex;          // number of completed station-to-station legs
+};
+
+// Trains shuttle at constant speed, so every train's state is a periodic
+// function of the simulation clock. The timetable compiles the network into
+// those periods once; queries are O(1) and nothing is integrated per frame.
+class Timetable {
+public:
+    Timetable();
+
+    // Rebuild schedules from the current network. Trains already running
+    // keep their departure epoch. New trains wait at station1 and leave an
+    // even headway apart, after the line's last departure.
+    void compile(const std::vector<TrainLine>& lines,
+                 const std::vector<Train>& trains,
+                 double simTime);
+    void clear();
+
+    bool hasTrain(int trainId) const;
+    // Unschedule a removed train; a train later given its id starts afresh
+    void removeTrain(int trainId);
+
+    // Departure epochs, exposed so saved games resume mid-journey
+    double getEpoch(int trainId) const;
+    void setEpoch(int trainId, double epoch);
+    TrainState getTrainState(int trainId, double simTime) const;
+
+    // Line service pattern
+    double getLegTime(int lineId) const;  // seconds between the two stations
+    double getPeriod(int lineId) const;   // seconds for a full round trip
+    // Seconds between departures as a rider arriving at random sees them;
+    // period / trains when the trains are evenly spaced
+    double getHeadway(int lineId) const;
+    int getTrainCount(int lineId) const;
+
+private:
+    struct LineSchedule {
+        double legTime;
+        int trainCount;
+    };
+
+    struct TrainSlot {
+        int lineId;
+        int station1Id;
+        int station2Id;
+        double epoch;    // simulation time the train left station1
+        double legTime;
+        bool scheduled;
+    };
+
+    void spaceDepartures(int lineId, const std::vector<int>& running,
+                         std::vector<int>& waiting, double simTime);
+    // From the trains' departure phases, once epochs have settled
+    void computeHeadways() const;
+
+    std::vector<LineSchedule> lineSchedules; // indexed by line id
+    std::vector<TrainSlot> trainSlots;       // indexed by train id
+    mutable std::vector<double> headways;    // indexed by line id
+    mutable bool headwaysStale;
+};
@@ -1,45 +1,48 @@
 #pragma once
 
+#include <functional>
+#include <vector>
+#include "PassengerCohort.h"
+
 class Train {
 public:
     Train(int id, int lineId, int capacity);
 
     int getId() const { return id; }
     int getLineId() const { return lineId; }
+    // Index into the line's train list, kept by the world
+    int getLinePosition() const { return linePosition; }
+    void setLinePosition(int position) { linePosition = position; }
 
-    // Position (0.0 = station1, 1.0 = station2)
-    double getPosition() const { return position; }
-    void setPosition(double pos) { position = pos; }
-
-    // Movement
-    void update(float deltaTime, double lineLength);
-    void reverse();
+    // Movement is scheduled by the Timetable from the speed alone
+    double getSpeed() const { return speed; }
+    static double getDefaultSpeed() { return DEFAULT_SPEED; }
 
-    // Passengers
-    int getPassengerCount() const { return passengerCount; }
+    // Passengers - boarding and alighting move whole cohorts
+    int getPassengerCount() const { return onboard.getCount(); }
     int getCapacity() const { return capacity; }
-    void boardPassengers(int count);
-    void disembarkPassengers(int count);
-
-    // Costs
-    int getPurchaseCost() const { return purchaseCost; }
-    int getMaintenanceCost() const { return maintenanceCost; }
+    CohortPool& getOnboard() { return onboard; }
+    const CohortPool& getOnboard() const { return onboard; }
+    int boardPassengers(CohortArena& arena, CohortPool& platform,
+                        const std::function<bool(const PassengerCohort&)>& wantsToBoard);
+    void disembarkPassengers(CohortArena& arena, int stationId, CohortPool& platform,
+                             std::vector<CompletedTrip>& completed);
+
+    // Last timetable leg whose arrival has been processed; -1 until the
+    // first departure from station1 has boarded
+    long getLastLeg() const { return lastLeg; }
+    void setLastLeg(long leg) { lastLeg = leg; }
 
 private:
     int id;
     int lineId;
-    double position; // 0.0 to 1.0 along the line
-    bool movingForward;
+    int linePosition;
 
     int capacity;
-    int passengerCount;
+    CohortPool onboard;
+    long lastLeg;
 
     double speed; // km/h
 
-    static constexpr int PURCHASE_COST = 10000;
-    static constexpr int MAINTENANCE_COST = 200;
     static constexpr double DEFAULT_SPEED = 80.0; // km/h
-
-    int purchaseCost = PURCHASE_COST;
-    int maintenanceCost = MAINTENANCE_COST;
 };
@@ -11,16 +11,16 @@ public:
     int getStation1() const { return station1Id; }
     int getStation2() const { return station2Id; }
 
-    // Economic data
+    // Costs scale with length; the economy sets the rates
     double getLength() const { return length; }
     void setLength(double len) { length = len; }
 
-    int getBuildCost() const;
-    int getMaintenanceCost() const;
-
-    // Train management
-    void addTrain(int trainId);
-    void removeTrain(int trainId);
+    // Train management. Trains are kept in no particular order: addTrain()
+    // returns the train's position, and removeTrainAt() fills the hole with
+    // the last train and returns that train's id (-1 if none moved), so
+    // the owner can update the moved train's position in O(1).
+    int addTrain(int trainId);
+    int removeTrainAt(int position);
     const std::vector<int>& getTrains() const { return trains; }
 
 private:
@@ -30,8 +30,4 @@ private:
     double length; // in kilometers
 
     std::vector<int> trains;
-
-    // Cost calculation
-    static constexpr double COST_PER_KM = 1000.0;
-    static constexpr double MAINTENANCE_PER_KM = 10.0;
 };
@@ -1,11 +1,11 @@
 #pragma once
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
+#include "TextRenderer.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <functional>
-#include <map>
 
 struct Button {
     int x, y, width, height;
@@ -24,8 +24,20 @@ struct Button {
     }
 };
 
+// A panel drawn once into its own target texture and composited every
+// frame. It is only drawn again when the hash of its inputs changes.
+struct RetainedPanel {
+    SDL_Texture* texture = nullptr;
+    uint64_t inputHash = 0;
+    bool valid = false;
+};
+
 class UIRenderer {
 public:
+    // Menus are laid out for this size and scaled to fit the window
+    static const int LAYOUT_WIDTH = 1280;
+    static const int LAYOUT_HEIGHT = 720;
+
     UIRenderer(SDL_Renderer* renderer);
     ~UIRenderer();
 
@@ -41,14 +53,33 @@ public:
     void renderCountrySelect(const std::vector<Button>& buttons, int scrollOffset);
     void renderLoadingScreen(const std::string& countryName, int current, int total);
 
-    // Info panel
-    void renderInfoPanel(double money, int stationCount, int lineCount);
+    // Info panel. Without refresh a panel drawn before is composited as it
+    // was, even if the figures have changed since.
+    void renderInfoPanel(double money, int stationCount, int lineCount, bool refresh = true);
+
+    // Panels drawn again since startup, for profiling
+    size_t getPanelRedraws() const { return panelRedraws; }
 
 private:
     SDL_Renderer* renderer;
-    std::map<int, TTF_Font*> fonts; // fonts by size
+    TextRenderer text;
+    RetainedPanel mainMenuPanel;
+    RetainedPanel countrySelectPanel;
+    RetainedPanel infoPanel;
+    size_t panelRedraws;
+    std::string lineScratch; // formatted panel lines, reused so redraws don't allocate
+
+    const int INFO_PANEL_WIDTH = 260;  // panel plus its margin from the corner
+    const int INFO_PANEL_HEIGHT = 130;
+
+    // True when the panel must be drawn; drawing then goes to its texture
+    // until endPanel(). Without render target support every frame draws
+    // straight to the screen.
+    bool beginPanel(RetainedPanel& panel, int width, int height, uint64_t inputHash);
+    void endPanel(RetainedPanel& panel);
+    void compositePanel(const RetainedPanel& panel, int width, int height);
+    void destroyPanel(RetainedPanel& panel);
 
     void drawRect(int x, int y, int w, int h, SDL_Color color, bool filled = true);
     void drawText(const std::string& text, int x, int y, int size, SDL_Color color);
-    TTF_Font* getFont(int size);
 };
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Station.h"
+#include "TrainLine.h"
+#include "Economy.h"
+#include "Train.h"
+#include "Timetable.h"
+#include "DemandModel.h"
+#include "Router.h"
+#include "NetworkGraph.h"
+#include "PassengerCohort.h"
+#include "FareTable.h"
+#include "Journal.h"
+#include "Snapshot.h"
+#include "SlotMap.h"
+
+using StationHandle = Handle<Station>;
+using LineHandle = Handle<TrainLine>;
+using TrainHandle = Handle<Train>;
+
+// The simulation and its data model, with no dependency on SDL. The game
+// drives one World from player input; headless runners, benchmarks and
+// tools drive it directly.
+//
+// Entities live in slot maps. Their ids are slot indices, which is what
+// other entities and the derived structures store. Code outside the world
+// should hold handles, which go null instead of dangling when the entity
+// is removed.
+class World {
+public:
+    explicit World(const EconomyConfig& economyConfig = EconomyConfig());
+
+    // Empty network, fresh economy on the world's config, clock at zero
+    void clear();
+    void setPopulation(const std::vector<PopulationCenter>& centers);
+
+    // Player commands. Each applies itself and, when a journal is
+    // attached, is journaled with the balance it saw.
+    bool placeStation(double lat, double lon);
+    bool buildLine(int station1Id, int station2Id);
+    bool addTrain(int lineId);
+    // Retire a train; its riders are lost with it
+    bool removeTrain(TrainHandle handle);
+    // Retire a line and every train on it
+    bool removeLine(LineHandle handle);
+    // Retire a station and every line serving it. Riders from or to it are
+    // lost; its id is free for the next station placed.
+    bool removeStation(StationHandle handle);
+
+    // Commands patch the network graph in place; after a batch of them,
+    // renumber it for locality as a load would
+    void reorderNetwork();
+
+    // Advance the simulation by one tick
+    void update(float deltaTime);
+
+    // Records are appended while the journal is open; null detaches it
+    void setJournal(Journal* newJournal) { journal = newJournal; }
+    // Command feedback on stdout and the process-wide metrics describe the
+    // one world a player or runner is watching. Worlds hosted side by side
+    // turn both off and are reported on by their host.
+    void setReporting(bool enabled);
+    // Re-apply a journaled command or economy delta; other records are
+    // left to the caller
+    void applyJournalRecord(const JournalRecord& record);
+
+    // Snapshot sections besides WORLD, which belongs to the caller. The
+    // header's simClock is filled in here.
+    bool writeSnapshot(const std::string& path, SnapshotWorld header) const;
+    // The same file laid out in memory, for writing off the game thread
+    void writeSnapshot(SnapshotWorld header, std::vector<char>& buffer) const;
+    // Check every cross-reference before anything is replaced
+    static bool validateSnapshot(const SnapshotReader& reader);
+    // Replace this world with a validated snapshot's
+    void loadSnapshot(const SnapshotReader& reader);
+    // Recover a snapshot plus journal segments [firstSegment, endSegment)
+    // into a private world and save that as a new snapshot under header.
+    // Touches no live world, so it can run on any thread.
+    static bool foldJournal(const std::string& snapshotPath, const std::string& journalBase,
+                            int firstSegment, int endSegment, const SnapshotWorld& header,
+                            const std::string& targetPath,
+                            const EconomyConfig& economyConfig = EconomyConfig());
+
+    // FNV-1a over everything commands and the simulation can change
+    uint64_t computeHash() const;
+
+    double getSimClock() const { return simClock; }
+    // Since the last clear() or load; not saved with the game
+    uint64_t getPassengersDelivered() const { return passengersDelivered; }
+    // Riders who gave up waiting, on the same terms
+    uint64_t getPassengersAbandoned() const { return passengersAbandoned; }
+    Economy& getEconomy() { return *economy; }
+    const Economy& getEconomy() const { return *economy; }
+    const SlotMap<Station>& getStations() const { return stations; }
+    const SlotMap<TrainLine>& getLines() const { return trainLines; }
+    const SlotMap<Train>& getTrains() const { return trains; }
+    // Handles for ids; null when nothing lives there
+    StationHandle getStationHandle(int stationId) const { return stations.handleAt(stationId); }
+    LineHandle getLineHandle(int lineId) const { return trainLines.handleAt(lineId); }
+    TrainHandle getTrainHandle(int trainId) const { return trains.handleAt(trainId); }
+    // Null once the entity has been removed
+    const Station* getStation(StationHandle handle) const { return stations.get(handle); }
+    const TrainLine* getLine(LineHandle handle) const { return trainLines.get(handle); }
+    const Train* getTrain(TrainHandle handle) const { return trains.get(handle); }
+    const Timetable& getTimetable() const { return timetable; }
+    const NetworkGraph& getNetworkGraph() const { return networkGraph; }
+    const DemandModel& getDemandModel() const { return demandModel; }
+    // Great-circle distance, cached
+    double getDistance(int station1Id, int station2Id) { return fareTable.getDistance(station1Id, station2Id); }
+
+    static constexpr int TRAIN_CAPACITY = 100;
+    // Riders still waiting on a platform this long after setting out give up
+    static constexpr double MAX_WAIT = 3600.0; // seconds
+
+private:
+    void updateTrains();
+    uint64_t expireWaiting(float cutoff);
+    void updateLineRoute(int lineId);
+    void compileNetwork();
+    // Removal without journaling or rebuilding the derived structures
+    void retireTrain(int trainId);
+    void retireLine(int lineId);
+
+    EconomyConfig economyConfig;
+    std::unique_ptr<Economy> economy;
+    SlotMap<Station> stations;
+    SlotMap<TrainLine> trainLines;
+    SlotMap<Train> trains;
+    Timetable timetable;
+    double simClock; // simulation seconds since the game started
+    uint64_t passengersDelivered;
+    uint64_t passengersAbandoned;
+    DemandModel demandModel;
+    Router router;
+    NetworkGraph networkGraph;
+    CohortArena cohortArena;
+    std::vector<TripRequest> tripRequests;
+    std::vector<CompletedTrip> completedTrips;
+    FareTable fareTable;
+    std::vector<double> tripFares;
+    Journal* journal;
+    bool reporting;
+
+    // Per-tick scratch for the line-parallel train update
+    struct Arrival {
+        int lineId;
+        int trainId;
+        int stationId;
+        int nextStationId;
+    };
+    std::vector<std::vector<Arrival>> lineArrivals;
+    std::vector<Arrival> arrivals;
+    std::vector<int> arrivalGroups;
+    std::vector<std::vector<CompletedTrip>> groupCompleted;
+};
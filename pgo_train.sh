@@ -0,0 +1,53 @@
+#!/bin/bash
+# Build Train Builder with profile-guided and link-time optimization.
+#
+# 1. Builds instrumented binaries (TRAINBUILDER_PGO=GENERATE)
+# 2. Trains them: a large headless scenario, every recorded replay in
+#    REPLAY_DIR, and the offscreen render benchmark
+# 3. Rebuilds the same directory against the collected profiles
+#    (TRAINBUILDER_PGO=USE)
+#
+# Extra arguments go to cmake, e.g. ./pgo_train.sh -DTRAINBUILDER_BENCH=ON
+
+set -e
+
+BUILD_DIR=${BUILD_DIR:-build-pgo}
+REPLAY_DIR=${REPLAY_DIR:-replays}
+BENCH_COUNTRY=${BENCH_COUNTRY:-NL}
+PROFILE_DIR="$(pwd)/$BUILD_DIR/pgo-profiles"
+
+echo "Building instrumented binaries in $BUILD_DIR..."
+rm -rf "$PROFILE_DIR"
+cmake -S . -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release -DTRAINBUILDER_LTO=ON \
+      -DTRAINBUILDER_PGO=GENERATE -DTRAINBUILDER_PGO_DIR="$PROFILE_DIR" "$@"
+cmake --build "$BUILD_DIR" -j"$(nproc)"
+
+echo "Training: headless scenario..."
+"$BUILD_DIR/trainbuilder_headless" --stations 1000 --extra-lines 500 --ticks 1000
+
+if [ -x "$BUILD_DIR/TrainBuilder" ]; then
+    replays=0
+    for log in "$REPLAY_DIR"/*.tblog; do
+        [ -e "$log" ] || continue
+        echo "Training: replay $log..."
+        "$BUILD_DIR/TrainBuilder" --replay "$log" --headless
+        replays=$((replays + 1))
+    done
+    if [ "$replays" -eq 0 ]; then
+        echo "No replays in $REPLAY_DIR; record some with --record to cover the UI paths"
+    fi
+
+    echo "Training: render benchmark..."
+    "$BUILD_DIR/TrainBuilder" --render-bench 600 --country "$BENCH_COUNTRY" --stations 500
+fi
+
+# Clang writes raw per-process profiles that have to be merged first
+if ls "$PROFILE_DIR"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -o "$PROFILE_DIR/merged.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+echo "Rebuilding with profiles..."
+cmake -S . -B "$BUILD_DIR" -DTRAINBUILDER_PGO=USE
+cmake --build "$BUILD_DIR" -j"$(nproc)"
+
+echo "Optimized build complete! Run with: ./$BUILD_DIR/TrainBuilder"
@@ -0,0 +1,97 @@
+#include "AllocationStats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static const int SUBSYSTEM_COUNT = (int)AllocSubsystem::COUNT;
+
+// Zero-initialized before any constructor runs, so allocations made during
+// static initialization are counted too
+static std::atomic<uint64_t> allocationCounts[SUBSYSTEM_COUNT];
+static std::atomic<uint64_t> allocationBytes[SUBSYSTEM_COUNT];
+static thread_local AllocSubsystem currentSubsystem = AllocSubsystem::OTHER;
+
+bool AllocationStats::enabled() {
+#ifdef TRAINBUILDER_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounts AllocationStats::get(AllocSubsystem subsystem) {
+    AllocationCounts counts;
+    counts.allocations = allocationCounts[(int)subsystem].load(std::memory_order_relaxed);
+    counts.bytes = allocationBytes[(int)subsystem].load(std::memory_order_relaxed);
+    return counts;
+}
+
+AllocationCounts AllocationStats::total() {
+    AllocationCounts counts;
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        AllocationCounts subsystem = get((AllocSubsystem)i);
+        counts.allocations += subsystem.allocations;
+        counts.bytes += subsystem.bytes;
+    }
+    return counts;
+}
+
+const char* AllocationStats::name(AllocSubsystem subsystem) {
+    switch (subsystem) {
+        case AllocSubsystem::SIMULATION: return "simulation";
+        case AllocSubsystem::MAP: return "map";
+        case AllocSubsystem::NETWORK: return "network";
+        case AllocSubsystem::UI: return "ui";
+        default: return "other";
+    }
+}
+
+AllocationStats::Scope::Scope(AllocSubsystem subsystem)
+    : previous(currentSubsystem)
+{
+    currentSubsystem = subsystem;
+}
+
+AllocationStats::Scope::~Scope() {
+    currentSubsystem = previous;
+}
+
+#ifdef TRAINBUILDER_ALLOC_STATS
+
+static void* countedAlloc(std::size_t size) {
+    int subsystem = (int)currentSubsystem;
+    allocationCounts[subsystem].fetch_add(1, std::memory_order_relaxed);
+    allocationBytes[subsystem].fetch_add(size, std::memory_order_relaxed);
+
+    // malloc(0) may return null; new must not
+    void* memory = malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+// The library's array and nothrow forms all call these
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    free(memory);
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "CityRenderer.h"
+#include "Geodesy.h"
 #include <cmath>
 #include <random>
 #include <algorithm>
@@ -16,8 +17,15 @@ SDL_Color District::getColor() const {
 
 CityRenderer::CityRenderer(SDL_Renderer* renderer)
     : renderer(renderer)
+    , viewWidth(1280)
+    , viewHeight(720)
 {}
 
+void CityRenderer::setViewSize(int width, int height) {
+    viewWidth = width;
+    viewHeight = height;
+}
+
 CityRenderer::~CityRenderer() {
     districts.clear();
     roads.clear();
@@ -25,18 +33,18 @@ CityRenderer::~CityRenderer() {
 
 void CityRenderer::generateCity(const std::string& countryCode,
                                 double minLat, double maxLat,
-                                double minLon, double maxLon) {
+                                double minLon, double maxLon,
+                                unsigned seed) {
     districts.clear();
     roads.clear();
 
-    generateDistricts(minLat, maxLat, minLon, maxLon);
+    generateDistricts(minLat, maxLat, minLon, maxLon, seed);
     generateRoads();
 }
 
 void CityRenderer::generateDistricts(double minLat, double maxLat,
-                                     double minLon, double maxLon) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+                                     double minLon, double maxLon, unsigned seed) {
+    std::mt19937 gen(seed);
 
     // Calculate area dimensions
     double latRange = maxLat - minLat;
@@ -120,21 +128,21 @@ void CityRenderer::generateRoads() {
 
 CityRenderer::ScreenPos CityRenderer::latLonToScreen(double lat, double lon,
                                                      double centerLat, double centerLon, int zoom) {
-    // Simple mercator-like projection
-    double scale = pow(2.0, zoom) * 100000;
+    // Web Mercator, matching the map tiles
+    double scale = pow(2.0, zoom) * TILE_SIZE;
 
-    int x = SCREEN_WIDTH/2 + (int)((lon - centerLon) * scale);
-    int y = SCREEN_HEIGHT/2 - (int)((lat - centerLat) * scale);
+    int x = viewWidth/2 + (int)((lonToMercatorX(lon) - lonToMercatorX(centerLon)) * scale);
+    int y = viewHeight/2 + (int)((latToMercatorY(lat) - latToMercatorY(centerLat)) * scale);
 
     return {x, y};
 }
 
 CityRenderer::LatLon CityRenderer::screenToLatLon(int x, int y,
                                                   double centerLat, double centerLon, int zoom) {
-    double scale = pow(2.0, zoom) * 100000;
+    double scale = pow(2.0, zoom) * TILE_SIZE;
 
-    double lon = centerLon + (x - SCREEN_WIDTH/2) / scale;
-    double lat = centerLat - (y - SCREEN_HEIGHT/2) / scale;
+    double lon = mercatorXToLon(lonToMercatorX(centerLon) + (x - viewWidth/2) / scale);
+    double lat = mercatorYToLat(latToMercatorY(centerLat) + (y - viewHeight/2) / scale);
 
     return {lat, lon};
 }
@@ -166,13 +174,13 @@ void CityRenderer::render(double centerLat, double centerLon, int zoom) {
         auto center = latLonToScreen(district.lat, district.lon, centerLat, centerLon, zoom);
 
         // Skip if off-screen
-        if (center.x < -200 || center.x > SCREEN_WIDTH + 200 ||
-            center.y < -200 || center.y > SCREEN_HEIGHT + 200) {
+        if (center.x < -200 || center.x > viewWidth + 200 ||
+            center.y < -200 || center.y > viewHeight + 200) {
             continue;
         }
 
         // Calculate radius in pixels based on zoom and actual radius
-        int pixelRadius = (int)(district.radius * pow(2.0, zoom) * 2000);
+        int pixelRadius = (int)(district.radius * 1000.0 / groundResolution(district.lat, zoom));
         pixelRadius = std::max(5, std::min(100, pixelRadius)); // Clamp size
 
         // Draw filled circle using scanline algorithm (much faster)
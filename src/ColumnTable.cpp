@@ -0,0 +1,94 @@
+#include "ColumnTable.h"
+#include "Log.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+static const char COLUMNAR_MAGIC[8] = {'T', 'B', 'C', 'O', 'L', 'S', '1', '\0'};
+
+struct ColumnDescriptor {
+    char name[ColumnTable::NAME_LENGTH];
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+ColumnTable::ColumnTable(size_t rowCount)
+    : rowCount(rowCount)
+{}
+
+int ColumnTable::addColumn(const std::string& name, ColumnType type) {
+    Column column;
+    column.name = name;
+    column.type = type;
+    Value zero;
+    zero.i64 = 0;
+    column.values.assign(rowCount, zero);
+    columns.push_back(std::move(column));
+    return (int)columns.size() - 1;
+}
+
+// Written beside the target and renamed over it, so readers never see a
+// half-written table
+static bool replaceFile(const std::string& path, const std::string& contents) {
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        LOG_ERROR("Cannot write {}", temporary);
+        return false;
+    }
+    bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    written = fclose(file) == 0 && written;
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Cannot write {}", path);
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ColumnTable::writeColumnar(const std::string& path) const {
+    uint64_t header[2] = {rowCount, columns.size()};
+    size_t dataStart = sizeof(COLUMNAR_MAGIC) + sizeof(header) + columns.size() * sizeof(ColumnDescriptor);
+
+    std::string out;
+    out.reserve(dataStart + columns.size() * rowCount * sizeof(Value));
+    out.append(COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+    for (size_t i = 0; i < columns.size(); i++) {
+        ColumnDescriptor descriptor;
+        memset(&descriptor, 0, sizeof(descriptor));
+        strncpy(descriptor.name, columns[i].name.c_str(), NAME_LENGTH - 1);
+        descriptor.type = (uint32_t)columns[i].type;
+        descriptor.offset = dataStart + i * rowCount * sizeof(Value);
+        out.append(reinterpret_cast<const char*>(&descriptor), sizeof(descriptor));
+    }
+    for (const auto& column : columns) {
+        out.append(reinterpret_cast<const char*>(column.values.data()), column.values.size() * sizeof(Value));
+    }
+    return replaceFile(path, out);
+}
+
+bool ColumnTable::writeCsv(const std::string& path) const {
+    std::string out;
+    for (size_t i = 0; i < columns.size(); i++) {
+        out += i == 0 ? "" : ",";
+        out += columns[i].name;
+    }
+    out += "\n";
+
+    char buffer[32];
+    for (size_t row = 0; row < rowCount; row++) {
+        for (size_t i = 0; i < columns.size(); i++) {
+            const Value& value = columns[i].values[row];
+            if (columns[i].type == ColumnType::INT64) {
+                snprintf(buffer, sizeof(buffer), "%s%" PRId64, i == 0 ? "" : ",", value.i64);
+            } else {
+                snprintf(buffer, sizeof(buffer), "%s%.10g", i == 0 ? "" : ",", value.f64);
+            }
+            out += buffer;
+        }
+        out += "\n";
+    }
+    return replaceFile(path, out);
+}
@@ -0,0 +1,243 @@
+#include "DemandModel.h"
+#include "NetworkGraph.h"
+#include "Parallel.h"
+#include "Geodesy.h"
+#include <algorithm>
+#include <cmath>
+
+DemandModel::DemandModel() {}
+
+void DemandModel::setPopulation(const std::vector<PopulationCenter>& newCenters) {
+    centers = newCenters;
+}
+
+void DemandModel::clear() {
+    stationLat.clear();
+    stationLon.clear();
+    catchment.clear();
+    rows.clear();
+    rowTotals.clear();
+    spawnAccumulator.clear();
+}
+
+double DemandModel::computeCatchment(double lat, double lon) const {
+    // Each center contributes the share of its population that falls inside
+    // the station's walking radius, decaying with distance from its core.
+    // Only centers within a few radii count, so a tangent plane at the
+    // station is accurate enough and saves a cosine and a root per center.
+    LocalFrame frame(lat, lon);
+    double total = 0.0;
+    for (const auto& center : centers) {
+        double radius = std::max(center.radius, CATCHMENT_RADIUS_KM);
+        double east, north;
+        frame.toLocal(center.lat, center.lon, east, north);
+        double squared = east * east + north * north;
+        if (squared > 9.0 * radius * radius) continue;
+
+        double areaShare = (CATCHMENT_RADIUS_KM * CATCHMENT_RADIUS_KM) / (radius * radius);
+        double falloff = exp(-squared / (radius * radius));
+        total += center.population * areaShare * falloff;
+    }
+    return total;
+}
+
+float DemandModel::gravity(int from, int to, double distance) const {
+    double d = std::max(MIN_DISTANCE_KM, distance);
+    return (float)(GRAVITY_K * catchment[from] * catchment[to] / pow(d, GRAVITY_BETA));
+}
+
+bool DemandModel::insertEntry(std::vector<DemandEntry>& row, DemandEntry entry, float& evicted) {
+    evicted = 0.0f;
+    if (entry.rate < MIN_RATE) return false;
+
+    if (row.size() < MAX_DESTINATIONS) {
+        row.push_back(entry);
+        return true;
+    }
+
+    // Row is full - replace the weakest destination if the new one beats it
+    auto weakest = std::min_element(row.begin(), row.end(),
+        [](const DemandEntry& a, const DemandEntry& b) { return a.rate < b.rate; });
+    if (weakest->rate >= entry.rate) return false;
+
+    evicted = weakest->rate;
+    *weakest = entry;
+    return true;
+}
+
+void DemandModel::computeRow(int stationId, int count) {
+    // One batched pass for the whole row's distances
+    thread_local std::vector<double> distances;
+    distances.resize(count);
+    haversineKmBatch(stationLat[stationId], stationLon[stationId],
+                     stationLat.data(), stationLon.data(), count, distances.data());
+
+    std::vector<DemandEntry>& row = rows[stationId];
+    row.clear();
+    for (int j = 0; j < count; j++) {
+        if (j == stationId) continue;
+        float rate = gravity(stationId, j, distances[j]);
+        if (rate >= MIN_RATE) {
+            row.push_back({j, rate, 0.0f});
+        }
+    }
+
+    if (row.size() > MAX_DESTINATIONS) {
+        std::nth_element(row.begin(), row.begin() + MAX_DESTINATIONS, row.end(),
+            [](const DemandEntry& a, const DemandEntry& b) { return a.rate > b.rate; });
+        row.resize(MAX_DESTINATIONS);
+    }
+
+    double total = 0.0;
+    for (const auto& entry : row) {
+        total += entry.rate;
+    }
+    rowTotals[stationId] = total;
+}
+
+void DemandModel::rebuild(const NetworkGraph& graph) {
+    // Ids without a station keep a zero catchment, so they neither attract
+    // nor generate trips
+    int count = graph.getStationSlotCount();
+    stationLat.resize(count);
+    stationLon.resize(count);
+    catchment.assign(count, 0.0);
+    rows.resize(count);
+    rowTotals.assign(count, 0.0);
+    spawnAccumulator.resize(count, 0.0);
+
+    parallelFor(0, graph.getNodeCount(), [&](int begin, int end) {
+        for (int node = begin; node < end; node++) {
+            int i = graph.toStation(node);
+            stationLat[i] = graph.getLat(node);
+            stationLon[i] = graph.getLon(node);
+            catchment[i] = computeCatchment(stationLat[i], stationLon[i]);
+        }
+    });
+
+    // Rows are independent - each worker owns a contiguous block of origins
+    parallelFor(0, count, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            computeRow(i, count);
+        }
+    }, 16);
+}
+
+void DemandModel::addStation(int stationId, double lat, double lon) {
+    // A removed station's id can come back, so the new column may fall
+    // anywhere in the existing rows
+    int count = std::max(stationId + 1, (int)rows.size());
+    stationLat.resize(count);
+    stationLon.resize(count);
+    catchment.resize(count);
+    rows.resize(count);
+    rowTotals.resize(count, 0.0);
+    spawnAccumulator.resize(count, 0.0);
+
+    stationLat[stationId] = lat;
+    stationLon[stationId] = lon;
+    catchment[stationId] = computeCatchment(lat, lon);
+
+    // New column: every existing origin gains one candidate destination.
+    // The gravity model is symmetric, so the same rates form the new row.
+    // Free ids have no catchment and are skipped by insertEntry().
+    std::vector<double> distances(count);
+    haversineKmBatch(lat, lon, stationLat.data(), stationLon.data(), count, distances.data());
+
+    std::vector<float> rates(count, 0.0f);
+    parallelFor(0, count, [&](int begin, int end) {
+        for (int j = begin; j < end; j++) {
+            if (j == stationId) continue;
+            float rate = gravity(j, stationId, distances[j]);
+            float evicted;
+            rates[j] = rate;
+            if (insertEntry(rows[j], {stationId, rate, 0.0f}, evicted)) {
+                rowTotals[j] += rate - evicted;
+            }
+        }
+    }, 1024);
+
+    std::vector<DemandEntry>& row = rows[stationId];
+    row.clear();
+    double total = 0.0;
+    for (int j = 0; j < count; j++) {
+        float evicted;
+        if (j != stationId && insertEntry(row, {j, rates[j], 0.0f}, evicted)) {
+            total += rates[j] - evicted;
+        }
+    }
+    rowTotals[stationId] = total;
+}
+
+void DemandModel::removeStation(int stationId) {
+    if (stationId < 0 || stationId >= (int)rows.size()) return;
+
+    // Zero catchment keeps the id out of any row added later
+    catchment[stationId] = 0.0;
+    rows[stationId].clear();
+    rowTotals[stationId] = 0.0;
+    spawnAccumulator[stationId] = 0.0;
+
+    parallelFor(0, (int)rows.size(), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            std::vector<DemandEntry>& row = rows[i];
+            for (size_t k = 0; k < row.size(); k++) {
+                if (row[k].destination != stationId) continue;
+                rowTotals[i] -= row[k].rate;
+                row[k] = row.back();
+                row.pop_back();
+                break;
+            }
+        }
+    }, 1024);
+}
+
+void DemandModel::restoreStation(int stationId, double lat, double lon, double savedCatchment,
+                                 double rowTotal, double savedAccumulator,
+                                 const std::vector<DemandEntry>& row) {
+    if (stationId >= (int)rows.size()) {
+        int count = stationId + 1;
+        stationLat.resize(count);
+        stationLon.resize(count);
+        catchment.resize(count);
+        rows.resize(count);
+        rowTotals.resize(count, 0.0);
+        spawnAccumulator.resize(count, 0.0);
+    }
+    stationLat[stationId] = lat;
+    stationLon[stationId] = lon;
+    catchment[stationId] = savedCatchment;
+    rows[stationId] = row;
+    rowTotals[stationId] = rowTotal;
+    spawnAccumulator[stationId] = savedAccumulator;
+}
+
+size_t DemandModel::getNonZeroCount() const {
+    size_t total = 0;
+    for (const auto& row : rows) {
+        total += row.size();
+    }
+    return total;
+}
+
+void DemandModel::generate(float deltaTime, std::vector<TripRequest>& trips) {
+    int count = rows.size();
+    for (int i = 0; i < count; i++) {
+        spawnAccumulator[i] += rowTotals[i] * deltaTime;
+        if (spawnAccumulator[i] < 1.0) continue;
+
+        // Share the origin's whole trips across destinations by rate,
+        // carrying fractions per pair so every destination is served
+        int whole = (int)spawnAccumulator[i];
+        spawnAccumulator[i] -= whole;
+        double scale = whole / rowTotals[i];
+        for (auto& entry : rows[i]) {
+            entry.pending += (float)(entry.rate * scale);
+            if (entry.pending >= 1.0f) {
+                int spawned = (int)entry.pending;
+                entry.pending -= spawned;
+                trips.push_back({i, entry.destination, spawned});
+            }
+        }
+    }
+}
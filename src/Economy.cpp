@@ -1,45 +1,147 @@
 #include "Economy.h"
+#include "Metrics.h"
 #include <algorithm>
+#include <cmath>
 
-Economy::Economy()
-    : money(STARTING_MONEY)
+struct EconomyMetrics {
+    MetricGauge& money;
+    MetricGauge& monthlyIncome;
+    MetricGauge& monthlyExpenses;
+    MetricCounter& monthsSettled;
+};
+
+static EconomyMetrics& economyMetrics() {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    static EconomyMetrics metrics = {
+        registry.gauge("trainbuilder_money", "Bank balance"),
+        registry.gauge("trainbuilder_month_income", "Revenue so far this month"),
+        registry.gauge("trainbuilder_month_expenses", "Costs recorded so far this month"),
+        registry.counter("trainbuilder_months_settled_total", "Monthly settlements run"),
+    };
+    return metrics;
+}
+
+double* EconomyConfig::field(const std::string& name) {
+    if (name == "starting-money") return &startingMoney;
+    if (name == "station-build-cost") return &stationBuildCost;
+    if (name == "station-maintenance") return &stationMaintenance;
+    if (name == "line-build-cost-per-km") return &lineBuildCostPerKm;
+    if (name == "line-maintenance-per-km") return &lineMaintenancePerKm;
+    if (name == "train-purchase-cost") return &trainPurchaseCost;
+    if (name == "train-maintenance") return &trainMaintenance;
+    if (name == "ticket-price-per-km") return &ticketPricePerKm;
+    return nullptr;
+}
+
+const std::vector<std::string>& EconomyConfig::fieldNames() {
+    static const std::vector<std::string> names = {
+        "starting-money", "station-build-cost", "station-maintenance", "line-build-cost-per-km",
+        "line-maintenance-per-km", "train-purchase-cost", "train-maintenance", "ticket-price-per-km"};
+    return names;
+}
+
+Economy::Economy(const EconomyConfig& config)
+    : config(config)
+    , money(config.startingMoney)
     , monthlyIncome(0.0)
     , monthlyExpenses(0.0)
+    , totalIncome(0.0)
+    , totalSpent(0.0)
+    , paidCosts(0.0)
     , timeAccumulator(0.0f)
 {}
 
 bool Economy::spendMoney(double amount) {
-    if (money >= amount) {
+    if (money >= amount || overdraft) {
         money -= amount;
+        totalSpent += amount;
         return true;
     }
     return false;
 }
 
+bool Economy::spendMoney(LedgerAccount account, int id, double amount) {
+    if (!spendMoney(amount)) return false;
+    recordCost(account, id, amount);
+    paidCosts += amount;
+    return true;
+}
+
 void Economy::earnMoney(double amount) {
     money += amount;
     monthlyIncome += amount;
+    totalIncome += amount;
+}
+
+void Economy::recordRevenue(LedgerAccount account, int id, double amount) {
+    ledger.recordRevenue(account, id, amount);
+    if (account == LedgerAccount::STATION) {
+        earnMoney(amount);
+    }
+}
+
+void Economy::recordCost(LedgerAccount account, int id, double amount) {
+    ledger.recordCost(account, id, amount);
+    monthlyExpenses += amount;
 }
 
 void Economy::update(float deltaTime) {
     timeAccumulator += deltaTime;
+    ledger.endTick();
+
+    // Process monthly expenses every 30 seconds (simulated month). Income
+    // and purchases are already settled; settlement charges upkeep and the
+    // other recorded costs.
+    bool settled = timeAccumulator >= 30.0f;
+    if (settled) {
+        LedgerPeriod month = ledger.settleMonth();
+        double charged = month.costs - paidCosts;
+        money -= charged;
+        totalSpent += charged;
+        paidCosts = 0.0;
+        // The month's expenses are everything it recorded, upkeep included
+        monthlyExpenses = month.costs;
+        timeAccumulator = 0.0f;
+    }
 
-    // Process monthly expenses every 30 seconds (simulated month)
-    if (timeAccumulator >= 30.0f) {
-        money -= monthlyExpenses;
-        money += monthlyIncome;
+    // Published before the reset, so a settled month reports its totals
+    if (publishMetrics) {
+        EconomyMetrics& metrics = economyMetrics();
+        metrics.money.set(money);
+        metrics.monthlyIncome.set(monthlyIncome);
+        metrics.monthlyExpenses.set(monthlyExpenses);
+        if (settled) metrics.monthsSettled.add();
+    }
 
-        // Reset counters
+    if (settled) {
         monthlyIncome = 0.0;
         monthlyExpenses = 0.0;
-        timeAccumulator = 0.0f;
     }
 }
 
+void Economy::restore(double savedMoney, double savedIncome, double savedExpenses, float savedTime) {
+    money = savedMoney;
+    monthlyIncome = savedIncome;
+    monthlyExpenses = savedExpenses;
+    timeAccumulator = savedTime;
+    totalIncome = 0.0;
+    totalSpent = 0.0;
+}
+
+void Economy::waiveRecordedCosts() {
+    ledger.clearCosts();
+    monthlyExpenses = 0.0;
+    paidCosts = 0.0;
+}
+
 bool Economy::canBuildStation() const {
-    return money >= stationBuildCost;
+    return money >= config.stationBuildCost || overdraft;
+}
+
+double Economy::getLineMaintenanceCost(double lengthKm) const {
+    return std::floor(lengthKm * config.lineMaintenancePerKm);
 }
 
 double Economy::calculateTicketRevenue(int passengers, double distance) const {
-    return passengers * distance * TICKET_PRICE_PER_KM;
+    return passengers * distance * config.ticketPricePerKm;
 }
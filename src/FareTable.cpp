@@ -0,0 +1,131 @@
+#include "FareTable.h"
+#include "Geodesy.h"
+#include <algorithm>
+#include <iterator>
+
+FareTable::FareTable()
+    : dense(true)
+    , stride(0)
+{}
+
+void FareTable::clear() {
+    lats.clear();
+    lons.clear();
+    dense = true;
+    stride = 0;
+    matrix.clear();
+    sparse.clear();
+}
+
+double FareTable::computeDistance(int from, int to) const {
+    return haversineKm(lats[from], lons[from], lats[to], lons[to]);
+}
+
+void FareTable::growDense(int count, int filled) {
+    if (count <= stride) return;
+
+    // Double the stride so growth copies are amortized O(1) per station
+    int newStride = std::max(64, stride * 2);
+    while (newStride < count) {
+        newStride *= 2;
+    }
+
+    std::vector<float> grown((size_t)newStride * newStride, 0.0f);
+    for (int i = 0; i < filled; i++) {
+        std::copy(matrix.begin() + (size_t)i * stride,
+                  matrix.begin() + (size_t)i * stride + filled,
+                  grown.begin() + (size_t)i * newStride);
+    }
+    matrix.swap(grown);
+    stride = newStride;
+}
+
+void FareTable::addStation(int stationId, double lat, double lon) {
+    int filled = lats.size();
+    if (stationId >= (int)lats.size()) {
+        lats.resize(stationId + 1);
+        lons.resize(stationId + 1);
+    }
+    lats[stationId] = lat;
+    lons[stationId] = lon;
+
+    int count = lats.size();
+    if (dense && count > DENSE_LIMIT) {
+        // Too big to keep every pair - fall back to memoizing on demand
+        dense = false;
+        std::vector<float>().swap(matrix);
+        stride = 0;
+    }
+    if (!dense) return;
+
+    // Only the new row and column need computing
+    growDense(count, filled);
+    rowDistances.resize(count);
+    haversineKmBatch(lat, lon, lats.data(), lons.data(), count, rowDistances.data());
+    for (int j = 0; j < count; j++) {
+        float d = (float)rowDistances[j];
+        matrix[(size_t)stationId * stride + j] = d;
+        matrix[(size_t)j * stride + stationId] = d;
+    }
+}
+
+void FareTable::setStations(const std::vector<double>& stationLats, const std::vector<double>& stationLons) {
+    clear();
+    lats = stationLats;
+    lons = stationLons;
+    int count = lats.size();
+    if (count > DENSE_LIMIT) {
+        dense = false;
+        return;
+    }
+    growDense(count, 0);
+    std::fill(matrix.begin(), matrix.end(), UNKNOWN);
+}
+
+void FareTable::removeStation(int stationId) {
+    if (dense) return;
+    for (auto it = sparse.begin(); it != sparse.end();) {
+        bool touches = (int)(it->first >> 32) == stationId || (int)(uint32_t)it->first == stationId;
+        it = touches ? sparse.erase(it) : std::next(it);
+    }
+}
+
+double FareTable::getDistance(int from, int to) {
+    if (from == to) return 0.0;
+    if (dense) {
+        float& d = matrix[(size_t)from * stride + to];
+        if (d == UNKNOWN) {
+            // The later station's row, as addStation() would have computed it
+            d = (float)computeDistance(std::max(from, to), std::min(from, to));
+            matrix[(size_t)to * stride + from] = d;
+        }
+        return d;
+    }
+
+    uint64_t key = ((uint64_t)std::min(from, to) << 32) | (uint32_t)std::max(from, to);
+    auto it = sparse.find(key);
+    if (it != sparse.end()) {
+        return it->second;
+    }
+    float d = (float)computeDistance(from, to);
+    sparse.emplace(key, d);
+    return d;
+}
+
+double FareTable::billTrips(const std::vector<CompletedTrip>& trips, double pricePerKm,
+                            std::vector<double>& fares) {
+    size_t count = trips.size();
+    tripDistances.resize(count);
+    fares.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        tripDistances[i] = (float)getDistance(trips[i].origin, trips[i].destination);
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        fares[i] = trips[i].count * (double)tripDistances[i] * pricePerKm;
+        total += fares[i];
+    }
+    return total;
+}
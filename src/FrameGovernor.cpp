@@ -0,0 +1,101 @@
+#include "FrameGovernor.h"
+#include "Log.h"
+#include <algorithm>
+#include <cmath>
+
+// Exponential moving average weight of the newest frame
+static const double AVERAGE_WEIGHT = 0.1;
+// Step back up only once there is clear headroom, so levels don't flap
+static const double HEADROOM = 0.75;
+
+FrameGovernor::FrameGovernor(const FrameGovernorOptions& options)
+    : options(options)
+    , level(0)
+    , averageMs(0.0)
+    , overFrames(0)
+    , underFrames(0)
+    , shedFrames{}
+    , scaledFrames(0)
+{}
+
+void FrameGovernor::setOptions(const FrameGovernorOptions& newOptions) {
+    options = newOptions;
+    int oldLevel = level;
+    level = options.enabled ? std::min(level, maxLevel()) : 0;
+    overFrames = 0;
+    underFrames = 0;
+    if (level != oldLevel) {
+        announce(oldLevel);
+    }
+}
+
+int FrameGovernor::maxLevel() const {
+    if (!options.dynamicResolution || options.scaleStep <= 0.0f) {
+        return SHED_LEVELS;
+    }
+    return SHED_LEVELS + (int)std::round((1.0f - options.minScale) / options.scaleStep);
+}
+
+void FrameGovernor::endFrame(double workMs) {
+    if (!options.enabled) return;
+
+    averageMs = averageMs == 0.0 ? workMs : averageMs + AVERAGE_WEIGHT * (workMs - averageMs);
+    for (int i = 0; i < SHED_LEVELS; i++) {
+        if (isShed((SheddableWork)i)) shedFrames[i]++;
+    }
+    if (getResolutionScale() < 1.0f) scaledFrames++;
+
+    if (averageMs > options.budgetMs) {
+        underFrames = 0;
+        if (++overFrames >= OVER_BUDGET_FRAMES && level < maxLevel()) {
+            overFrames = 0;
+            level++;
+            announce(level - 1);
+        }
+    } else if (averageMs < options.budgetMs * HEADROOM) {
+        overFrames = 0;
+        if (++underFrames >= UNDER_BUDGET_FRAMES && level > 0) {
+            underFrames = 0;
+            level--;
+            announce(level + 1);
+        }
+    } else {
+        overFrames = 0;
+        underFrames = 0;
+    }
+}
+
+float FrameGovernor::getResolutionScale() const {
+    int steps = level - SHED_LEVELS;
+    if (steps <= 0) return 1.0f;
+    return std::max(options.minScale, 1.0f - steps * options.scaleStep);
+}
+
+bool FrameGovernor::isShed(SheddableWork work) const {
+    return level > (int)work;
+}
+
+std::string FrameGovernor::describe() const {
+    std::string description = "scene at " + std::to_string((int)std::round(getResolutionScale() * 100.0f)) + "%";
+    for (int i = 0; i < SHED_LEVELS; i++) {
+        if (!isShed((SheddableWork)i)) continue;
+        description += i == 0 ? ", shedding " : ", ";
+        description += name((SheddableWork)i);
+    }
+    return description;
+}
+
+const char* FrameGovernor::name(SheddableWork work) {
+    switch (work) {
+        case SheddableWork::OVERLAY_UPDATES: return "overlay updates";
+        case SheddableWork::TILE_PREFETCH: return "tile prefetch";
+        case SheddableWork::TRAIN_DETAIL: return "train detail";
+        default: return "unknown";
+    }
+}
+
+void FrameGovernor::announce(int oldLevel) const {
+    const char* direction = level > oldLevel ? "over" : "under";
+    LOG_INFO("Frame governor: {} ms average, {} the {} ms budget; now {}", averageMs, direction,
+             options.budgetMs, describe());
+}
@@ -1,16 +1,70 @@
 #include "Game.h"
+#include "Geodesy.h"
+#include "Snapshot.h"
+#include "Scenario.h"
+#include "RenderStats.h"
+#include "AllocationStats.h"
+#include "Metrics.h"
+#include "Log.h"
+#include "Parallel.h"
 #include <iostream>
 #include <cmath>
-
-const int SCREEN_WIDTH = 1280;
-const int SCREEN_HEIGHT = 720;
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* const SAVE_DIRECTORY = "saves";
+const char* const AUTOSAVE_NAME = "autosave";
+const double TICK_SECONDS = 1.0 / 60.0;
+const double MAX_FRAME_TIME = 0.25;
+const float AUTOSAVE_INTERVAL = 5.0f;     // seconds between economy/camera deltas
+const float COMPACTION_INTERVAL = 300.0f; // seconds between full snapshots
+const int COMPACTION_RUNNING = -1;        // compactionResult while the writer runs
+const int OVERLAY_REFRESH_FRAMES = 30;    // info panel refresh while overlay updates are shed
+const int MIN_DETAIL_LINE_PIXELS = 24;    // shortest line that keeps train markers when detail is shed
+
+// A frame's work time and what the governor did about it
+static void publishFrame(double workMs, const FrameGovernor& governor) {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    static MetricHistogram& frameSeconds = registry.histogram(
+        "trainbuilder_frame_seconds", "Work time of one rendered frame, excluding present and vsync",
+        MetricHistogram::exponentialBounds(0.001, 1.5, 14));
+    static MetricGauge& level = registry.gauge("trainbuilder_frame_governor_level",
+                                               "Frame governor steps below full quality");
+    static MetricGauge& scale = registry.gauge("trainbuilder_scene_resolution_scale",
+                                               "Scene resolution relative to the window");
+    frameSeconds.observe(workMs / 1000.0);
+    level.set(governor.getLevel());
+    scale.set(governor.getResolutionScale());
+}
 
 Game::Game()
     : window(nullptr)
     , renderer(nullptr)
+    , offscreen(nullptr)
+    , viewWidth(1280)
+    , viewHeight(720)
+    , menuLayout(false)
+    , sceneTarget(nullptr)
+    , sceneWidth(0)
+    , sceneHeight(0)
+    , frameCount(0)
     , running(false)
+    , headless(false)
+    , exitCode(0)
+    , renderBenchFrames(0)
+    , benchStations(0)
+    , tick(0)
+    , worldSeed(0)
+    , compactionResult(COMPACTION_RUNNING)
+    , compactionSegment(0)
+    , autosaveSegment(-1)
+    , autosaveTimer(0.0f)
+    , compactionTimer(0.0f)
     , currentMode(Mode::VIEW)
-    , selectedStation(nullptr)
     , isDragging(false)
     , mapCenterLat(52.3676)
     , mapCenterLon(4.9041)
@@ -22,41 +76,72 @@ Game::~Game() {
     cleanup();
 }
 
-bool Game::init() {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+bool Game::init(const GameOptions& options) {
+    headless = options.headless;
+    renderBenchFrames = options.renderBenchFrames;
+    benchCountry = options.benchCountry;
+    benchStations = options.benchStations;
+    viewWidth = std::max(1, options.windowWidth);
+    viewHeight = std::max(1, options.windowHeight);
+
+    FrameGovernorOptions governorOptions;
+    governorOptions.enabled = renderBenchFrames == 0 || options.frameBudgetMs > 0.0;
+    if (options.frameBudgetMs > 0.0) {
+        governorOptions.budgetMs = options.frameBudgetMs;
+    }
+    governorOptions.dynamicResolution = options.dynamicResolution;
+    governor.setOptions(governorOptions);
+    if (headless && options.replayPath.empty()) {
+        LOG_ERROR("Headless mode needs a replay to drive it");
         return false;
     }
 
-    window = SDL_CreateWindow(
-        "Train Builder - Economic Simulator",
-        SDL_WINDOWPOS_CENTERED,
-        SDL_WINDOWPOS_CENTERED,
-        SCREEN_WIDTH,
-        SCREEN_HEIGHT,
-        SDL_WINDOW_SHOWN
-    );
-
-    if (!window) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
+    if (!options.replayPath.empty()) {
+        replay = std::make_unique<InputReplay>();
+        if (!replay->open(options.replayPath)) return false;
+        if (replay->getTickSeconds() != TICK_SECONDS) {
+            LOG_ERROR("Input log was recorded with a different tick length");
+            return false;
+        }
+        worldSeed = replay->getSeed();
+    } else {
+        worldSeed = std::random_device()();
+    }
+    seedSource.seed(worldSeed);
+
+    if (!options.recordPath.empty()) {
+        recorder = std::make_unique<InputRecorder>();
+        if (!recorder->open(options.recordPath, worldSeed, TICK_SECONDS)) return false;
+
+        // A replay starts from the same view size, so clicks land where they did
+        SDL_Event sized;
+        memset(&sized, 0, sizeof(sized));
+        sized.type = SDL_WINDOWEVENT;
+        sized.window.event = SDL_WINDOWEVENT_SIZE_CHANGED;
+        sized.window.data1 = viewWidth;
+        sized.window.data2 = viewHeight;
+        recorder->record(0, sized);
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (!renderer) {
-        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+    if (renderBenchFrames > 0) {
+        // No video subsystem at all: the software renderer draws into a
+        // plain surface, so the benchmark runs on machines without a display
+        offscreen = SDL_CreateRGBSurfaceWithFormat(0, viewWidth, viewHeight, 32, SDL_PIXELFORMAT_RGBA32);
+        renderer = offscreen ? SDL_CreateSoftwareRenderer(offscreen) : nullptr;
+        if (!renderer) {
+            LOG_ERROR("Offscreen renderer could not be created! SDL_Error: {}", SDL_GetError());
+            return false;
+        }
+    } else if (!createWindow()) {
         return false;
     }
 
-    // Software vsync fallback (VSync doesn't work in Xvfb)
-    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
-
     // Initialize subsystems
     gameState = std::make_unique<GameStateManager>();
     uiRenderer = std::make_unique<UIRenderer>(renderer);
 
     if (!uiRenderer->init()) {
-        std::cerr << "Failed to initialize UI renderer!" << std::endl;
+        LOG_ERROR("Failed to initialize UI renderer!");
         return false;
     }
 
@@ -65,8 +150,10 @@ bool Game::init() {
         gameState->setState(GameStateType::COUNTRY_SELECT);
     }));
     mainMenuButtons.push_back(Button(440, 380, 400, 60, "Continue Game", [this]() {
-        // TODO: Load last save
-        std::cout << "Continue not implemented yet" << std::endl;
+        // The autosave is always the newest state; fall back to the quicksave
+        if (recoverAutosave() || (loadGame(getSavePath()) && startAutosave(getSavePath()))) {
+            gameState->setState(GameStateType::PLAYING);
+        }
     }));
     mainMenuButtons.push_back(Button(440, 460, 400, 60, "Options", [this]() {
         gameState->setState(GameStateType::OPTIONS);
@@ -89,23 +176,88 @@ bool Game::init() {
     return true;
 }
 
+bool Game::createWindow() {
+    // Headless runs still need a renderer for textures, just not a display
+    if (headless) {
+        setenv("SDL_VIDEODRIVER", "dummy", 0);
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        LOG_ERROR("SDL could not initialize! SDL_Error: {}", SDL_GetError());
+        return false;
+    }
+
+    window = SDL_CreateWindow(
+        "Train Builder - Economic Simulator",
+        SDL_WINDOWPOS_CENTERED,
+        SDL_WINDOWPOS_CENTERED,
+        viewWidth,
+        viewHeight,
+        headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+    );
+
+    if (!window) {
+        LOG_ERROR("Window could not be created! SDL_Error: {}", SDL_GetError());
+        return false;
+    }
+
+    renderer = SDL_CreateRenderer(window, -1, headless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED);
+    if (!renderer) {
+        LOG_ERROR("Renderer could not be created! SDL_Error: {}", SDL_GetError());
+        return false;
+    }
+
+    // Software vsync fallback (VSync doesn't work in Xvfb)
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+    return true;
+}
+
 void Game::startNewGame(const Country& country) {
-    std::cout << "Starting new game in " << country.name << std::endl;
+    LOG_INFO("Starting new game in {}", country.name);
+
+    if (!resetWorld(country)) return;
+
+    // Population districts drive passenger demand
+    cityRenderer = std::make_unique<CityRenderer>(renderer);
+    cityRenderer->setViewSize(viewWidth, viewHeight);
+    cityRenderer->generateCity(country.code, country.minLat, country.maxLat,
+                               country.minLon, country.maxLon, seedSource());
+
+    std::vector<PopulationCenter> centers;
+    for (const auto& district : cityRenderer->getDistricts()) {
+        centers.push_back({district.lat, district.lon, district.radius, district.population});
+    }
+    world.setPopulation(centers);
+    startAutosave([path = getAutosavePath(), centers = std::move(centers)](const SnapshotWorld& header) {
+        World fresh;
+        fresh.setReporting(false);
+        fresh.setPopulation(centers);
+        return fresh.writeSnapshot(path, header);
+    });
+
+    // Switch to playing state - tiles are already pre-downloaded!
+    gameState->setState(GameStateType::PLAYING);
+}
+
+bool Game::resetWorld(const Country& country) {
+    // The previous world's journal must not record this one's setup
+    stopAutosave();
 
     // Select country
     gameState->selectCountry(country);
 
     // Initialize map renderer (uses pre-downloaded tiles!)
     mapRenderer = std::make_unique<MapRenderer>(renderer);
+    mapRenderer->setViewSize(viewWidth, viewHeight);
     if (!mapRenderer->init(country.centerLat, country.centerLon, country.defaultZoom)) {
-        std::cerr << "Failed to initialize map renderer!" << std::endl;
-        return;
+        LOG_ERROR("Failed to initialize map renderer!");
+        return false;
     }
 
     // Set country for tile storage
     mapRenderer->setCountry(country.code);
 
-    economy = std::make_unique<Economy>();
+    cityRenderer.reset();
 
     // Set map bounds to country
     mapCenterLat = country.centerLat;
@@ -113,28 +265,267 @@ void Game::startNewGame(const Country& country) {
     zoomLevel = country.defaultZoom;
 
     // Clear existing data
-    stations.clear();
-    trainLines.clear();
-    trains.clear();
+    world.clear();
+    selectedStation = StationHandle();
+    return true;
+}
 
-    // Switch to playing state - tiles are already pre-downloaded!
-    gameState->setState(GameStateType::PLAYING);
+std::string Game::getSavePath() const {
+    return std::string(SAVE_DIRECTORY) + "/" + gameState->getCurrentSaveName() + ".tbsave";
+}
+
+bool Game::saveGame(const std::string& path) {
+    if (!writeSnapshot(path, 0)) return false;
+
+    LOG_INFO("Saved game to {}", path);
+    return true;
+}
+
+bool Game::makeSnapshotHeader(int journalSegment, SnapshotWorld& header) const {
+    const Country* country = gameState->getSelectedCountry();
+    if (!country) return false;
+
+    header = SnapshotWorld{};
+    strncpy(header.countryCode, country->code.c_str(), sizeof(header.countryCode) - 1);
+    header.cameraLat = mapCenterLat;
+    header.cameraLon = mapCenterLon;
+    header.zoom = zoomLevel;
+    header.journalSegment = journalSegment;
+    return true;
+}
+
+bool Game::writeSnapshot(const std::string& path, int journalSegment) const {
+    SnapshotWorld header;
+    if (!makeSnapshotHeader(journalSegment, header)) return false;
+
+    mkdir(SAVE_DIRECTORY, 0755);
+    return world.writeSnapshot(path, header);
+}
+
+bool Game::loadGame(const std::string& path, int* journalSegment) {
+    SnapshotReader reader;
+    if (!reader.open(path)) {
+        LOG_INFO("No saved game at {}", path);
+        return false;
+    }
+
+    // Check every cross-reference before touching the running world
+    if (!World::validateSnapshot(reader)) return false;
+
+    auto header = reader.getSection<SnapshotWorld>(SnapshotSection::WORLD);
+    std::string code(header[0].countryCode, strnlen(header[0].countryCode, sizeof(header[0].countryCode)));
+    const Country* country = gameState->findCountry(code);
+    if (!country) {
+        LOG_ERROR("Saved game uses unknown country {}", code);
+        return false;
+    }
+
+    if (!resetWorld(*country)) return false;
+
+    world.loadSnapshot(reader);
+    if (journalSegment) {
+        *journalSegment = header[0].journalSegment;
+    }
+    mapCenterLat = header[0].cameraLat;
+    mapCenterLon = header[0].cameraLon;
+    zoomLevel = header[0].zoom;
+
+    LOG_INFO("Loaded {} stations, {} lines and {} trains from {}", world.getStations().size(),
+             world.getLines().size(), world.getTrains().size(), path);
+    return true;
+}
+
+std::string Game::getAutosavePath() const {
+    return std::string(SAVE_DIRECTORY) + "/" + AUTOSAVE_NAME + ".tbsave";
+}
+
+std::string Game::getJournalPath() const {
+    return std::string(SAVE_DIRECTORY) + "/" + AUTOSAVE_NAME + ".journal";
+}
+
+bool Game::startAutosave(std::function<bool(const SnapshotWorld& header)> writeBase) {
+    stopAutosave();
+
+    // Replays must never overwrite the player's own autosave
+    if (replay) return false;
+
+    // One segment is left unused, so until the new base snapshot lands a
+    // crash recovers the old autosave without running on into this
+    // world's records. The base points past every older segment, which
+    // are deleted once it is on disk.
+    std::string journalPath = getJournalPath();
+    int segment = Journal::findLastSegment(journalPath) + 2;
+    SnapshotWorld header;
+    if (!makeSnapshotHeader(segment, header)) return false;
+    mkdir(SAVE_DIRECTORY, 0755);
+
+    autosaveTimer = 0.0f;
+    compactionTimer = 0.0f;
+    autosaveSegment = -1;
+    if (!journal.open(journalPath, segment)) return false;
+    world.setJournal(&journal);
+
+    compactionSegment = segment;
+    compactionResult.store(COMPACTION_RUNNING, std::memory_order_relaxed);
+    compactionWriter = std::thread([this, header, writeBase = std::move(writeBase)] {
+        SerialScope serial;
+        compactionResult.store(writeBase(header) ? 1 : 0, std::memory_order_release);
+    });
+    return true;
+}
+
+bool Game::startAutosave(const std::string& basePath, int replayFrom, int replayEnd) {
+    return startAutosave([basePath, replayFrom, replayEnd, journalPath = getJournalPath(),
+                          path = getAutosavePath()](const SnapshotWorld& header) {
+        return World::foldJournal(basePath, journalPath, replayFrom, replayEnd, header, path);
+    });
+}
+
+void Game::stopAutosave() {
+    world.setJournal(nullptr);
+    journal.close();
+    if (compactionWriter.joinable()) {
+        compactionWriter.join();
+    }
+}
+
+void Game::compactAutosave() {
+    if (compactionWriter.joinable() || !journal.isOpen() || autosaveSegment < 0) return;
+
+    // Checked first, so a segment is never closed without a snapshot
+    // coming to cover it
+    SnapshotWorld header;
+    if (!makeSnapshotHeader(0, header)) return;
+
+    // The game thread only closes the segment. The writer waits for it to
+    // reach disk, then replays everything since the last snapshot into a
+    // private copy of it, which is exactly what recovery would rebuild.
+    journalEconomy();
+    int segment = journal.rotate();
+    header.journalSegment = segment;
+
+    compactionSegment = segment;
+    compactionResult.store(COMPACTION_RUNNING, std::memory_order_relaxed);
+    compactionWriter = std::thread([this, header, first = autosaveSegment, path = getAutosavePath(),
+                                    journalPath = getJournalPath()] {
+        journal.waitForSegment(header.journalSegment);
+        bool written = World::foldJournal(path, journalPath, first, header.journalSegment, header, path);
+        compactionResult.store(written ? 1 : 0, std::memory_order_release);
+    });
+}
+
+void Game::pollCompaction() {
+    if (!compactionWriter.joinable()) return;
+
+    int result = compactionResult.load(std::memory_order_acquire);
+    if (result == COMPACTION_RUNNING) return;
+    compactionWriter.join();
+
+    if (result == 1) {
+        autosaveSegment = compactionSegment;
+        Journal::removeSegmentsBefore(getJournalPath(), compactionSegment);
+    } else if (autosaveSegment < 0) {
+        // Without a base the journal has nothing to replay onto
+        LOG_ERROR("Failed to write the autosave; autosave is off");
+        world.setJournal(nullptr);
+        journal.close();
+    }
+    // A failed compaction leaves the old snapshot and every segment valid
+}
+
+bool Game::recoverAutosave() {
+    int first = 0;
+    if (!loadGame(getAutosavePath(), &first)) return false;
+
+    std::vector<JournalRecord> records;
+    std::string journalPath = getJournalPath();
+    int segment = first;
+    while (Journal::readSegment(Journal::segmentPath(journalPath, segment), records)) {
+        segment++;
+    }
+
+    for (const auto& record : records) {
+        applyJournalRecord(record);
+    }
+    LOG_INFO("Replayed {} journal records", records.size());
+
+    return startAutosave(getAutosavePath(), first, segment);
+}
+
+void Game::applyJournalRecord(const JournalRecord& record) {
+    if (record.type == JournalRecordType::CAMERA) {
+        mapCenterLat = record.values[0];
+        mapCenterLon = record.values[1];
+        zoomLevel = record.ids[0];
+    }
+    world.applyJournalRecord(record);
+}
+
+void Game::journalEconomy() {
+    const Economy& economy = world.getEconomy();
+    journal.append(JournalRecordType::ECONOMY, world.getSimClock(), {},
+                   {economy.getMoney(), economy.getMonthlyIncome(),
+                    economy.getMonthlyExpenses(), economy.getTimeAccumulator()});
+}
+
+void Game::updateAutosave(float deltaTime) {
+    pollCompaction();
+    if (!journal.isOpen()) return;
+
+    autosaveTimer += deltaTime;
+    if (autosaveTimer >= AUTOSAVE_INTERVAL) {
+        autosaveTimer = 0.0f;
+        journalEconomy();
+        journal.append(JournalRecordType::CAMERA, world.getSimClock(), {zoomLevel}, {mapCenterLat, mapCenterLon});
+    }
+
+    compactionTimer += deltaTime;
+    if (compactionTimer >= COMPACTION_INTERVAL) {
+        compactionTimer = 0.0f;
+        compactAutosave();
+    }
 }
 
 void Game::run() {
-    Uint32 lastTime = SDL_GetTicks();
     const int TARGET_FPS = 60;
     const int FRAME_DELAY = 1000 / TARGET_FPS;
 
+    if (headless) {
+        runHeadless();
+        return;
+    }
+    if (renderBenchFrames > 0) {
+        runRenderBenchmark();
+        return;
+    }
+
+    // The simulation advances in fixed ticks whatever the frame rate, so a
+    // recorded session replays tick for tick
+    Uint32 lastTime = SDL_GetTicks();
+    double accumulator = 0.0;
+
     while (running) {
         Uint32 frameStart = SDL_GetTicks();
-        Uint32 currentTime = frameStart;
-        float deltaTime = (currentTime - lastTime) / 1000.0f;
-        lastTime = currentTime;
+        auto workStart = std::chrono::steady_clock::now();
+        accumulator += (frameStart - lastTime) / 1000.0;
+        lastTime = frameStart;
+
+        // After a long stall, drop time instead of spiralling to catch up
+        accumulator = std::min(accumulator, MAX_FRAME_TIME);
 
         handleEvents();
-        update(deltaTime);
-        render();
+        while (running && accumulator >= TICK_SECONDS) {
+            step();
+            accumulator -= TICK_SECONDS;
+        }
+        draw();
+
+        // The governor sees the frame's work, not the wait for vsync
+        auto workEnd = std::chrono::steady_clock::now();
+        double workMs = std::chrono::duration<double, std::milli>(workEnd - workStart).count();
+        governor.endFrame(workMs);
+        publishFrame(workMs, governor);
+        SDL_RenderPresent(renderer);
 
         // Frame rate limiting
         Uint32 frameTime = SDL_GetTicks() - frameStart;
@@ -142,68 +533,273 @@ void Game::run() {
             SDL_Delay(FRAME_DELAY - frameTime);
         }
     }
+
+    if (recorder) {
+        recorder->finish(tick, computeWorldHash());
+    }
+}
+
+void Game::runHeadless() {
+    // Replay as fast as possible without drawing, timing every tick
+    std::vector<double> tickTimes;
+    auto start = std::chrono::steady_clock::now();
+    while (running) {
+        auto tickStart = std::chrono::steady_clock::now();
+        step();
+        tickTimes.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - tickStart).count());
+    }
+    double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (tickTimes.empty()) return;
+    std::sort(tickTimes.begin(), tickTimes.end());
+    // Reports go straight to stdout, after whatever was logged before them
+    Log::flush();
+    std::cout << "Headless replay: " << tickTimes.size() << " ticks in " << total << " ms ("
+              << tickTimes.size() * 1000.0 / total << " ticks/s), p50 "
+              << tickTimes[tickTimes.size() / 2] << " ms, p99 "
+              << tickTimes[tickTimes.size() * 99 / 100] << " ms, max "
+              << tickTimes.back() << " ms per tick" << std::endl;
+}
+
+void Game::runRenderBenchmark() {
+    const Country* country = gameState->findCountry(benchCountry);
+    if (!country) {
+        LOG_ERROR("Unknown country {}", benchCountry);
+        exitCode = 1;
+        return;
+    }
+    if (!resetWorld(*country)) {
+        exitCode = 1;
+        return;
+    }
+
+    // A fixed seed keeps runs comparable between builds
+    ScenarioOptions scenario;
+    scenario.stationCount = benchStations;
+    scenario.extraLineCount = benchStations / 2;
+    scenario.minLat = country->minLat;
+    scenario.maxLat = country->maxLat;
+    scenario.minLon = country->minLon;
+    scenario.maxLon = country->maxLon;
+    // Per-command feedback would bury the report
+    world.setReporting(false);
+    buildScenario(world, scenario);
+    world.setReporting(true);
+    gameState->setState(GameStateType::PLAYING);
+
+    RenderStats& stats = RenderStats::global();
+    stats.reset();
+    std::vector<double> frameTimes;
+    frameTimes.reserve(renderBenchFrames);
+    // Allocations are counted from the second frame, once the first has
+    // built the glyph atlases, the panel textures and the scratch buffers
+    AllocationCounts allocStart[(int)AllocSubsystem::COUNT];
+    for (int frame = 0; frame < renderBenchFrames; frame++) {
+        // Lissajous pan around the country's center while zooming in and out
+        double t = 2.0 * M_PI * frame / renderBenchFrames;
+        mapCenterLat = country->centerLat + 0.25 * (country->maxLat - country->minLat) * sin(t);
+        mapCenterLon = country->centerLon + 0.25 * (country->maxLon - country->minLon) * sin(2.0 * t);
+        zoomLevel = std::max(1, std::min(18, country->defaultZoom + (int)lround(2.0 * sin(3.0 * t))));
+
+        // Trains move between frames, outside the timed part
+        {
+            AllocationStats::Scope scope(AllocSubsystem::SIMULATION);
+            world.update((float)TICK_SECONDS);
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+        render();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - frameStart).count());
+        governor.endFrame(frameTimes.back());
+        publishFrame(frameTimes.back(), governor);
+
+        if (frame == 0) {
+            for (int i = 0; i < (int)AllocSubsystem::COUNT; i++) {
+                allocStart[i] = AllocationStats::get((AllocSubsystem)i);
+            }
+        }
+    }
+
+    if (frameTimes.empty()) return;
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&frameTimes](int p) {
+        return frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * p / 100)];
+    };
+    Log::flush();
+    std::cout << "Render benchmark (" << country->code << ", " << world.getStations().size() << " stations, "
+              << world.getTrains().size() << " trains): " << frameTimes.size() << " frames, p50 "
+              << percentile(50) << " ms, p95 " << percentile(95) << " ms, p99 " << percentile(99)
+              << " ms, max " << frameTimes.back() << " ms" << std::endl;
+    std::cout << "Tiles decoded " << stats.tilesDecoded << ", draw calls " << stats.drawCalls
+              << " (" << stats.drawCalls / frameTimes.size() << " per frame), bytes uploaded "
+              << stats.bytesUploaded << std::endl;
+    if (governor.getOptions().enabled) {
+        std::cout << "Frame governor (" << governor.getOptions().budgetMs << " ms budget): ended with "
+                  << governor.describe() << "; scene scaled down " << governor.getScaledFrames() << " frames";
+        for (int i = 0; i < (int)SheddableWork::COUNT; i++) {
+            std::cout << ", " << FrameGovernor::name((SheddableWork)i) << " shed "
+                      << governor.getShedFrames((SheddableWork)i) << " frames";
+        }
+        std::cout << std::endl;
+    }
+    if (AllocationStats::enabled() && frameTimes.size() > 1) {
+        // Map allocations come from decoding tiles the camera hasn't seen yet
+        double frames = (double)(frameTimes.size() - 1);
+        std::cout << "Allocations per frame after the first:";
+        for (int i = 0; i < (int)AllocSubsystem::COUNT; i++) {
+            AllocationCounts now = AllocationStats::get((AllocSubsystem)i);
+            std::cout << " " << AllocationStats::name((AllocSubsystem)i) << " "
+                      << (now.allocations - allocStart[i].allocations) / frames << " ("
+                      << (now.bytes - allocStart[i].bytes) / frames << " bytes)";
+        }
+        std::cout << std::endl;
+    }
+    if (stats.tilesDecoded == 0) {
+        std::cout << "No map tiles on disk for " << country->code
+                  << "; start a game there once to download them" << std::endl;
+    }
+}
+
+void Game::step() {
+    if (replay) {
+        SDL_Event event;
+        while (replay->poll(tick, event)) {
+            dispatchEvent(event);
+        }
+    }
+
+    update((float)TICK_SECONDS);
+    tick++;
+
+    if (replay && replay->isFinished(tick)) {
+        finishReplay();
+    }
+}
+
+void Game::finishReplay() {
+    running = false;
+
+    uint64_t hash = computeWorldHash();
+    Log::flush();
+    std::cout << "Replay finished at tick " << tick << ", world hash " << std::hex << hash << std::dec;
+    if (replay->getExpectedHash() == 0) {
+        std::cout << " (no recorded hash to compare)" << std::endl;
+    } else if (hash == replay->getExpectedHash()) {
+        std::cout << " (matches recording)" << std::endl;
+    } else {
+        std::cout << " (MISMATCH, recorded " << std::hex << replay->getExpectedHash() << std::dec << ")" << std::endl;
+        exitCode = 2;
+    }
+}
+
+uint64_t Game::computeWorldHash() const {
+    // The world's own hash, extended with the camera player input moves
+    uint64_t hash = world.computeHash();
+    auto mixValue = [&hash](auto value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(value); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    mixValue(mapCenterLat);
+    mixValue(mapCenterLon);
+    mixValue(zoomLevel);
+    return hash;
 }
 
 void Game::handleEvents() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
-        switch (event.type) {
-            case SDL_QUIT:
-                running = false;
-                break;
+        if (event.type == SDL_QUIT) {
+            running = false;
+            continue;
+        }
 
-            case SDL_MOUSEBUTTONDOWN:
-                if (event.button.button == SDL_BUTTON_LEFT) {
-                    handleMouseClick(event.button.x, event.button.y, true);
-                } else if (event.button.button == SDL_BUTTON_RIGHT) {
-                    handleMouseClick(event.button.x, event.button.y, false);
-                }
-                break;
+        // A replay is driven by its log; live input would make it diverge
+        if (replay) continue;
 
-            case SDL_MOUSEMOTION:
-                if (gameState->getCurrentState() == GameStateType::PLAYING) {
-                    if (event.motion.state & SDL_BUTTON_RMASK) {
-                        handleMouseDrag(event.motion.x, event.motion.y);
-                    }
+        if (recorder) {
+            recorder->record(tick, event);
+        }
+        dispatchEvent(event);
+    }
+}
+
+void Game::dispatchEvent(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_MOUSEBUTTONDOWN:
+            if (event.button.button == SDL_BUTTON_LEFT) {
+                handleMouseClick(event.button.x, event.button.y, true);
+            } else if (event.button.button == SDL_BUTTON_RIGHT) {
+                handleMouseClick(event.button.x, event.button.y, false);
+            }
+            break;
+
+        case SDL_MOUSEMOTION:
+            if (gameState->getCurrentState() == GameStateType::PLAYING) {
+                if (event.motion.state & SDL_BUTTON_RMASK) {
+                    handleMouseDrag(event.motion.x, event.motion.y);
                 }
-                // Update button hover states
-                int mouseX, mouseY;
-                SDL_GetMouseState(&mouseX, &mouseY);
-                if (gameState->getCurrentState() == GameStateType::MAIN_MENU) {
-                    for (auto& button : mainMenuButtons) {
-                        button.isHovered = button.contains(mouseX, mouseY);
-                    }
-                } else if (gameState->getCurrentState() == GameStateType::COUNTRY_SELECT) {
-                    for (auto& button : countrySelectButtons) {
-                        button.isHovered = button.contains(mouseX, mouseY);
-                    }
+            }
+            // Update button hover states
+            if (gameState->getCurrentState() == GameStateType::MAIN_MENU) {
+                for (auto& button : mainMenuButtons) {
+                    button.isHovered = button.contains(event.motion.x, event.motion.y);
                 }
-                break;
+            } else if (gameState->getCurrentState() == GameStateType::COUNTRY_SELECT) {
+                for (auto& button : countrySelectButtons) {
+                    button.isHovered = button.contains(event.motion.x, event.motion.y);
+                }
+            }
+            break;
+
+        case SDL_MOUSEBUTTONUP:
+            if (gameState->getCurrentState() == GameStateType::PLAYING) {
+                handleMouseRelease(event.button.x, event.button.y);
+            }
+            break;
 
-            case SDL_MOUSEBUTTONUP:
-                if (gameState->getCurrentState() == GameStateType::PLAYING) {
-                    handleMouseRelease(event.button.x, event.button.y);
+        case SDL_MOUSEWHEEL:
+            if (gameState->getCurrentState() == GameStateType::PLAYING) {
+                if (event.wheel.y > 0) {
+                    zoomLevel = std::min(zoomLevel + 1, 18);
+                } else if (event.wheel.y < 0) {
+                    zoomLevel = std::max(zoomLevel - 1, 1);
                 }
-                break;
+            } else if (gameState->getCurrentState() == GameStateType::COUNTRY_SELECT) {
+                countryScrollOffset -= event.wheel.y * 30;
+                countryScrollOffset = std::max(0, std::min(countryScrollOffset,
+                    (int)countrySelectButtons.size() * 60 - 500));
+            }
+            break;
 
-            case SDL_MOUSEWHEEL:
-                if (gameState->getCurrentState() == GameStateType::PLAYING) {
-                    if (event.wheel.y > 0) {
-                        zoomLevel = std::min(zoomLevel + 1, 18);
-                    } else if (event.wheel.y < 0) {
-                        zoomLevel = std::max(zoomLevel - 1, 1);
-                    }
-                } else if (gameState->getCurrentState() == GameStateType::COUNTRY_SELECT) {
-                    countryScrollOffset -= event.wheel.y * 30;
-                    countryScrollOffset = std::max(0, std::min(countryScrollOffset,
-                        (int)countrySelectButtons.size() * 60 - 500));
+        case SDL_KEYDOWN:
+            handleKeyPress(event.key.keysym.sym);
+            break;
+
+        case SDL_WINDOWEVENT:
+            if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                setViewSize(event.window.data1, event.window.data2);
+                // A replayed resize resizes the window too, when there is one
+                if (replay && window) {
+                    SDL_SetWindowSize(window, viewWidth, viewHeight);
                 }
-                break;
+            }
+            break;
+    }
+}
 
-            case SDL_KEYDOWN:
-                handleKeyPress(event.key.keysym.sym);
-                break;
-        }
+void Game::setViewSize(int width, int height) {
+    viewWidth = std::max(1, width);
+    viewHeight = std::max(1, height);
+    if (mapRenderer) {
+        mapRenderer->setViewSize(viewWidth, viewHeight);
+    }
+    if (cityRenderer) {
+        cityRenderer->setViewSize(viewWidth, viewHeight);
     }
 }
 
@@ -212,16 +808,32 @@ void Game::handleKeyPress(SDL_Keycode key) {
         switch (key) {
             case SDLK_s:
                 currentMode = Mode::PLACE_STATION;
-                std::cout << "Mode: Place Station" << std::endl;
+                LOG_DEBUG("Mode: Place Station");
                 break;
             case SDLK_l:
                 currentMode = Mode::DRAW_LINE;
-                std::cout << "Mode: Draw Line" << std::endl;
+                LOG_DEBUG("Mode: Draw Line");
+                break;
+            case SDLK_t:
+                currentMode = Mode::PLACE_TRAIN;
+                LOG_DEBUG("Mode: Place Train");
+                break;
+            case SDLK_x:
+                currentMode = Mode::REMOVE_TRAIN;
+                LOG_DEBUG("Mode: Remove Train");
+                break;
+
+            case SDLK_d:
+                currentMode = Mode::DEMOLISH;
+                LOG_DEBUG("Mode: Demolish");
                 break;
             case SDLK_v:
                 currentMode = Mode::VIEW;
-                selectedStation = nullptr;
-                std::cout << "Mode: View" << std::endl;
+                selectedStation = StationHandle();
+                LOG_DEBUG("Mode: View");
+                break;
+            case SDLK_F5:
+                saveGame(getSavePath());
                 break;
             case SDLK_ESCAPE:
                 gameState->setState(GameStateType::MAIN_MENU);
@@ -283,70 +895,65 @@ void Game::handleGameplayClick(int x, int y, bool leftClick) {
     auto coord = mapRenderer->screenToLatLon(x, y, mapCenterLat, mapCenterLon, zoomLevel);
 
     switch (currentMode) {
-        case Mode::PLACE_STATION: {
-            if (economy->canBuildStation()) {
-                int id = stations.size();
-                stations.emplace_back(id, coord.lat, coord.lon, "Station " + std::to_string(id + 1));
-                economy->spendMoney(economy->getStationBuildCost());
-                std::cout << "Placed station at (" << coord.lat << ", " << coord.lon << ")" << std::endl;
-                std::cout << "Money: $" << economy->getMoney() << std::endl;
-            } else {
-                std::cout << "Not enough money to build station!" << std::endl;
-            }
+        case Mode::PLACE_STATION:
+            world.placeStation(coord.lat, coord.lon);
             break;
-        }
 
         case Mode::DRAW_LINE: {
-            Station* clickedStation = nullptr;
-            for (auto& station : stations) {
-                auto screenPos = mapRenderer->latLonToScreen(
-                    station.getLat(), station.getLon(),
-                    mapCenterLat, mapCenterLon, zoomLevel
-                );
-                int dx = screenPos.x - x;
-                int dy = screenPos.y - y;
-                if (dx * dx + dy * dy < 100) {
-                    clickedStation = &station;
-                    break;
+            StationHandle clickedStation = findStationAt(x, y);
+            if (!clickedStation.isNull()) {
+                const Station* selected = world.getStation(selectedStation);
+                if (!selected) {
+                    selectedStation = clickedStation;
+                    LOG_DEBUG("Selected station: {}", world.getStation(clickedStation)->getName());
+                } else if (selectedStation != clickedStation) {
+                    world.buildLine(selected->getId(), clickedStation.index);
+                    selectedStation = StationHandle();
+                } else {
+                    selectedStation = StationHandle();
                 }
             }
+            break;
+        }
+
+        case Mode::PLACE_TRAIN: {
+            int lineId = findLineAt(x, y);
+            if (lineId >= 0) {
+                world.addTrain(lineId);
+            }
+            break;
+        }
 
-            if (clickedStation) {
-                if (!selectedStation) {
-                    selectedStation = clickedStation;
-                    std::cout << "Selected station: " << selectedStation->getName() << std::endl;
-                } else if (selectedStation != clickedStation) {
-                    int lineId = trainLines.size();
-                    trainLines.emplace_back(lineId, selectedStation->getId(), clickedStation->getId());
-
-                    double lat1 = selectedStation->getLat() * M_PI / 180.0;
-                    double lat2 = clickedStation->getLat() * M_PI / 180.0;
-                    double lon1 = selectedStation->getLon() * M_PI / 180.0;
-                    double lon2 = clickedStation->getLon() * M_PI / 180.0;
-
-                    double dLat = lat2 - lat1;
-                    double dLon = lon2 - lon1;
-                    double a = sin(dLat/2) * sin(dLat/2) +
-                              cos(lat1) * cos(lat2) *
-                              sin(dLon/2) * sin(dLon/2);
-                    double c = 2 * atan2(sqrt(a), sqrt(1-a));
-                    double distance = 6371.0 * c;
-
-                    trainLines.back().setLength(distance);
-
-                    double cost = distance * economy->getLineBuildCostPerKm();
-                    if (economy->spendMoney(cost)) {
-                        selectedStation->addConnectedLine(lineId);
-                        clickedStation->addConnectedLine(lineId);
-                        std::cout << "Built line: " << distance << " km, $" << cost << std::endl;
-                    } else {
-                        trainLines.pop_back();
-                        std::cout << "Not enough money!" << std::endl;
+        case Mode::REMOVE_TRAIN: {
+            // The train on the clicked line closest to the click goes
+            double along = 0.0;
+            int lineId = findLineAt(x, y, &along);
+            if (lineId >= 0) {
+                const Timetable& timetable = world.getTimetable();
+                TrainHandle closest;
+                double closestGap = 2.0;
+                for (int trainId : world.getLines().atIndex(lineId).getTrains()) {
+                    double gap = std::abs(timetable.getTrainState(trainId, world.getSimClock()).position - along);
+                    if (gap < closestGap) {
+                        closestGap = gap;
+                        closest = world.getTrainHandle(trainId);
                     }
-                    selectedStation = nullptr;
-                } else {
-                    selectedStation = nullptr;
                 }
+                world.removeTrain(closest);
+            }
+            break;
+        }
+
+        case Mode::DEMOLISH: {
+            // A station takes its lines and their trains with it
+            StationHandle clickedStation = findStationAt(x, y);
+            if (!clickedStation.isNull()) {
+                world.removeStation(clickedStation);
+                break;
+            }
+            int lineId = findLineAt(x, y);
+            if (lineId >= 0) {
+                world.removeLine(world.getLineHandle(lineId));
             }
             break;
         }
@@ -356,12 +963,56 @@ void Game::handleGameplayClick(int x, int y, bool leftClick) {
     }
 }
 
+StationHandle Game::findStationAt(int x, int y) const {
+    for (const auto& station : world.getStations()) {
+        auto screenPos = mapRenderer->latLonToScreen(
+            station.getLat(), station.getLon(),
+            mapCenterLat, mapCenterLon, zoomLevel
+        );
+        int dx = screenPos.x - x;
+        int dy = screenPos.y - y;
+        if (dx * dx + dy * dy < 100) {
+            return world.getStationHandle(station.getId());
+        }
+    }
+    return StationHandle();
+}
+
+int Game::findLineAt(int x, int y, double* along) const {
+    // Pick the line whose segment passes within a few pixels of the click
+    int bestLine = -1;
+    double bestDist = 36.0;
+    const auto& stations = world.getStations();
+    for (const auto& line : world.getLines()) {
+        const auto& s1 = stations.atIndex(line.getStation1());
+        const auto& s2 = stations.atIndex(line.getStation2());
+        auto p1 = mapRenderer->latLonToScreen(s1.getLat(), s1.getLon(), mapCenterLat, mapCenterLon, zoomLevel);
+        auto p2 = mapRenderer->latLonToScreen(s2.getLat(), s2.getLon(), mapCenterLat, mapCenterLon, zoomLevel);
+
+        double vx = p2.x - p1.x;
+        double vy = p2.y - p1.y;
+        double lenSq = vx * vx + vy * vy;
+        double t = lenSq > 0 ? ((x - p1.x) * vx + (y - p1.y) * vy) / lenSq : 0.0;
+        t = std::max(0.0, std::min(1.0, t));
+
+        double dx = p1.x + t * vx - x;
+        double dy = p1.y + t * vy - y;
+        double distSq = dx * dx + dy * dy;
+        if (distSq < bestDist) {
+            bestDist = distSq;
+            bestLine = line.getId();
+            if (along) *along = t;
+        }
+    }
+    return bestLine;
+}
+
 void Game::handleMouseDrag(int x, int y) {
     if (isDragging && mapRenderer) {
         int dx = x - dragStartX;
         int dy = y - dragStartY;
 
-        double scale = 156543.03392 * cos(mapCenterLat * M_PI / 180.0) / pow(2, zoomLevel);
+        double scale = groundResolution(mapCenterLat, zoomLevel);
         double lonDelta = -dx * scale / 111320.0;
         double latDelta = dy * scale / 110540.0;
 
@@ -389,28 +1040,30 @@ void Game::update(float deltaTime) {
         return;
     }
 
-    if (economy) {
-        economy->update(deltaTime);
+    {
+        AllocationStats::Scope scope(AllocSubsystem::SIMULATION);
+        world.update(deltaTime);
     }
+    updateAutosave(deltaTime);
+}
 
-    for (auto& train : trains) {
-        if (train.getLineId() < trainLines.size()) {
-            double lineLength = trainLines[train.getLineId()].getLength();
-            train.update(deltaTime, lineLength);
-        }
-    }
+void Game::render() {
+    draw();
+    SDL_RenderPresent(renderer);
+}
 
-    for (auto& station : stations) {
-        static float passengerTimer = 0;
-        passengerTimer += deltaTime;
-        if (passengerTimer >= 2.0f) {
-            station.addPassengers(5);
-            passengerTimer = 0;
-        }
+void Game::draw() {
+    frameCount++;
+
+    // Menus keep their fixed layout scaled to the window, which also maps
+    // mouse coordinates back to the layout; gameplay uses every pixel
+    bool menus = gameState->getCurrentState() != GameStateType::PLAYING;
+    if (menus != menuLayout) {
+        menuLayout = menus;
+        SDL_RenderSetLogicalSize(renderer, menus ? UIRenderer::LAYOUT_WIDTH : 0,
+                                 menus ? UIRenderer::LAYOUT_HEIGHT : 0);
     }
-}
 
-void Game::render() {
     switch (gameState->getCurrentState()) {
         case GameStateType::MAIN_MENU:
             renderMainMenu();
@@ -426,8 +1079,42 @@ void Game::render() {
             SDL_RenderClear(renderer);
             break;
     }
+}
 
-    SDL_RenderPresent(renderer);
+bool Game::beginScene() {
+    float scale = governor.getResolutionScale();
+    if (scale >= 1.0f || !SDL_RenderTargetSupported(renderer)) {
+        return false;
+    }
+
+    int width = std::max(1, (int)std::ceil(viewWidth * scale));
+    int height = std::max(1, (int)std::ceil(viewHeight * scale));
+    if (!sceneTarget || width != sceneWidth || height != sceneHeight) {
+        if (sceneTarget) {
+            SDL_DestroyTexture(sceneTarget);
+        }
+        sceneTarget = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                        SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!sceneTarget) {
+            LOG_ERROR("Failed to create scene target: {}", SDL_GetError());
+            return false;
+        }
+        SDL_SetTextureScaleMode(sceneTarget, SDL_ScaleModeLinear);
+        sceneWidth = width;
+        sceneHeight = height;
+    }
+
+    // Everything still draws in view coordinates; the scale maps them
+    // onto the smaller target
+    SDL_SetRenderTarget(renderer, sceneTarget);
+    SDL_RenderSetScale(renderer, (float)width / viewWidth, (float)height / viewHeight);
+    return true;
+}
+
+void Game::endScene() {
+    SDL_SetRenderTarget(renderer, nullptr);
+    SDL_RenderCopy(renderer, sceneTarget, nullptr, nullptr);
+    RenderStats::global().drawCalls++;
 }
 
 void Game::renderMainMenu() {
@@ -443,47 +1130,105 @@ void Game::renderCountrySelect() {
 }
 
 void Game::renderGameplay() {
+    RenderStats& stats = RenderStats::global();
+    bool scaled = beginScene();
     SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
     SDL_RenderClear(renderer);
+    stats.drawCalls++;
 
     if (mapRenderer) {
+        AllocationStats::Scope scope(AllocSubsystem::MAP);
+        mapRenderer->setPrefetch(!governor.isShed(SheddableWork::TILE_PREFETCH));
         mapRenderer->render(mapCenterLat, mapCenterLon, zoomLevel);
     }
 
-    // Render train lines
-    SDL_SetRenderDrawColor(renderer, 100, 100, 255, 255);
-    for (const auto& line : trainLines) {
-        if (line.getStation1() < stations.size() && line.getStation2() < stations.size()) {
-            const auto& s1 = stations[line.getStation1()];
-            const auto& s2 = stations[line.getStation2()];
+    AllocationStats::Scope networkScope(AllocSubsystem::NETWORK);
+
+    const NetworkGraph& networkGraph = world.getNetworkGraph();
+    const Timetable& timetable = world.getTimetable();
+    double simClock = world.getSimClock();
 
-            auto pos1 = mapRenderer->latLonToScreen(s1.getLat(), s1.getLon(), mapCenterLat, mapCenterLon, zoomLevel);
-            auto pos2 = mapRenderer->latLonToScreen(s2.getLat(), s2.getLon(), mapCenterLat, mapCenterLon, zoomLevel);
+    // Project every station once, in graph node order
+    int nodeCount = networkGraph.getNodeCount();
+    nodeScreenPos.resize(nodeCount);
+    mapRenderer->latLonToScreen(networkGraph.getLats(), networkGraph.getLons(), nodeCount,
+                                mapCenterLat, mapCenterLon, zoomLevel, nodeScreenPos.data());
 
+    // Render train lines - each undirected line appears as two CSR edges
+    SDL_SetRenderDrawColor(renderer, 100, 100, 255, 255);
+    for (int node = 0; node < nodeCount; node++) {
+        const auto& pos1 = nodeScreenPos[node];
+        for (int e = networkGraph.edgeBegin(node); e < networkGraph.edgeEnd(node); e++) {
+            int target = networkGraph.getTarget(e);
+            if (target < node) continue;
+            const auto& pos2 = nodeScreenPos[target];
             SDL_RenderDrawLine(renderer, pos1.x, pos1.y, pos2.x, pos2.y);
+            stats.drawCalls++;
+        }
+    }
+
+    // Render trains - only lines that touch the screen query the timetable
+    bool trainDetail = !governor.isShed(SheddableWork::TRAIN_DETAIL);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    for (const auto& line : world.getLines()) {
+        if (line.getTrains().empty()) continue;
+
+        const auto& pos1 = nodeScreenPos[networkGraph.toNode(line.getStation1())];
+        const auto& pos2 = nodeScreenPos[networkGraph.toNode(line.getStation2())];
+
+        if (std::max(pos1.x, pos2.x) < 0 || std::min(pos1.x, pos2.x) > viewWidth ||
+            std::max(pos1.y, pos2.y) < 0 || std::min(pos1.y, pos2.y) > viewHeight) {
+            continue;
+        }
+        // Markers on a line this short vanish under its station squares anyway
+        if (!trainDetail && std::abs(pos2.x - pos1.x) + std::abs(pos2.y - pos1.y) < MIN_DETAIL_LINE_PIXELS) {
+            continue;
+        }
+
+        for (int trainId : line.getTrains()) {
+            TrainState state = timetable.getTrainState(trainId, simClock);
+            int tx = pos1.x + (int)((pos2.x - pos1.x) * state.position);
+            int ty = pos1.y + (int)((pos2.y - pos1.y) * state.position);
+            SDL_Rect rect = { tx - 3, ty - 3, 6, 6 };
+            SDL_RenderFillRect(renderer, &rect);
+            stats.drawCalls++;
         }
     }
 
     // Render stations
-    for (const auto& station : stations) {
-        auto pos = mapRenderer->latLonToScreen(station.getLat(), station.getLon(), mapCenterLat, mapCenterLon, zoomLevel);
+    const Station* selected = world.getStation(selectedStation);
+    for (const auto& station : world.getStations()) {
+        const auto& pos = nodeScreenPos[networkGraph.toNode(station.getId())];
 
         SDL_Rect rect = { pos.x - 5, pos.y - 5, 10, 10 };
-        if (&station == selectedStation) {
+        if (&station == selected) {
             SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
         } else {
             SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
         }
         SDL_RenderFillRect(renderer, &rect);
+        stats.drawCalls++;
     }
 
-    // Render UI
-    if (economy) {
-        uiRenderer->renderInfoPanel(economy->getMoney(), stations.size(), trainLines.size());
+    if (scaled) {
+        endScene();
     }
+
+    // Render UI - always at full resolution, so text stays sharp
+    AllocationStats::Scope uiScope(AllocSubsystem::UI);
+    bool refresh = !governor.isShed(SheddableWork::OVERLAY_UPDATES) || frameCount % OVERLAY_REFRESH_FRAMES == 0;
+    uiRenderer->renderInfoPanel(world.getEconomy().getMoney(), world.getStations().size(),
+                                world.getLines().size(), refresh);
 }
 
 void Game::cleanup() {
+    stopAutosave();
+
+    if (sceneTarget) {
+        SDL_DestroyTexture(sceneTarget);
+        sceneTarget = nullptr;
+    }
+
     if (renderer) {
         SDL_DestroyRenderer(renderer);
         renderer = nullptr;
@@ -494,6 +1239,11 @@ void Game::cleanup() {
         window = nullptr;
     }
 
+    if (offscreen) {
+        SDL_FreeSurface(offscreen);
+        offscreen = nullptr;
+    }
+
     TTF_Quit();
     SDL_Quit();
 }
@@ -3,6 +3,7 @@
 GameStateManager::GameStateManager()
     : currentState(GameStateType::MAIN_MENU)
     , selectedCountry(nullptr)
+    , currentSaveName("quicksave")
 {
     initializeCountries();
 }
@@ -21,6 +22,15 @@ void GameStateManager::selectCountry(const Country& country) {
     }
 }
 
+const Country* GameStateManager::findCountry(const std::string& code) const {
+    for (const auto& c : availableCountries) {
+        if (c.code == code) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
 void GameStateManager::initializeCountries() {
     // Initialize with a curated list of countries
     // Format: {name, code, centerLat, centerLon, defaultZoom, minLat, maxLat, minLon, maxLon}
@@ -0,0 +1,179 @@
+#include "Geodesy.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double RAD_TO_DEG = 180.0 / M_PI;
+static constexpr double KM_PER_DEG = EARTH_RADIUS_KM * DEG_TO_RAD;
+
+double haversineKm(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * DEG_TO_RAD;
+    double phi2 = lat2 * DEG_TO_RAD;
+    double dLat = phi2 - phi1;
+    double dLon = (lon2 - lon1) * DEG_TO_RAD;
+
+    double a = sin(dLat/2) * sin(dLat/2) +
+              cos(phi1) * cos(phi2) *
+              sin(dLon/2) * sin(dLon/2);
+    // Rounding can push a past 1 near the antipode
+    a = std::min(a, 1.0);
+    double c = 2 * atan2(sqrt(a), sqrt(1-a));
+    return EARTH_RADIUS_KM * c;
+}
+
+#ifdef __AVX2__
+// sin(x) for |x| <= pi/2: Taylor series to x^17, error below 1e-11
+static inline __m256d sinHalfPi(__m256d x) {
+    static const double coeffs[] = {
+        1.0 / 355687428096000.0, -1.0 / 1307674368000.0, 1.0 / 6227020800.0,
+        -1.0 / 39916800.0, 1.0 / 362880.0, -1.0 / 5040.0, 1.0 / 120.0, -1.0 / 6.0, 1.0
+    };
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(coeffs[0]);
+    for (int i = 1; i < 9; i++) {
+        p = _mm256_add_pd(_mm256_mul_pd(p, x2), _mm256_set1_pd(coeffs[i]));
+    }
+    return _mm256_mul_pd(p, x);
+}
+
+// asin(x) for x in [0, 0.5]: the Maclaurin series shrinks by at least 4x
+// per term there, so 24 terms reach double precision
+static inline __m256d asinSeries(__m256d x) {
+    static const int TERMS = 24;
+    static const double* coeffs = [] {
+        static double c[TERMS];
+        double binomial = 1.0; // (2n)! / (4^n (n!)^2)
+        for (int n = 0; n < TERMS; n++) {
+            c[TERMS - 1 - n] = binomial / (2 * n + 1);
+            binomial *= (2.0 * n + 1.0) / (2.0 * n + 2.0);
+        }
+        return c;
+    }();
+
+    __m256d z = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(coeffs[0]);
+    for (int i = 1; i < TERMS; i++) {
+        p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(coeffs[i]));
+    }
+    return _mm256_mul_pd(p, x);
+}
+
+// asin(x) for x in [0, 1], folding x > 0.5 onto the series range with
+// asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2))
+static inline __m256d asinUnit(__m256d x) {
+    __m256d half = _mm256_set1_pd(0.5);
+    __m256d big = _mm256_cmp_pd(x, half, _CMP_GT_OQ);
+    __m256d folded = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), x), half));
+    __m256d r = asinSeries(_mm256_blendv_pd(x, folded, big));
+    __m256d unfolded = _mm256_sub_pd(_mm256_set1_pd(M_PI / 2), _mm256_add_pd(r, r));
+    return _mm256_blendv_pd(r, unfolded, big);
+}
+
+static inline __m256d absPd(__m256d x) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+#endif
+
+void haversineKmBatch(double lat, double lon, const double* lats, const double* lons,
+                      size_t count, double* out) {
+    size_t i = 0;
+
+#ifdef __AVX2__
+    double phi1 = lat * DEG_TO_RAD;
+    __m256d vPhi1 = _mm256_set1_pd(phi1);
+    __m256d vCosPhi1 = _mm256_set1_pd(cos(phi1));
+    __m256d vLon1 = _mm256_set1_pd(lon);
+    __m256d vDegToRad = _mm256_set1_pd(DEG_TO_RAD);
+    __m256d vHalf = _mm256_set1_pd(0.5);
+    __m256d vHalfPi = _mm256_set1_pd(M_PI / 2);
+    __m256d vPi = _mm256_set1_pd(M_PI);
+    __m256d vOne = _mm256_set1_pd(1.0);
+    __m256d vTwoR = _mm256_set1_pd(2.0 * EARTH_RADIUS_KM);
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d phi2 = _mm256_mul_pd(_mm256_loadu_pd(lats + i), vDegToRad);
+        __m256d dLon = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(lons + i), vLon1), vDegToRad);
+
+        // |dLat/2| <= pi/2 already; |dLon/2| can reach pi, and
+        // sin^2(h) = sin^2(pi - h) folds it back into range
+        __m256d sLat = sinHalfPi(_mm256_mul_pd(_mm256_sub_pd(phi2, vPhi1), vHalf));
+        __m256d hLon = absPd(_mm256_mul_pd(dLon, vHalf));
+        hLon = _mm256_min_pd(hLon, _mm256_sub_pd(vPi, hLon));
+        __m256d sLon = sinHalfPi(hLon);
+        __m256d cosPhi2 = sinHalfPi(_mm256_sub_pd(vHalfPi, absPd(phi2)));
+
+        __m256d a = _mm256_add_pd(_mm256_mul_pd(sLat, sLat),
+                                  _mm256_mul_pd(_mm256_mul_pd(vCosPhi1, cosPhi2),
+                                                _mm256_mul_pd(sLon, sLon)));
+        a = _mm256_min_pd(_mm256_max_pd(a, _mm256_setzero_pd()), vOne);
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(vTwoR, asinUnit(_mm256_sqrt_pd(a))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = haversineKm(lat, lon, lats[i], lons[i]);
+    }
+}
+
+double equirectangularKm(double lat1, double lon1, double lat2, double lon2) {
+    double x = (lon2 - lon1) * cos((lat1 + lat2) * 0.5 * DEG_TO_RAD);
+    double y = lat2 - lat1;
+    return KM_PER_DEG * sqrt(x * x + y * y);
+}
+
+double fastDistanceKm(double lat1, double lon1, double lat2, double lon2) {
+    double d = equirectangularKm(lat1, lon1, lat2, lon2);
+    if (d < SHORT_RANGE_KM) return d;
+    return haversineKm(lat1, lon1, lat2, lon2);
+}
+
+LocalFrame::LocalFrame(double originLat, double originLon)
+    : originLat(originLat)
+    , originLon(originLon)
+    , kmPerDegLon(KM_PER_DEG * cos(originLat * DEG_TO_RAD))
+{}
+
+void LocalFrame::toLocal(double lat, double lon, double& eastKm, double& northKm) const {
+    eastKm = (lon - originLon) * kmPerDegLon;
+    northKm = (lat - originLat) * KM_PER_DEG;
+}
+
+void LocalFrame::toLatLon(double eastKm, double northKm, double& lat, double& lon) const {
+    lat = originLat + northKm / KM_PER_DEG;
+    lon = originLon + eastKm / kmPerDegLon;
+}
+
+double lonToMercatorX(double lon) {
+    return (lon + 180.0) / 360.0;
+}
+
+double latToMercatorY(double lat) {
+    double latRad = lat * DEG_TO_RAD;
+    return (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0;
+}
+
+double mercatorXToLon(double x) {
+    return x * 360.0 - 180.0;
+}
+
+double mercatorYToLat(double y) {
+    return atan(sinh(M_PI * (1 - 2 * y))) * RAD_TO_DEG;
+}
+
+void latLonToMercatorBatch(const double* lats, const double* lons, size_t count,
+                           double* xs, double* ys) {
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = lonToMercatorX(lons[i]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        ys[i] = latToMercatorY(lats[i]);
+    }
+}
+
+double groundResolution(double lat, int zoom) {
+    return 156543.03392 * cos(lat * DEG_TO_RAD) / pow(2.0, zoom);
+}
@@ -0,0 +1,140 @@
+#include "InputLog.h"
+#include "Log.h"
+#include <cstring>
+
+static const char INPUT_LOG_MAGIC[8] = {'T', 'B', 'I', 'N', 'P', 'U', 'T', '\0'};
+static const uint32_t INPUT_LOG_VERSION = 1;
+
+struct InputLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t seed;
+    double tickSeconds;
+};
+
+bool InputRecorder::open(const std::string& path, uint32_t seed, double tickSeconds) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR("Failed to create input log: {}", path);
+        return false;
+    }
+
+    InputLogHeader header;
+    memcpy(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic));
+    header.version = INPUT_LOG_VERSION;
+    header.seed = seed;
+    header.tickSeconds = tickSeconds;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return true;
+}
+
+void InputRecorder::record(uint64_t tick, const SDL_Event& event) {
+    if (!file.is_open()) return;
+
+    InputEvent entry{tick, event.type, 0, 0, 0, 0, 0};
+    switch (event.type) {
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            entry.x = event.button.x;
+            entry.y = event.button.y;
+            entry.button = event.button.button;
+            break;
+        case SDL_MOUSEMOTION:
+            entry.x = event.motion.x;
+            entry.y = event.motion.y;
+            entry.button = event.motion.state;
+            break;
+        case SDL_MOUSEWHEEL:
+            entry.wheelY = event.wheel.y;
+            break;
+        case SDL_KEYDOWN:
+            entry.button = event.key.keysym.sym;
+            break;
+        case SDL_WINDOWEVENT:
+            // The view size decides where clicks land on the map
+            if (event.window.event != SDL_WINDOWEVENT_SIZE_CHANGED) return;
+            entry.x = event.window.data1;
+            entry.y = event.window.data2;
+            entry.button = event.window.event;
+            break;
+        default:
+            return; // nothing else reaches game logic
+    }
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+}
+
+void InputRecorder::finish(uint64_t tick, uint64_t worldHash) {
+    if (!file.is_open()) return;
+
+    InputEvent end{tick, INPUT_LOG_END, (int32_t)(uint32_t)worldHash, (int32_t)(uint32_t)(worldHash >> 32), 0, 0, 0};
+    file.write(reinterpret_cast<const char*>(&end), sizeof(end));
+    file.close();
+}
+
+bool InputReplay::open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    InputLogHeader header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != INPUT_LOG_VERSION) {
+        LOG_ERROR("Not a valid input log: {}", path);
+        return false;
+    }
+    seed = header.seed;
+    tickSeconds = header.tickSeconds;
+
+    events.clear();
+    next = 0;
+    InputEvent entry;
+    bool ended = false;
+    while (file.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        if (entry.type == INPUT_LOG_END) {
+            endTick = entry.tick;
+            expectedHash = (uint64_t)(uint32_t)entry.x | ((uint64_t)(uint32_t)entry.y << 32);
+            ended = true;
+            break;
+        }
+        events.push_back(entry);
+    }
+
+    if (!ended) {
+        // Recording was cut short - replay what is there, nothing to verify
+        LOG_ERROR("Input log has no end marker: {}", path);
+        endTick = events.empty() ? 0 : events.back().tick + 1;
+        expectedHash = 0;
+    }
+    return true;
+}
+
+bool InputReplay::poll(uint64_t tick, SDL_Event& event) {
+    if (next >= events.size() || events[next].tick != tick) return false;
+
+    const InputEvent& entry = events[next++];
+    memset(&event, 0, sizeof(event));
+    event.type = entry.type;
+    switch (entry.type) {
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            event.button.x = entry.x;
+            event.button.y = entry.y;
+            event.button.button = entry.button;
+            break;
+        case SDL_MOUSEMOTION:
+            event.motion.x = entry.x;
+            event.motion.y = entry.y;
+            event.motion.state = entry.button;
+            break;
+        case SDL_MOUSEWHEEL:
+            event.wheel.y = entry.wheelY;
+            break;
+        case SDL_KEYDOWN:
+            event.key.keysym.sym = entry.button;
+            break;
+        case SDL_WINDOWEVENT:
+            event.window.event = (Uint8)entry.button;
+            event.window.data1 = entry.x;
+            event.window.data2 = entry.y;
+            break;
+    }
+    return true;
+}
@@ -0,0 +1,212 @@
+#include "Journal.h"
+#include "Log.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+Journal::Journal()
+    : segment(0)
+    , file(nullptr)
+    , completeBefore(0)
+    , stopping(false)
+{}
+
+Journal::~Journal() {
+    close();
+}
+
+std::string Journal::segmentPath(const std::string& basePath, int segment) {
+    return basePath + "." + std::to_string(segment);
+}
+
+bool Journal::openSegment(int number) {
+    std::string path = segmentPath(basePath, number);
+    file = fopen(path.c_str(), "ab");
+    if (!file) {
+        LOG_ERROR("Failed to open journal: {}", path);
+        return false;
+    }
+    return true;
+}
+
+bool Journal::open(const std::string& newBasePath, int firstSegment) {
+    close();
+
+    basePath = newBasePath;
+    segment = firstSegment;
+    completeBefore = firstSegment;
+    if (!openSegment(segment)) return false;
+
+    stopping = false;
+    writer = std::thread(&Journal::writerLoop, this);
+    return true;
+}
+
+void Journal::close() {
+    if (!writer.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void Journal::append(JournalRecordType type, double simClock,
+                     std::initializer_list<int32_t> ids, std::initializer_list<double> values) {
+    if (!writer.joinable()) return;
+
+    JournalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.simClock = simClock;
+    std::copy(ids.begin(), ids.begin() + std::min<size_t>(ids.size(), 4), record.ids);
+    std::copy(values.begin(), values.begin() + std::min<size_t>(values.size(), 4), record.values);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(record);
+    }
+    wake.notify_one();
+}
+
+int Journal::rotate() {
+    int next;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        next = ++segment;
+        JournalRecord record;
+        memset(&record, 0, sizeof(record));
+        record.type = JournalRecordType::ROTATE;
+        record.ids[0] = next;
+        pending.push_back(record);
+    }
+    wake.notify_one();
+    return next;
+}
+
+void Journal::waitForSegment(int number) {
+    std::unique_lock<std::mutex> lock(mutex);
+    segmentDone.wait(lock, [this, number] { return completeBefore >= number; });
+}
+
+void Journal::writerLoop() {
+    std::vector<JournalRecord> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) break; // stopping, and everything is written
+            batch.swap(pending);
+        }
+
+        for (JournalRecord& record : batch) {
+            if (record.type == JournalRecordType::ROTATE) {
+                if (file) {
+                    fflush(file);
+                    fsync(fileno(file));
+                    fclose(file);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    completeBefore = record.ids[0];
+                }
+                segmentDone.notify_all();
+                openSegment(record.ids[0]);
+                continue;
+            }
+            if (!file) continue;
+
+            record.checksum = computeChecksum(record);
+            fwrite(&record, sizeof(record), 1, file);
+        }
+
+        // One sync per batch - records queued together share the cost
+        if (file) {
+            fflush(file);
+            fsync(fileno(file));
+        }
+        batch.clear();
+    }
+
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    // Nothing more will reach disk; release anyone still waiting
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        completeBefore = INT_MAX;
+    }
+    segmentDone.notify_all();
+}
+
+uint32_t Journal::computeChecksum(const JournalRecord& record) {
+    JournalRecord copy = record;
+    copy.checksum = 0;
+
+    // FNV-1a
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&copy);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(copy); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool Journal::readSegment(const std::string& path, std::vector<JournalRecord>& records) {
+    FILE* input = fopen(path.c_str(), "rb");
+    if (!input) return false;
+
+    JournalRecord record;
+    while (fread(&record, sizeof(record), 1, input) == 1) {
+        if (record.checksum != computeChecksum(record)) {
+            LOG_WARN("Journal {} is damaged after {} records; ignoring the rest", path, records.size());
+            break;
+        }
+        records.push_back(record);
+    }
+    fclose(input);
+    return true;
+}
+
+// Segment numbers of basePath.<n> files in basePath's directory
+static std::vector<int> listSegments(const std::string& basePath) {
+    std::vector<int> segments;
+    size_t slash = basePath.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : basePath.substr(0, slash);
+    std::string prefix = (slash == std::string::npos ? basePath : basePath.substr(slash + 1)) + ".";
+
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return segments;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) continue;
+
+        std::string suffix = name.substr(prefix.size());
+        if (suffix.size() > 9 || suffix.find_first_not_of("0123456789") != std::string::npos) continue;
+        segments.push_back(std::stoi(suffix));
+    }
+    closedir(dir);
+    return segments;
+}
+
+int Journal::findLastSegment(const std::string& basePath) {
+    int last = -1;
+    for (int number : listSegments(basePath)) {
+        last = std::max(last, number);
+    }
+    return last;
+}
+
+void Journal::removeSegmentsBefore(const std::string& basePath, int firstKept) {
+    for (int number : listSegments(basePath)) {
+        if (number < firstKept) {
+            remove(segmentPath(basePath, number).c_str());
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#include "Ledger.h"
+#include "Parallel.h"
+#include <algorithm>
+
+LedgerSeries::LedgerSeries(size_t capacity)
+    : revenue(capacity, 0.0)
+    , costs(capacity, 0.0)
+    , head(0)
+    , count(0)
+{}
+
+void LedgerSeries::push(double periodRevenue, double periodCosts) {
+    revenue[head] = periodRevenue;
+    costs[head] = periodCosts;
+    head = (head + 1) % revenue.size();
+    count = std::min(count + 1, revenue.size());
+}
+
+void LedgerSeries::clear() {
+    std::fill(revenue.begin(), revenue.end(), 0.0);
+    std::fill(costs.begin(), costs.end(), 0.0);
+    head = 0;
+    count = 0;
+}
+
+LedgerPeriod LedgerSeries::get(size_t i) const {
+    if (i >= count) return {0.0, 0.0};
+    size_t capacity = revenue.size();
+    size_t index = (head + capacity - 1 - i) % capacity;
+    return {revenue[index], costs[index]};
+}
+
+LedgerPeriod LedgerSeries::sum(size_t n) const {
+    LedgerPeriod total{0.0, 0.0};
+    n = std::min(n, count);
+    for (size_t i = 0; i < n; i++) {
+        LedgerPeriod period = get(i);
+        total.revenue += period.revenue;
+        total.costs += period.costs;
+    }
+    return total;
+}
+
+Ledger::Ledger()
+    : tickRevenue(0.0)
+    , tickCosts(0.0)
+    , monthsInYear(0)
+    , ticks(TICK_HISTORY)
+    , months(MONTH_HISTORY)
+    , years(YEAR_HISTORY)
+{}
+
+void Ledger::clear() {
+    stations = Columns();
+    lines = Columns();
+    trains = Columns();
+    tickRevenue = 0.0;
+    tickCosts = 0.0;
+    monthsInYear = 0;
+    ticks.clear();
+    months.clear();
+    years.clear();
+}
+
+Ledger::Columns& Ledger::columns(LedgerAccount account) {
+    switch (account) {
+        case LedgerAccount::STATION: return stations;
+        case LedgerAccount::LINE: return lines;
+        default: return trains;
+    }
+}
+
+const Ledger::Columns& Ledger::columns(LedgerAccount account) const {
+    switch (account) {
+        case LedgerAccount::STATION: return stations;
+        case LedgerAccount::LINE: return lines;
+        default: return trains;
+    }
+}
+
+void Ledger::ensureSize(Columns& cols, int id) {
+    if (id >= (int)cols.revenue.size()) {
+        cols.revenue.resize(id + 1, 0.0);
+        cols.costs.resize(id + 1, 0.0);
+        cols.upkeep.resize(id + 1, 0.0);
+    }
+}
+
+void Ledger::setUpkeep(LedgerAccount account, int id, double monthlyCost) {
+    Columns& cols = columns(account);
+    ensureSize(cols, id);
+    cols.upkeep[id] = monthlyCost;
+}
+
+void Ledger::recordRevenue(LedgerAccount account, int id, double amount) {
+    Columns& cols = columns(account);
+    ensureSize(cols, id);
+    cols.revenue[id] += amount;
+
+    // Every trip is attributed to a station, so count the total there once
+    if (account == LedgerAccount::STATION) {
+        tickRevenue += amount;
+    }
+}
+
+void Ledger::recordCost(LedgerAccount account, int id, double amount) {
+    Columns& cols = columns(account);
+    ensureSize(cols, id);
+    cols.costs[id] += amount;
+    tickCosts += amount;
+}
+
+void Ledger::clearCosts() {
+    for (Columns* cols : {&stations, &lines, &trains}) {
+        std::fill(cols->costs.begin(), cols->costs.end(), 0.0);
+    }
+    tickCosts = 0.0;
+}
+
+void Ledger::endTick() {
+    ticks.push(tickRevenue, tickCosts);
+    tickRevenue = 0.0;
+    tickCosts = 0.0;
+}
+
+double Ledger::reduce(const std::vector<double>& column) {
+    int size = column.size();
+    int chunks = (size + REDUCE_CHUNK - 1) / REDUCE_CHUNK;
+    if (chunks <= 1) {
+        double total = 0.0;
+        for (double value : column) {
+            total += value;
+        }
+        return total;
+    }
+
+    // Chunk partials are summed in chunk order, so the result is identical
+    // however the chunks were spread over workers
+    std::vector<double> partials(chunks, 0.0);
+    parallelFor(0, chunks, [&](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            int first = c * REDUCE_CHUNK;
+            int last = std::min(size, first + REDUCE_CHUNK);
+            double total = 0.0;
+            for (int i = first; i < last; i++) {
+                total += column[i];
+            }
+            partials[c] = total;
+        }
+    }, 1);
+
+    double total = 0.0;
+    for (double partial : partials) {
+        total += partial;
+    }
+    return total;
+}
+
+LedgerPeriod Ledger::settleMonth() {
+    // Upkeep is charged alongside the costs recorded during the month
+    LedgerPeriod month{reduce(stations.revenue), 0.0};
+    for (const Columns* cols : {&stations, &lines, &trains}) {
+        month.costs += reduce(cols->costs) + reduce(cols->upkeep);
+    }
+    months.push(month.revenue, month.costs);
+
+    monthsInYear++;
+    if (monthsInYear == 12) {
+        LedgerPeriod year = months.sum(12);
+        years.push(year.revenue, year.costs);
+        monthsInYear = 0;
+    }
+
+    for (Columns* cols : {&stations, &lines, &trains}) {
+        std::fill(cols->revenue.begin(), cols->revenue.end(), 0.0);
+        std::fill(cols->costs.begin(), cols->costs.end(), 0.0);
+    }
+
+    return month;
+}
+
+double Ledger::getRevenue(LedgerAccount account, int id) const {
+    const Columns& cols = columns(account);
+    return id < (int)cols.revenue.size() ? cols.revenue[id] : 0.0;
+}
+
+double Ledger::getCosts(LedgerAccount account, int id) const {
+    const Columns& cols = columns(account);
+    return id < (int)cols.costs.size() ? cols.costs[id] : 0.0;
+}
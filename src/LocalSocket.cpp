@@ -0,0 +1,84 @@
+#include "LocalSocket.h"
+#include "Log.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+int listenLocal(const std::string& address, std::string& unixPath) {
+    int fd;
+    if (address.compare(0, 5, "unix:") == 0) {
+        std::string path = address.substr(5);
+        sockaddr_un local;
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(local.sun_path)) {
+            LOG_ERROR("Bad socket path {}", path);
+            return -1;
+        }
+        strcpy(local.sun_path, path.c_str());
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path.c_str());
+        if (fd < 0 || bind(fd, (sockaddr*)&local, sizeof(local)) < 0) {
+            LOG_ERROR("Cannot bind {}: {}", path, strerror(errno));
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        unixPath = path;
+    } else {
+        std::string host = "127.0.0.1";
+        std::string port = address;
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+
+        sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons((uint16_t)atoi(port.c_str()));
+        if (local.sin_port == 0 || inet_pton(AF_INET, host.c_str(), &local.sin_addr) != 1) {
+            LOG_ERROR("Bad address {}", address);
+            return -1;
+        }
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if (fd >= 0) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (fd < 0 || bind(fd, (sockaddr*)&local, sizeof(local)) < 0) {
+            LOG_ERROR("Cannot bind {}: {}", address, strerror(errno));
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    }
+
+    if (listen(fd, 16) < 0) {
+        LOG_ERROR("Cannot listen on {}: {}", address, strerror(errno));
+        close(fd);
+        if (!unixPath.empty()) {
+            unlink(unixPath.c_str());
+            unixPath.clear();
+        }
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const char* data, size_t size) {
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t written = send(fd, data + sent, size - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        sent += written;
+    }
+    return true;
+}
@@ -0,0 +1,215 @@
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Slots in the ring; a power of two
+static const size_t QUEUE_CAPACITY = 4096;
+// How long the writer sleeps when the ring is empty
+static const int IDLE_SLEEP_MS = 2;
+
+static std::atomic<LogLevel> runtimeLevel{LogLevel::TRACE};
+// Outside the queue so reading it never starts the writer
+static std::atomic<uint64_t> droppedCount{0};
+
+void LogRecord::addText(Arg& arg, std::string_view value) {
+    size_t length = std::min(value.size(), TEXT_CAPACITY - 1 - textUsed);
+    arg.type = TEXT;
+    arg.textOffset = textUsed;
+    memcpy(text + textUsed, value.data(), length);
+    text[textUsed + length] = '\0';
+    textUsed += length + 1;
+    // Later strings get an empty string rather than overrunning
+    if (textUsed >= TEXT_CAPACITY) textUsed = TEXT_CAPACITY - 1;
+}
+
+// Bounded multi-producer, single-consumer ring after Vyukov: each slot's
+// sequence says whose turn it is. A producer owns the slot whose sequence
+// equals its claimed position; publishing sets it to position + 1 for the
+// writer, and the writer hands it back as position + capacity.
+class LogQueue {
+public:
+    LogQueue()
+        : slots(new Slot[QUEUE_CAPACITY])
+        , enqueuePosition(0)
+        , writtenPosition(0)
+    {
+        for (size_t i = 0; i < QUEUE_CAPACITY; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        // Never joined: the writer outlives every static that might log
+        // while being destroyed, and exit drains it through flush()
+        std::thread(&LogQueue::run, this).detach();
+        std::atexit([] { Log::flush(); });
+    }
+
+    LogRecord* claim() {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & (QUEUE_CAPACITY - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.record.position = position;
+                    return &slot.record;
+                }
+            } else if (difference < 0) {
+                // The writer has not freed this slot yet: full
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(LogRecord* record) {
+        Slot& slot = slots[record->position & (QUEUE_CAPACITY - 1)];
+        slot.sequence.store(record->position + 1, std::memory_order_release);
+    }
+
+    void flush() {
+        size_t target = enqueuePosition.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(flushMutex);
+        flushed.wait(lock, [&] { return writtenPosition.load(std::memory_order_acquire) >= target; });
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    void run() {
+        size_t readPosition = 0;
+        uint64_t reportedDrops = 0;
+        std::string out;
+        std::string err;
+        for (;;) {
+            // Drain everything published, then write it in one go per stream
+            for (;;) {
+                Slot& slot = slots[readPosition & (QUEUE_CAPACITY - 1)];
+                if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1) break;
+                std::string& target = slot.record.level >= LogLevel::WARN ? err : out;
+                format(slot.record, target);
+                slot.sequence.store(readPosition + QUEUE_CAPACITY, std::memory_order_release);
+                readPosition++;
+            }
+
+            uint64_t drops = droppedCount.load(std::memory_order_relaxed);
+            if (drops != reportedDrops) {
+                err += "Log queue full, dropped " + std::to_string(drops - reportedDrops) + " messages\n";
+                reportedDrops = drops;
+            }
+
+            if (!out.empty()) {
+                fwrite(out.data(), 1, out.size(), stdout);
+                fflush(stdout);
+                out.clear();
+            }
+            if (!err.empty()) {
+                fwrite(err.data(), 1, err.size(), stderr);
+                fflush(stderr);
+                err.clear();
+            }
+
+            if (writtenPosition.load(std::memory_order_relaxed) != readPosition) {
+                {
+                    std::lock_guard<std::mutex> lock(flushMutex);
+                    writtenPosition.store(readPosition, std::memory_order_release);
+                }
+                flushed.notify_all();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_SLEEP_MS));
+            }
+        }
+    }
+
+    static void format(const LogRecord& record, std::string& out) {
+        char buffer[32];
+        int next = 0;
+        for (const char* c = record.format; *c; c++) {
+            if (c[0] != '{' || c[1] != '}' || next >= record.argCount) {
+                out += *c;
+                continue;
+            }
+            const LogRecord::Arg& arg = record.args[next++];
+            switch (arg.type) {
+            case LogRecord::INT:
+                snprintf(buffer, sizeof(buffer), "%lld", (long long)arg.i);
+                out += buffer;
+                break;
+            case LogRecord::UINT:
+                snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)arg.u);
+                out += buffer;
+                break;
+            case LogRecord::FLOAT:
+                // Same as a default std::ostream
+                snprintf(buffer, sizeof(buffer), "%g", arg.f);
+                out += buffer;
+                break;
+            case LogRecord::TEXT:
+                out += record.text + arg.textOffset;
+                break;
+            }
+            c++;
+        }
+        out += '\n';
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> enqueuePosition;
+    alignas(64) std::atomic<size_t> writtenPosition;
+
+    std::mutex flushMutex;
+    std::condition_variable flushed;
+};
+
+// Created on first use and never destroyed; see the constructor
+static LogQueue& logQueue() {
+    static LogQueue* queue = new LogQueue();
+    return *queue;
+}
+
+void Log::setLevel(LogLevel level) {
+    runtimeLevel.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Log::getLevel() {
+    return runtimeLevel.load(std::memory_order_relaxed);
+}
+
+bool Log::parseLevel(const std::string& name, LogLevel& level) {
+    static const char* names[] = {"trace", "debug", "info", "warn", "error"};
+    for (int i = 0; i < 5; i++) {
+        if (name == names[i]) {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Log::flush() {
+    logQueue().flush();
+}
+
+uint64_t Log::getDroppedCount() {
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+LogRecord* Log::claim() {
+    return logQueue().claim();
+}
+
+void Log::publish(LogRecord* record) {
+    logQueue().publish(record);
+}
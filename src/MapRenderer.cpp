@@ -1,14 +1,40 @@
 #include "MapRenderer.h"
+#include "Geodesy.h"
+#include "RenderStats.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <SDL2/SDL_image.h>
+#include <chrono>
 #include <cmath>
-#include <iostream>
 #include <curl/curl.h>
 #include <sys/stat.h>
 #include <fstream>
 
+struct TileMetrics {
+    MetricCounter& hits;
+    MetricCounter& misses;
+    MetricHistogram& decodeSeconds;
+    MetricGauge& cached;
+};
+
+static TileMetrics& tileMetrics() {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    static TileMetrics metrics = {
+        registry.counter("trainbuilder_tile_cache_hits_total", "Map tile lookups answered from the cache"),
+        registry.counter("trainbuilder_tile_cache_misses_total", "Map tile lookups that went to disk"),
+        registry.histogram("trainbuilder_tile_decode_seconds", "Time to decode and upload one map tile",
+                           MetricHistogram::exponentialBounds(0.0001, 2.0, 12)),
+        registry.gauge("trainbuilder_tile_cache_entries", "Map tiles in the cache, including missing ones"),
+    };
+    return metrics;
+}
+
 MapRenderer::MapRenderer(SDL_Renderer* renderer)
     : renderer(renderer)
     , currentCountry("default")
+    , viewWidth(1280)
+    , viewHeight(720)
+    , prefetch(true)
 {}
 
 MapRenderer::~MapRenderer() {
@@ -25,7 +51,7 @@ bool MapRenderer::init(double centerLat, double centerLon, int zoom) {
     // Initialize SDL_image for PNG support
     int imgFlags = IMG_INIT_PNG;
     if (!(IMG_Init(imgFlags) & imgFlags)) {
-        std::cerr << "SDL_image could not initialize! SDL_image Error: " << IMG_GetError() << std::endl;
+        LOG_ERROR("SDL_image could not initialize! SDL_image Error: {}", IMG_GetError());
         return false;
     }
 
@@ -48,6 +74,12 @@ void MapRenderer::setCountry(const std::string& countryName) {
         }
     }
     tileCache.clear();
+    tileMetrics().cached.set(0.0);
+}
+
+void MapRenderer::setViewSize(int width, int height) {
+    viewWidth = width;
+    viewHeight = height;
 }
 
 void MapRenderer::render(double centerLat, double centerLon, int zoom) {
@@ -55,14 +87,13 @@ void MapRenderer::render(double centerLat, double centerLon, int zoom) {
     latLonToTile(centerLat, centerLon, zoom, centerTileX, centerTileY);
 
     // Calculate how many tiles we need to cover the screen
-    int tilesX = (SCREEN_WIDTH / TILE_SIZE) + 2;
-    int tilesY = (SCREEN_HEIGHT / TILE_SIZE) + 2;
+    int tilesX = (viewWidth / TILE_SIZE) + 2;
+    int tilesY = (viewHeight / TILE_SIZE) + 2;
 
     // Calculate offset within the center tile
     double n = pow(2.0, zoom);
-    double exactX = (centerLon + 180.0) / 360.0 * n;
-    double latRad = centerLat * M_PI / 180.0;
-    double exactY = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * n;
+    double exactX = lonToMercatorX(centerLon) * n;
+    double exactY = latToMercatorY(centerLat) * n;
 
     int pixelOffsetX = (int)((exactX - centerTileX) * TILE_SIZE);
     int pixelOffsetY = (int)((exactY - centerTileY) * TILE_SIZE);
@@ -79,15 +110,21 @@ void MapRenderer::render(double centerLat, double centerLon, int zoom) {
 
             if (tileY < 0 || tileY >= maxTile) continue;
 
-            SDL_Texture* tile = getTile(zoom, tileX, tileY);
-            if (tile) {
-                SDL_Rect destRect;
-                destRect.x = SCREEN_WIDTH/2 + dx * TILE_SIZE - pixelOffsetX;
-                destRect.y = SCREEN_HEIGHT/2 + dy * TILE_SIZE - pixelOffsetY;
-                destRect.w = TILE_SIZE;
-                destRect.h = TILE_SIZE;
+            SDL_Rect destRect;
+            destRect.x = viewWidth/2 + dx * TILE_SIZE - pixelOffsetX;
+            destRect.y = viewHeight/2 + dy * TILE_SIZE - pixelOffsetY;
+            destRect.w = TILE_SIZE;
+            destRect.h = TILE_SIZE;
 
+            // The margin around the view is only there to prefetch
+            bool visible = destRect.x < viewWidth && destRect.x + TILE_SIZE > 0 &&
+                           destRect.y < viewHeight && destRect.y + TILE_SIZE > 0;
+            if (!visible && !prefetch) continue;
+
+            SDL_Texture* tile = getTile(zoom, tileX, tileY);
+            if (tile && visible) {
                 SDL_RenderCopy(renderer, tile, nullptr, &destRect);
+                RenderStats::global().drawCalls++;
             }
         }
     }
@@ -97,52 +134,62 @@ ScreenCoordinate MapRenderer::latLonToScreen(double lat, double lon, double cent
     double n = pow(2.0, zoom);
 
     // Convert lat/lon to tile coordinates (floating point)
-    double x1 = (lon + 180.0) / 360.0 * n;
-    double latRad1 = lat * M_PI / 180.0;
-    double y1 = (1.0 - log(tan(latRad1) + 1.0 / cos(latRad1)) / M_PI) / 2.0 * n;
+    double x1 = lonToMercatorX(lon) * n;
+    double y1 = latToMercatorY(lat) * n;
 
-    double x2 = (centerLon + 180.0) / 360.0 * n;
-    double latRad2 = centerLat * M_PI / 180.0;
-    double y2 = (1.0 - log(tan(latRad2) + 1.0 / cos(latRad2)) / M_PI) / 2.0 * n;
+    double x2 = lonToMercatorX(centerLon) * n;
+    double y2 = latToMercatorY(centerLat) * n;
 
     ScreenCoordinate result;
-    result.x = SCREEN_WIDTH/2 + (int)((x1 - x2) * TILE_SIZE);
-    result.y = SCREEN_HEIGHT/2 + (int)((y1 - y2) * TILE_SIZE);
+    result.x = viewWidth/2 + (int)((x1 - x2) * TILE_SIZE);
+    result.y = viewHeight/2 + (int)((y1 - y2) * TILE_SIZE);
 
     return result;
 }
 
+void MapRenderer::latLonToScreen(const double* lats, const double* lons, size_t count,
+                                 double centerLat, double centerLon, int zoom,
+                                 ScreenCoordinate* out) {
+    projectX.resize(count);
+    projectY.resize(count);
+    latLonToMercatorBatch(lats, lons, count, projectX.data(), projectY.data());
+
+    // Same rounding as the single-point version, with the center hoisted
+    double n = pow(2.0, zoom);
+    double centerX = lonToMercatorX(centerLon) * n;
+    double centerY = latToMercatorY(centerLat) * n;
+    for (size_t i = 0; i < count; i++) {
+        out[i].x = viewWidth/2 + (int)((projectX[i] * n - centerX) * TILE_SIZE);
+        out[i].y = viewHeight/2 + (int)((projectY[i] * n - centerY) * TILE_SIZE);
+    }
+}
+
 MapCoordinate MapRenderer::screenToLatLon(int x, int y, double centerLat, double centerLon, int zoom) {
     double n = pow(2.0, zoom);
 
     // Convert center to tile coordinates
-    double centerX = (centerLon + 180.0) / 360.0 * n;
-    double latRad = centerLat * M_PI / 180.0;
-    double centerY = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * n;
+    double centerX = lonToMercatorX(centerLon) * n;
+    double centerY = latToMercatorY(centerLat) * n;
 
     // Convert screen offset to tile offset
-    double dx = (x - SCREEN_WIDTH/2) / (double)TILE_SIZE;
-    double dy = (y - SCREEN_HEIGHT/2) / (double)TILE_SIZE;
+    double dx = (x - viewWidth/2) / (double)TILE_SIZE;
+    double dy = (y - viewHeight/2) / (double)TILE_SIZE;
 
     double tileX = centerX + dx;
     double tileY = centerY + dy;
 
     // Convert back to lat/lon
     MapCoordinate result;
-    result.lon = tileX / n * 360.0 - 180.0;
-
-    double yTile = tileY / n;
-    result.lat = atan(sinh(M_PI * (1 - 2 * yTile))) * 180.0 / M_PI;
+    result.lon = mercatorXToLon(tileX / n);
+    result.lat = mercatorYToLat(tileY / n);
 
     return result;
 }
 
 void MapRenderer::latLonToTile(double lat, double lon, int zoom, int& tileX, int& tileY) {
     double n = pow(2.0, zoom);
-    tileX = (int)((lon + 180.0) / 360.0 * n);
-
-    double latRad = lat * M_PI / 180.0;
-    tileY = (int)((1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * n);
+    tileX = (int)(lonToMercatorX(lon) * n);
+    tileY = (int)(latToMercatorY(lat) * n);
 }
 
 std::string MapRenderer::getTilePath(int zoom, int x, int y) {
@@ -197,8 +244,7 @@ bool MapRenderer::downloadTile(int zoom, int x, int y) {
             success = true;
         }
     } else {
-        std::cerr << "Failed to download tile " << zoom << "/" << x << "/" << y
-                  << ": " << curl_easy_strerror(res) << std::endl;
+        LOG_WARN("Failed to download tile {}/{}/{}: {}", zoom, x, y, curl_easy_strerror(res));
     }
 
     curl_easy_cleanup(curl);
@@ -210,8 +256,8 @@ bool MapRenderer::preloadCountryTiles(const std::string& countryCode,
                                       double minLon, double maxLon,
                                       int minZoom, int maxZoom,
                                       std::function<void(const TileDownloadProgress&)> progressCallback) {
-    std::cout << "Pre-downloading tiles for " << countryCode << std::endl;
-    std::cout << "Zoom levels: " << minZoom << " to " << maxZoom << std::endl;
+    LOG_INFO("Pre-downloading tiles for {}", countryCode);
+    LOG_INFO("Zoom levels: {} to {}", minZoom, maxZoom);
 
     // Calculate total number of tiles
     int totalTiles = 0;
@@ -225,7 +271,7 @@ bool MapRenderer::preloadCountryTiles(const std::string& countryCode,
         totalTiles += tilesX * tilesY;
     }
 
-    std::cout << "Total tiles to download: " << totalTiles << std::endl;
+    LOG_INFO("Total tiles to download: {}", totalTiles);
 
     int downloadedTiles = 0;
     TileDownloadProgress progress{totalTiles, 0, false};
@@ -236,8 +282,7 @@ bool MapRenderer::preloadCountryTiles(const std::string& countryCode,
         latLonToTile(maxLat, minLon, zoom, minTileX, minTileY);
         latLonToTile(minLat, maxLon, zoom, maxTileX, maxTileY);
 
-        std::cout << "Zoom " << zoom << ": tiles " << minTileX << "-" << maxTileX
-                  << ", " << minTileY << "-" << maxTileY << std::endl;
+        LOG_DEBUG("Zoom {}: tiles {}-{}, {}-{}", zoom, minTileX, maxTileX, minTileY, maxTileY);
 
         for (int y = minTileY; y <= maxTileY; y++) {
             for (int x = minTileX; x <= maxTileX; x++) {
@@ -257,8 +302,7 @@ bool MapRenderer::preloadCountryTiles(const std::string& countryCode,
 
                 // Print progress every 10 tiles
                 if (downloadedTiles % 10 == 0) {
-                    std::cout << "Progress: " << downloadedTiles << "/" << totalTiles
-                              << " (" << (100 * downloadedTiles / totalTiles) << "%)" << std::endl;
+                    LOG_INFO("Progress: {}/{} ({}%)", downloadedTiles, totalTiles, 100 * downloadedTiles / totalTiles);
                 }
             }
         }
@@ -269,41 +313,50 @@ bool MapRenderer::preloadCountryTiles(const std::string& countryCode,
         progressCallback(progress);
     }
 
-    std::cout << "Tile pre-loading complete!" << std::endl;
+    LOG_INFO("Tile pre-loading complete!");
     return true;
 }
 
 SDL_Texture* MapRenderer::getTile(int zoom, int x, int y) {
-    std::string key = std::to_string(zoom) + "_" + std::to_string(x) + "_" + std::to_string(y);
+    uint64_t key = tileKey(zoom, x, y);
 
-    // Check cache first
+    // Check cache first - a hit allocates nothing
+    TileMetrics& metrics = tileMetrics();
     auto it = tileCache.find(key);
     if (it != tileCache.end()) {
+        metrics.hits.add();
         return it->second;
     }
+    metrics.misses.add();
 
-    std::string path = getTilePath(zoom, x, y);
-
-    // NEVER download during rendering - only load existing files
-    // Check if file exists
+    // NEVER download during rendering - only load existing files. Missing
+    // and unreadable tiles are cached as null so they aren't looked for on
+    // disk again every frame; setCountry() clears them with the rest.
     if (!tileExists(zoom, x, y)) {
-        // Return nullptr if tile doesn't exist - no download during render!
+        tileCache[key] = nullptr;
+        metrics.cached.set((double)tileCache.size());
         return nullptr;
     }
 
     // Load texture from disk
+    auto decodeStart = std::chrono::steady_clock::now();
+    std::string path = getTilePath(zoom, x, y);
     SDL_Surface* surface = IMG_Load(path.c_str());
     if (!surface) {
         // Silently fail - don't spam console during render
+        tileCache[key] = nullptr;
+        metrics.cached.set((double)tileCache.size());
         return nullptr;
     }
 
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    RenderStats& stats = RenderStats::global();
+    stats.tilesDecoded++;
+    stats.bytesUploaded += (uint64_t)surface->pitch * surface->h;
     SDL_FreeSurface(surface);
 
-    if (texture) {
-        tileCache[key] = texture;
-    }
-
+    tileCache[key] = texture;
+    metrics.cached.set((double)tileCache.size());
+    metrics.decodeSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - decodeStart).count());
     return texture;
 }
@@ -0,0 +1,168 @@
+#include "Metrics.h"
+#include "Log.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+void MetricGauge::add(double amount) {
+    double current = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(current, current + amount, std::memory_order_relaxed)) {}
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds)
+    : bounds(bounds)
+    , buckets(new std::atomic<uint64_t>[bounds.size() + 1])
+{
+    for (size_t i = 0; i <= bounds.size(); i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(double value) {
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    double current = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+}
+
+uint64_t MetricHistogram::getCount() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i <= bounds.size(); i++) {
+        total += getBucket(i);
+    }
+    return total;
+}
+
+std::vector<double> MetricHistogram::exponentialBounds(double start, double factor, int count) {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+    for (int i = 0; i < count; i++) {
+        bounds.push_back(start);
+        start *= factor;
+    }
+    return bounds;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::find(Kind kind, const std::string& name, const std::string& help,
+                                              const std::string& labels) {
+    for (auto& entry : entries) {
+        if (entry->name != name || entry->labels != labels) continue;
+        if (entry->kind == kind) return *entry;
+        // Still hand out a working metric, but one that is never exported,
+        // so the clash can't corrupt the output
+        LOG_WARN("Metric {} registered again as a different type", name);
+        static std::vector<std::unique_ptr<Entry>> orphans;
+        orphans.push_back(std::unique_ptr<Entry>(new Entry{kind, name, help, labels, nullptr, nullptr, nullptr}));
+        return *orphans.back();
+    }
+    entries.push_back(std::unique_ptr<Entry>(new Entry{kind, name, help, labels, nullptr, nullptr, nullptr}));
+    return *entries.back();
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = find(Kind::COUNTER, name, help, labels);
+    if (!entry.counter) entry.counter.reset(new MetricCounter());
+    return *entry.counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = find(Kind::GAUGE, name, help, labels);
+    if (!entry.gauge) entry.gauge.reset(new MetricGauge());
+    return *entry.gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                            const std::vector<double>& bounds, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = find(Kind::HISTOGRAM, name, help, labels);
+    if (!entry.histogram) entry.histogram.reset(new MetricHistogram(bounds));
+    return *entry.histogram;
+}
+
+void MetricsRegistry::addCollector(const std::function<void()>& collector) {
+    std::lock_guard<std::mutex> lock(mutex);
+    collectors.push_back(collector);
+}
+
+// name{labels,extra} - either label list may be empty
+static void appendSeries(std::string& out, const std::string& name, const std::string& labels,
+                         const std::string& extra) {
+    out += name;
+    if (labels.empty() && extra.empty()) return;
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extra.empty()) out += ',';
+    out += extra;
+    out += '}';
+}
+
+static void appendValue(std::string& out, double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), " %.10g\n", value);
+    out += buffer;
+}
+
+static void appendValue(std::string& out, uint64_t value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), " %" PRIu64 "\n", value);
+    out += buffer;
+}
+
+std::string MetricsRegistry::exportText() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& collector : collectors) {
+        collector();
+    }
+
+    std::string out;
+    std::vector<bool> written(entries.size(), false);
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (written[i]) continue;
+        const Entry& family = *entries[i];
+        const char* type = family.kind == Kind::COUNTER ? "counter"
+                         : family.kind == Kind::GAUGE ? "gauge" : "histogram";
+        out += "# HELP " + family.name + " " + family.help + "\n";
+        out += "# TYPE " + family.name + " " + type + "\n";
+
+        for (size_t j = i; j < entries.size(); j++) {
+            const Entry& entry = *entries[j];
+            if (written[j] || entry.name != family.name || entry.kind != family.kind) continue;
+            written[j] = true;
+
+            if (entry.kind == Kind::COUNTER) {
+                appendSeries(out, entry.name, entry.labels, "");
+                appendValue(out, entry.counter->get());
+            } else if (entry.kind == Kind::GAUGE) {
+                appendSeries(out, entry.name, entry.labels, "");
+                appendValue(out, entry.gauge->get());
+            } else {
+                const MetricHistogram& histogram = *entry.histogram;
+                uint64_t cumulative = 0;
+                char bound[40];
+                for (size_t b = 0; b < histogram.getBounds().size(); b++) {
+                    cumulative += histogram.getBucket(b);
+                    snprintf(bound, sizeof(bound), "le=\"%.10g\"", histogram.getBounds()[b]);
+                    appendSeries(out, entry.name + "_bucket", entry.labels, bound);
+                    appendValue(out, cumulative);
+                }
+                // The total comes from the same bucket reads, so it can't
+                // fall below the last bound's count mid-observation
+                cumulative += histogram.getBucket(histogram.getBounds().size());
+                appendSeries(out, entry.name + "_bucket", entry.labels, "le=\"+Inf\"");
+                appendValue(out, cumulative);
+                appendSeries(out, entry.name + "_sum", entry.labels, "");
+                appendValue(out, histogram.getSum());
+                appendSeries(out, entry.name + "_count", entry.labels, "");
+                appendValue(out, cumulative);
+            }
+        }
+    }
+    return out;
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
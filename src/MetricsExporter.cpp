@@ -0,0 +1,175 @@
+#include "MetricsExporter.h"
+#include "AllocationStats.h"
+#include "LocalSocket.h"
+#include "Log.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+// How often the thread wakes to notice stop() while nothing arrives
+static const int POLL_MS = 200;
+// A scraper that stalls mid-request is dropped after this long
+static const int CLIENT_TIMEOUT_MS = 1000;
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry)
+    : registry(registry)
+    , listenFd(-1)
+    , fileInterval(10.0)
+    , stopping(false)
+{
+    registerProcessMetrics(registry);
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::listen(const std::string& address) {
+    listenFd = listenLocal(address, unixPath);
+    if (listenFd < 0) return false;
+    LOG_INFO("Serving metrics on {}", address);
+    return true;
+}
+
+void MetricsExporter::writeFile(const std::string& path, double intervalSeconds) {
+    filePath = path;
+    fileInterval = intervalSeconds > 0.0 ? intervalSeconds : 10.0;
+}
+
+void MetricsExporter::start() {
+    if (thread.joinable() || (listenFd < 0 && filePath.empty())) return;
+    stopping = false;
+    thread = std::thread(&MetricsExporter::run, this);
+}
+
+void MetricsExporter::stop() {
+    if (thread.joinable()) {
+        stopping = true;
+        thread.join();
+        // The final state, once the simulation has finished
+        if (!filePath.empty()) writeFileNow();
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+    if (!unixPath.empty()) {
+        unlink(unixPath.c_str());
+        unixPath.clear();
+    }
+}
+
+void MetricsExporter::run() {
+    using Clock = std::chrono::steady_clock;
+    auto nextWrite = Clock::now();
+
+    while (!stopping) {
+        int timeout = POLL_MS;
+        if (!filePath.empty()) {
+            auto now = Clock::now();
+            if (now >= nextWrite) {
+                writeFileNow();
+                nextWrite = now + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(fileInterval));
+            }
+            auto untilWrite = std::chrono::duration_cast<std::chrono::milliseconds>(nextWrite - Clock::now());
+            timeout = std::max(0, std::min(timeout, (int)untilWrite.count()));
+        }
+
+        if (listenFd < 0) {
+            poll(nullptr, 0, timeout);
+            continue;
+        }
+        pollfd ready = {listenFd, POLLIN, 0};
+        if (poll(&ready, 1, timeout) > 0 && (ready.revents & POLLIN)) {
+            int client = accept(listenFd, nullptr, nullptr);
+            if (client >= 0) {
+                serveClient(client);
+                close(client);
+            }
+        }
+    }
+}
+
+void MetricsExporter::serveClient(int client) {
+    // Whatever the request, the answer is the metrics. Read up to the end
+    // of its headers first, so the client sees a clean close.
+    std::string request;
+    char buffer[1024];
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CLIENT_TIMEOUT_MS);
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        pollfd readable = {client, POLLIN, 0};
+        if (left <= 0 || poll(&readable, 1, left) <= 0) return;
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) return;
+        request.append(buffer, received);
+    }
+
+    std::string body = registry.exportText();
+    std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                           std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    sendAll(client, response.data(), response.size());
+}
+
+bool MetricsExporter::writeFileNow() {
+    // Readers never see a half-written file
+    std::string temporary = filePath + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            LOG_ERROR("Cannot write metrics to {}", temporary);
+            return false;
+        }
+        out << registry.exportText();
+        if (!out) return false;
+    }
+    return rename(temporary.c_str(), filePath.c_str()) == 0;
+}
+
+void MetricsExporter::registerProcessMetrics(MetricsRegistry& registry) {
+    static std::once_flag once;
+    std::call_once(once, [&registry]() {
+        MetricGauge& resident = registry.gauge("trainbuilder_resident_memory_bytes",
+                                               "Resident set size of the process");
+        long pageSize = sysconf(_SC_PAGESIZE);
+        registry.addCollector([&resident, pageSize]() {
+            // Linux only; elsewhere the gauge stays at zero
+            long pages = 0, residentPages = 0;
+            FILE* statm = fopen("/proc/self/statm", "r");
+            if (!statm) return;
+            if (fscanf(statm, "%ld %ld", &pages, &residentPages) == 2) {
+                resident.set((double)residentPages * pageSize);
+            }
+            fclose(statm);
+        });
+
+        MetricCounter& logDropped = registry.counter("trainbuilder_log_dropped_total",
+                                                     "Log messages dropped because the queue was full");
+        registry.addCollector([&logDropped]() {
+            logDropped.add(Log::getDroppedCount() - logDropped.get());
+        });
+
+        if (!AllocationStats::enabled()) return;
+        for (int i = 0; i < (int)AllocSubsystem::COUNT; i++) {
+            AllocSubsystem subsystem = (AllocSubsystem)i;
+            std::string labels = std::string("subsystem=\"") + AllocationStats::name(subsystem) + "\"";
+            MetricCounter& allocations = registry.counter("trainbuilder_heap_allocations_total",
+                                                          "Heap allocations by subsystem", labels);
+            MetricCounter& bytes = registry.counter("trainbuilder_heap_allocated_bytes_total",
+                                                    "Bytes allocated on the heap by subsystem", labels);
+            // The allocation hook keeps its own totals; catch the counters up
+            registry.addCollector([subsystem, &allocations, &bytes]() {
+                AllocationCounts counts = AllocationStats::get(subsystem);
+                allocations.add(counts.allocations - allocations.get());
+                bytes.add(counts.bytes - bytes.get());
+            });
+        }
+    });
+}
@@ -0,0 +1,262 @@
+#include "NetworkGraph.h"
+#include "Station.h"
+#include "TrainLine.h"
+#include "Timetable.h"
+#include <algorithm>
+#include <cstdint>
+
+// Position along a Hilbert curve on a 2^16 x 2^16 grid
+static uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    const uint32_t n = 1u << 16;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+NetworkGraph::NetworkGraph()
+    : offsets(1, 0)
+{}
+
+void NetworkGraph::clear() {
+    offsets.assign(1, 0);
+    targets.clear();
+    edgeLines.clear();
+    edgeLengths.clear();
+    edgeTimes.clear();
+    lats.clear();
+    lons.clear();
+    stationToNode.clear();
+    nodeToStation.clear();
+    lineEdges.clear();
+}
+
+std::vector<int> NetworkGraph::computeOrder(const std::vector<Station>& stations, Ordering ordering) const {
+    // Start from ascending station ids, so the order depends on the ids
+    // alone and not on where removals left each station in the array
+    int count = stations.size();
+    std::vector<int> order(count);
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    auto byId = [&stations](int a, int b) { return stations[a].getId() < stations[b].getId(); };
+    if (!std::is_sorted(order.begin(), order.end(), byId)) {
+        std::sort(order.begin(), order.end(), byId);
+    }
+
+    if (ordering == Ordering::HILBERT && count > 1) {
+        double minLat = stations[0].getLat(), maxLat = minLat;
+        double minLon = stations[0].getLon(), maxLon = minLon;
+        for (const auto& station : stations) {
+            minLat = std::min(minLat, station.getLat());
+            maxLat = std::max(maxLat, station.getLat());
+            minLon = std::min(minLon, station.getLon());
+            maxLon = std::max(maxLon, station.getLon());
+        }
+        double latSpan = std::max(maxLat - minLat, 1e-9);
+        double lonSpan = std::max(maxLon - minLon, 1e-9);
+
+        std::vector<uint64_t> keys(count);
+        for (int i = 0; i < count; i++) {
+            uint32_t x = (uint32_t)((stations[i].getLon() - minLon) / lonSpan * 65535.0);
+            uint32_t y = (uint32_t)((stations[i].getLat() - minLat) / latSpan * 65535.0);
+            keys[i] = hilbertIndex(x, y);
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&keys](int a, int b) { return keys[a] < keys[b]; });
+    }
+
+    return order;
+}
+
+int NetworkGraph::getSlotCount(const std::vector<Station>& stations) {
+    int slots = 0;
+    for (const auto& station : stations) {
+        slots = std::max(slots, station.getId() + 1);
+    }
+    return slots;
+}
+
+void NetworkGraph::build(const std::vector<Station>& stations,
+                         const std::vector<TrainLine>& lines,
+                         const Timetable& timetable,
+                         Ordering ordering) {
+    int count = stations.size();
+
+    // Ids can have gaps where stations were removed; those map to node -1
+    std::vector<int> order = computeOrder(stations, ordering);
+    nodeToStation.resize(count);
+    stationToNode.assign(getSlotCount(stations), -1);
+    lats.resize(count);
+    lons.resize(count);
+    for (int node = 0; node < count; node++) {
+        const Station& station = stations[order[node]];
+        nodeToStation[node] = station.getId();
+        stationToNode[station.getId()] = node;
+        lats[node] = station.getLat();
+        lons[node] = station.getLon();
+    }
+
+    // Count degrees, prefix-sum into offsets, then scatter edges
+    offsets.assign(count + 1, 0);
+    int lineSlots = 0;
+    for (const auto& line : lines) {
+        offsets[stationToNode[line.getStation1()] + 1]++;
+        offsets[stationToNode[line.getStation2()] + 1]++;
+        lineSlots = std::max(lineSlots, line.getId() + 1);
+    }
+    for (int node = 0; node < count; node++) {
+        offsets[node + 1] += offsets[node];
+    }
+
+    int edgeCount = offsets[count];
+    targets.resize(edgeCount);
+    edgeLines.resize(edgeCount);
+    edgeLengths.resize(edgeCount);
+    edgeTimes.resize(edgeCount);
+    lineEdges.assign(lineSlots * 2, -1);
+
+    // Edges scatter in line id order, so each node's neighbors come out
+    // the same however removals shuffled the line array
+    std::vector<int> lineOrder(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) {
+        lineOrder[i] = (int)i;
+    }
+    auto lineById = [&lines](int a, int b) { return lines[a].getId() < lines[b].getId(); };
+    if (!std::is_sorted(lineOrder.begin(), lineOrder.end(), lineById)) {
+        std::sort(lineOrder.begin(), lineOrder.end(), lineById);
+    }
+
+    std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int position : lineOrder) {
+        const TrainLine& line = lines[position];
+        int a = stationToNode[line.getStation1()];
+        int b = stationToNode[line.getStation2()];
+        float length = (float)line.getLength();
+        float time = (float)timetable.getLegTime(line.getId());
+
+        int forward = cursor[a]++;
+        targets[forward] = b;
+        edgeLines[forward] = line.getId();
+        edgeLengths[forward] = length;
+        edgeTimes[forward] = time;
+
+        int backward = cursor[b]++;
+        targets[backward] = a;
+        edgeLines[backward] = line.getId();
+        edgeLengths[backward] = length;
+        edgeTimes[backward] = time;
+
+        lineEdges[line.getId() * 2] = forward;
+        lineEdges[line.getId() * 2 + 1] = backward;
+    }
+}
+
+void NetworkGraph::appendStation(const Station& station) {
+    // A new station has no lines yet, so it becomes an empty trailing row
+    int node = nodeToStation.size();
+    if (station.getId() >= (int)stationToNode.size()) {
+        stationToNode.resize(station.getId() + 1, -1);
+    }
+    stationToNode[station.getId()] = node;
+    nodeToStation.push_back(station.getId());
+    lats.push_back(station.getLat());
+    lons.push_back(station.getLon());
+    offsets.push_back(offsets.back());
+}
+
+void NetworkGraph::removeStation(int stationId) {
+    int node = toNode(stationId);
+    if (node < 0 || edgeBegin(node) != edgeEnd(node)) return;
+
+    // Later nodes move down one, and so does every reference to them
+    nodeToStation.erase(nodeToStation.begin() + node);
+    lats.erase(lats.begin() + node);
+    lons.erase(lons.begin() + node);
+    offsets.erase(offsets.begin() + node + 1);
+    for (int& target : targets) {
+        if (target > node) target--;
+    }
+    for (int& mapped : stationToNode) {
+        if (mapped > node) mapped--;
+    }
+    stationToNode[stationId] = -1;
+    while (!stationToNode.empty() && stationToNode.back() < 0) {
+        stationToNode.pop_back();
+    }
+}
+
+void NetworkGraph::insertEdge(int node, int edge, int target, int lineId, float length, float travelTime) {
+    targets.insert(targets.begin() + edge, target);
+    edgeLines.insert(edgeLines.begin() + edge, lineId);
+    edgeLengths.insert(edgeLengths.begin() + edge, length);
+    edgeTimes.insert(edgeTimes.begin() + edge, travelTime);
+    for (int& index : lineEdges) {
+        if (index >= edge) index++;
+    }
+    for (size_t n = node + 1; n < offsets.size(); n++) {
+        offsets[n]++;
+    }
+}
+
+void NetworkGraph::eraseEdge(int node, int edge) {
+    targets.erase(targets.begin() + edge);
+    edgeLines.erase(edgeLines.begin() + edge);
+    edgeLengths.erase(edgeLengths.begin() + edge);
+    edgeTimes.erase(edgeTimes.begin() + edge);
+    for (int& index : lineEdges) {
+        if (index > edge) index--;
+    }
+    for (size_t n = node + 1; n < offsets.size(); n++) {
+        offsets[n]--;
+    }
+}
+
+void NetworkGraph::addLine(const TrainLine& line, float travelTime) {
+    int lineId = line.getId();
+    int a = toNode(line.getStation1());
+    int b = toNode(line.getStation2());
+    if (a < 0 || b < 0) return;
+    if (lineId * 2 + 1 >= (int)lineEdges.size()) {
+        lineEdges.resize(lineId * 2 + 2, -1);
+    }
+
+    // Each edge goes after the node's lower line ids, as a build lays them out
+    float length = (float)line.getLength();
+    int ends[2] = {a, b};
+    for (int i = 0; i < 2; i++) {
+        int node = ends[i];
+        int edge = edgeBegin(node);
+        while (edge < edgeEnd(node) && edgeLines[edge] < lineId) {
+            edge++;
+        }
+        insertEdge(node, edge, ends[1 - i], lineId, length, travelTime);
+        lineEdges[lineId * 2 + i] = edge;
+    }
+}
+
+void NetworkGraph::removeLine(int lineId) {
+    if (lineId < 0 || lineId * 2 + 1 >= (int)lineEdges.size()) return;
+
+    for (int i = 0; i < 2; i++) {
+        int edge = lineEdges[lineId * 2 + i];
+        if (edge < 0) continue;
+        lineEdges[lineId * 2 + i] = -1;
+        // The node whose row holds the edge
+        int node = std::upper_bound(offsets.begin(), offsets.end(), edge) - offsets.begin() - 1;
+        eraseEdge(node, edge);
+    }
+    while (!lineEdges.empty() && lineEdges.back() < 0) {
+        lineEdges.pop_back();
+    }
+}
@@ -0,0 +1,33 @@
+#include "Parallel.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+
+static thread_local bool serial = false;
+
+SerialScope::SerialScope()
+    : previous(serial)
+{
+    serial = true;
+}
+
+SerialScope::~SerialScope() {
+    serial = previous;
+}
+
+int getWorkerCount() {
+    return TaskScheduler::global().getWorkerCount();
+}
+
+void parallelFor(int begin, int end, const std::function<void(int, int)>& body, int minChunk) {
+    int count = end - begin;
+    if (count <= 0) return;
+    if (serial) {
+        body(begin, end);
+        return;
+    }
+
+    // A few tasks per worker leaves room for stealing to even out the load
+    int workers = getWorkerCount();
+    int grain = std::max(minChunk, count / (workers * 4));
+    TaskScheduler::global().parallelFor(begin, end, grain, body);
+}
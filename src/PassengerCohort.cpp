@@ -0,0 +1,162 @@
+#include "PassengerCohort.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+CohortArena::CohortArena()
+    : nextSlot(0)
+    , liveCount(0)
+{
+    blocks.reserve(MAX_BLOCKS);
+}
+
+int CohortArena::allocate(const PassengerCohort& cohort) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        if (nextSlot >= (int)getCapacity()) {
+            blocks.emplace_back(new PassengerCohort[BLOCK_SIZE]);
+        }
+        slot = nextSlot++;
+    }
+
+    get(slot) = cohort;
+    liveCount++;
+    return slot;
+}
+
+void CohortArena::release(int slot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeSlots.push_back(slot);
+    liveCount--;
+}
+
+void CohortArena::clear() {
+    // Keep the blocks around for the next game
+    freeSlots.clear();
+    nextSlot = 0;
+    liveCount = 0;
+}
+
+float CohortArena::bucketTime(double simTime) {
+    return (float)(std::floor(simTime / SPAWN_BUCKET) * SPAWN_BUCKET);
+}
+
+CohortPool::CohortPool()
+    : total(0)
+{}
+
+size_t CohortPool::KeyHash::operator()(const Key& key) const {
+    uint32_t time;
+    std::memcpy(&time, &key.spawnTime, sizeof(time));
+    uint64_t trip = (uint64_t)(uint32_t)key.origin << 32 | (uint32_t)key.destination;
+    return std::hash<uint64_t>()(trip * 0x9E3779B97F4A7C15ull ^ time);
+}
+
+void CohortPool::insert(CohortArena& arena, int slot) {
+    const PassengerCohort& cohort = arena.get(slot);
+    total += cohort.count;
+    auto found = index.emplace(keyOf(cohort), slot);
+    if (!found.second) {
+        arena.get(found.first->second).count += cohort.count;
+        arena.release(slot);
+        return;
+    }
+    slots.push_back(slot);
+}
+
+void CohortPool::add(CohortArena& arena, int origin, int destination, int count, float spawnTime) {
+    if (count <= 0) return;
+
+    total += count;
+    auto found = index.find({origin, destination, spawnTime});
+    if (found != index.end()) {
+        arena.get(found->second).count += count;
+        return;
+    }
+    int slot = arena.allocate({origin, destination, count, spawnTime});
+    index.emplace(Key{origin, destination, spawnTime}, slot);
+    slots.push_back(slot);
+}
+
+void CohortPool::erase(CohortArena& arena, size_t i) {
+    index.erase(keyOf(arena.get(slots[i])));
+    slots[i] = slots.back();
+    slots.pop_back();
+}
+
+int CohortPool::transfer(CohortArena& arena, CohortPool& to, int limit,
+                         const std::function<bool(const PassengerCohort&)>& predicate) {
+    int moved = 0;
+    size_t i = 0;
+    while (i < slots.size() && moved < limit) {
+        int slot = slots[i];
+        PassengerCohort& cohort = arena.get(slot);
+        if (!predicate(cohort)) {
+            i++;
+            continue;
+        }
+
+        int room = limit - moved;
+        if (cohort.count <= room) {
+            // Whole cohort moves - swap-remove keeps this O(1)
+            moved += cohort.count;
+            total -= cohort.count;
+            erase(arena, i);
+            to.insert(arena, slot);
+        } else {
+            // Split: the remainder stays behind
+            cohort.count -= room;
+            total -= room;
+            moved += room;
+            to.add(arena, cohort.origin, cohort.destination, room, cohort.spawnTime);
+            i++;
+        }
+    }
+    return moved;
+}
+
+int CohortPool::expire(CohortArena& arena, float cutoff) {
+    return remove(arena, [cutoff](const PassengerCohort& cohort) { return cohort.spawnTime < cutoff; });
+}
+
+int CohortPool::remove(CohortArena& arena, const std::function<bool(const PassengerCohort&)>& predicate) {
+    int dropped = 0;
+    size_t i = 0;
+    while (i < slots.size()) {
+        const PassengerCohort& cohort = arena.get(slots[i]);
+        if (!predicate(cohort)) {
+            i++;
+            continue;
+        }
+        dropped += cohort.count;
+        int slot = slots[i];
+        erase(arena, i);
+        arena.release(slot);
+    }
+    total -= dropped;
+    return dropped;
+}
+
+void CohortPool::drain(CohortArena& arena, const std::function<void(const PassengerCohort&)>& callback) {
+    for (int slot : slots) {
+        callback(arena.get(slot));
+        arena.release(slot);
+    }
+    slots.clear();
+    index.clear();
+    total = 0;
+}
+
+void CohortPool::clear(CohortArena& arena) {
+    for (int slot : slots) {
+        arena.release(slot);
+    }
+    slots.clear();
+    index.clear();
+    total = 0;
+}
@@ -0,0 +1,278 @@
+#include "Router.h"
+#include "Parallel.h"
+#include "NetworkGraph.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+Router::Router()
+    : stationCount(0)
+    , treeCapacity(0)
+    , dirtyCount(0)
+    , graph(nullptr)
+    , useClock(0)
+    , cacheBudget(DEFAULT_CACHE_BUDGET)
+    , cacheBytes(0)
+    , cachedTrees(0)
+{}
+
+Router::~Router() {
+    clear();
+}
+
+void Router::clear() {
+    for (int d = 0; d < stationCount; d++) {
+        evict(d);
+    }
+    lines.clear();
+    trees.reset();
+    stationCount = 0;
+    treeCapacity = 0;
+    dirtyCount = 0;
+    graph = nullptr;
+}
+
+void Router::setStationCount(int count) {
+    if (count <= stationCount) return;
+
+    if (count > treeCapacity) {
+        int capacity = std::max(64, treeCapacity * 2);
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        std::unique_ptr<std::atomic<RouteTree*>[]> grown(new std::atomic<RouteTree*>[capacity]);
+        for (int d = 0; d < capacity; d++) {
+            grown[d].store(d < stationCount ? trees[d].load(std::memory_order_relaxed) : nullptr,
+                           std::memory_order_relaxed);
+        }
+        trees.swap(grown);
+        treeCapacity = capacity;
+    }
+    stationCount = count;
+}
+
+void Router::evict(int destination) {
+    RouteTree* tree = trees[destination].exchange(nullptr, std::memory_order_relaxed);
+    if (!tree) return;
+    if (tree->dirty) dirtyCount--;
+    cacheBytes.fetch_sub(tree->getBytes(), std::memory_order_relaxed);
+    cachedTrees.fetch_sub(1, std::memory_order_relaxed);
+    delete tree;
+}
+
+void Router::removeStation(int stationId) {
+    if (stationId >= 0 && stationId < stationCount) {
+        evict(stationId);
+    }
+}
+
+void Router::markAffected(int lineId, int station1Id, int station2Id, float newCost) {
+    // Nothing cached, e.g. while a saved game is loading
+    if (cachedTrees.load(std::memory_order_relaxed) == 0) return;
+    for (int d = 0; d < stationCount; d++) {
+        RouteTree* tree = trees[d].load(std::memory_order_relaxed);
+        if (!tree || tree->dirty) continue;
+
+        // A tree changes if it routed through this line before, or if the
+        // line now offers a shortcut between its endpoints
+        bool used = tree->getLine(station1Id) == lineId || tree->getLine(station2Id) == lineId;
+        bool shortcut = tree->getTime(station1Id) + newCost < tree->getTime(station2Id) ||
+                        tree->getTime(station2Id) + newCost < tree->getTime(station1Id);
+        if (used || shortcut) {
+            tree->dirty = true;
+            dirtyCount++;
+        }
+    }
+}
+
+void Router::setLine(int lineId, int station1Id, int station2Id, double rideTime, double headway) {
+    if (lineId >= (int)lines.size()) {
+        lines.resize(lineId + 1, LineEdge{-1, -1, UNREACHABLE, UNREACHABLE, false});
+    }
+
+    // A line without trains cannot carry anyone
+    float waitCost = headway > 0 ? (float)(headway * 0.5) + TRANSFER_PENALTY : UNREACHABLE;
+    float cost = (float)rideTime + waitCost;
+
+    LineEdge& line = lines[lineId];
+    line.station1Id = station1Id;
+    line.station2Id = station2Id;
+    line.cost = cost;
+    line.waitCost = waitCost;
+    line.active = true;
+
+    markAffected(lineId, station1Id, station2Id, cost);
+}
+
+void Router::removeLine(int lineId) {
+    if (lineId < 0 || lineId >= (int)lines.size() || !lines[lineId].active) return;
+
+    LineEdge& line = lines[lineId];
+    line.active = false;
+    markAffected(lineId, line.station1Id, line.station2Id, UNREACHABLE);
+}
+
+void Router::computeTree(int destination, RouteTree& tree) const {
+    // Per-thread scratch: misses are solved on whichever worker queried
+    thread_local std::vector<float> nodeTime;
+    thread_local std::vector<int> nodeLine;
+
+    int nodeCount = graph->getNodeCount();
+    nodeTime.assign(nodeCount, UNREACHABLE);
+    nodeLine.assign(nodeCount, -1);
+
+    // Lines are symmetric, so Dijkstra outward from the destination gives
+    // the time to reach it from every station. The search runs over graph
+    // nodes and is scattered back to station ids at the end. Queue ties
+    // break on station id, so routes don't depend on how the graph
+    // happens to number its nodes.
+    typedef std::pair<float, int> QueueEntry; // time, station id
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+    // A removed station has no node, and nothing reaches it
+    int source = graph->toNode(destination);
+    if (source >= 0) {
+        nodeTime[source] = 0.0f;
+        queue.push({0.0f, destination});
+    }
+
+    while (!queue.empty()) {
+        QueueEntry top = queue.top();
+        queue.pop();
+        int u = graph->toNode(top.second);
+        if (top.first > nodeTime[u]) continue;
+
+        for (int e = graph->edgeBegin(u); e < graph->edgeEnd(u); e++) {
+            int lineId = graph->getLine(e);
+            if (lineId >= (int)lines.size() || !lines[lineId].active) continue;
+
+            int v = graph->getTarget(e);
+            float t = top.first + graph->getTravelTime(e) + lines[lineId].waitCost;
+            if (t < nodeTime[v]) {
+                nodeTime[v] = t;
+                nodeLine[v] = lineId;
+                queue.push({t, graph->toStation(v)});
+            }
+        }
+    }
+
+    tree.time.assign(stationCount, UNREACHABLE);
+    tree.nextLine.assign(stationCount, -1);
+    for (int node = 0; node < nodeCount; node++) {
+        int stationId = graph->toStation(node);
+        tree.time[stationId] = nodeTime[node];
+        tree.nextLine[stationId] = nodeLine[node];
+    }
+    tree.dirty = false;
+}
+
+const Router::RouteTree* Router::findTree(int destination) const {
+    if (destination < 0 || destination >= stationCount || !graph) return nullptr;
+
+    RouteTree* tree = trees[destination].load(std::memory_order_acquire);
+    if (!tree) {
+        // Built outside any lock; when two threads miss on the same
+        // destination, the first to publish wins and the other's copy,
+        // which is identical, is dropped
+        RouteTree* built = new RouteTree();
+        computeTree(destination, *built);
+        built->lastUse.store(useClock, std::memory_order_relaxed);
+        if (trees[destination].compare_exchange_strong(tree, built, std::memory_order_acq_rel)) {
+            cacheBytes.fetch_add(built->getBytes(), std::memory_order_relaxed);
+            cachedTrees.fetch_add(1, std::memory_order_relaxed);
+            return built;
+        }
+        delete built;
+    }
+
+    // Only written when it changes, so hot trees don't bounce between cores
+    if (tree->lastUse.load(std::memory_order_relaxed) != useClock) {
+        tree->lastUse.store(useClock, std::memory_order_relaxed);
+    }
+    return tree;
+}
+
+// Only between ticks: a query on another thread may be reading any tree
+// until then
+void Router::trimCache() {
+    if (cacheBytes.load(std::memory_order_relaxed) <= cacheBudget) return;
+
+    std::vector<std::pair<uint64_t, int>> cached;
+    cached.reserve(cachedTrees.load(std::memory_order_relaxed));
+    for (int d = 0; d < stationCount; d++) {
+        RouteTree* tree = trees[d].load(std::memory_order_relaxed);
+        if (tree) {
+            cached.push_back({tree->lastUse.load(std::memory_order_relaxed), d});
+        }
+    }
+    std::sort(cached.begin(), cached.end());
+
+    for (const auto& entry : cached) {
+        if (cacheBytes.load(std::memory_order_relaxed) <= cacheBudget) break;
+        evict(entry.second);
+    }
+}
+
+void Router::update(const NetworkGraph& newGraph) {
+    graph = &newGraph;
+    useClock++;
+
+    if (dirtyCount > 0) {
+        std::vector<int> dirty;
+        dirty.reserve(dirtyCount);
+        for (int d = 0; d < stationCount; d++) {
+            RouteTree* tree = trees[d].load(std::memory_order_relaxed);
+            if (tree && tree->dirty) {
+                dirty.push_back(d);
+            }
+        }
+
+        // Trees are independent, so each worker solves its own
+        // destinations. A recomputed tree grows to the current station count.
+        parallelFor(0, dirty.size(), [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                RouteTree* tree = trees[dirty[i]].load(std::memory_order_relaxed);
+                size_t before = tree->getBytes();
+                computeTree(dirty[i], *tree);
+                cacheBytes.fetch_add(tree->getBytes() - before, std::memory_order_relaxed);
+            }
+        }, 8);
+        dirtyCount = 0;
+    }
+
+    trimCache();
+}
+
+bool Router::isReachable(int from, int to) const {
+    return getJourneyTime(from, to) != UNREACHABLE;
+}
+
+float Router::getJourneyTime(int from, int to) const {
+    if (from < 0 || from >= stationCount) return UNREACHABLE;
+    const RouteTree* tree = findTree(to);
+    return tree ? tree->getTime(from) : UNREACHABLE;
+}
+
+int Router::getNextLine(int at, int to) const {
+    if (at < 0 || at >= stationCount) return -1;
+    const RouteTree* tree = findTree(to);
+    return tree ? tree->getLine(at) : -1;
+}
+
+int Router::getNextStation(int at, int to) const {
+    int lineId = getNextLine(at, to);
+    if (lineId < 0) return -1;
+    const LineEdge& line = lines[lineId];
+    return line.station1Id == at ? line.station2Id : line.station1Id;
+}
+
+void Router::getJourneyTimes(const std::vector<int>& from, const std::vector<int>& to,
+                             std::vector<float>& times) const {
+    times.resize(from.size());
+    parallelFor(0, from.size(), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            times[i] = getJourneyTime(from[i], to[i]);
+        }
+    }, 4096);
+}
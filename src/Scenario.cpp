@@ -0,0 +1,57 @@
+#include "Scenario.h"
+#include "World.h"
+#include <random>
+
+void buildScenario(World& world, const ScenarioOptions& options) {
+    world.clear();
+    std::mt19937 gen(options.seed);
+    std::uniform_real_distribution<double> latDist(options.minLat, options.maxLat);
+    std::uniform_real_distribution<double> lonDist(options.minLon, options.maxLon);
+
+    std::uniform_real_distribution<double> radiusDist(0.5, 3.0);
+    std::uniform_int_distribution<int> populationDist(5000, 200000);
+    std::vector<PopulationCenter> centers;
+    for (int i = 0; i < options.populationCenters; i++) {
+        centers.push_back({latDist(gen), lonDist(gen), radiusDist(gen), populationDist(gen)});
+    }
+    world.setPopulation(centers);
+
+    Economy& economy = world.getEconomy();
+    double startingMoney = economy.getMoney();
+    economy.setOverdraft(true);
+
+    for (int i = 0; i < options.stationCount; i++) {
+        world.placeStation(latDist(gen), lonDist(gen));
+    }
+
+    int stationCount = world.getStations().size();
+    if (stationCount >= 2) {
+        // Spanning tree first so every station is reachable
+        for (int i = 1; i < stationCount; i++) {
+            world.buildLine(std::uniform_int_distribution<int>(0, i - 1)(gen), i);
+        }
+        std::uniform_int_distribution<int> stationDist(0, stationCount - 1);
+        for (int i = 0; i < options.extraLineCount; i++) {
+            int a = stationDist(gen);
+            int b = stationDist(gen);
+            if (a != b) {
+                world.buildLine(a, b);
+            }
+        }
+    }
+
+    int lineCount = world.getLines().size();
+    for (int lineId = 0; lineId < lineCount; lineId++) {
+        for (int t = 0; t < options.trainsPerLine; t++) {
+            world.addTrain(lineId);
+        }
+    }
+
+    world.reorderNetwork();
+
+    economy.setOverdraft(false);
+    if (!options.chargeConstruction) {
+        economy.restore(startingMoney, 0.0, 0.0, 0.0f);
+        economy.waiveRecordedCosts();
+    }
+}
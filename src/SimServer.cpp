@@ -0,0 +1,571 @@
+#include "SimServer.h"
+#include "LocalSocket.h"
+#include "Parallel.h"
+#include "Scenario.h"
+#include "Log.h"
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <sstream>
+
+const double SimServer::TICK_SECONDS = 1.0 / 60.0;
+
+// How often blocked socket threads wake to notice stop()
+static const int POLL_MS = 200;
+// A client that sends more than this without a newline is cut off
+static const size_t MAX_LINE = 4096;
+
+static std::vector<std::string> splitWords(const std::string& line) {
+    std::vector<std::string> words;
+    std::istringstream in(line);
+    std::string word;
+    while (in >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+static bool parseInt(const std::string& text, long& value) {
+    char* end;
+    errno = 0;
+    value = strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && errno == 0;
+}
+
+static bool parseDouble(const std::string& text, double& value) {
+    char* end;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+SimServer::SimServer(const SimServerOptions& options)
+    : options(options)
+    , stopping(false)
+    , shutdownRequested(false)
+    , nextWorldId(0)
+    , listenFd(-1)
+{
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    int shardCount = options.shardCount > 0 ? options.shardCount : cores;
+
+    MetricsRegistry& registry = MetricsRegistry::global();
+    for (int i = 0; i < shardCount; i++) {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->index = i;
+        shard->core = options.pinShards ? i % cores : -1;
+
+        std::string labels = "shard=\"" + std::to_string(i) + "\"";
+        shard->ticks = &registry.counter("trainbuilder_shard_ticks_total", "Ticks run by a server shard", labels);
+        shard->worldTicks = &registry.counter("trainbuilder_shard_world_ticks_total",
+                                              "World updates run by a server shard", labels);
+        shard->overruns = &registry.counter("trainbuilder_shard_overruns_total",
+                                            "Shard ticks that started over a period late", labels);
+        shard->worldCount = &registry.gauge("trainbuilder_shard_worlds", "Worlds hosted by a server shard", labels);
+        shard->tickSeconds = &registry.histogram("trainbuilder_shard_tick_seconds",
+                                                 "Wall time to advance every world on a shard by one tick",
+                                                 MetricHistogram::exponentialBounds(0.0001, 2.0, 14), labels);
+        shards.push_back(std::move(shard));
+    }
+}
+
+SimServer::~SimServer() {
+    stop();
+}
+
+bool SimServer::listen(const std::string& address) {
+    listenFd = listenLocal(address, unixPath);
+    if (listenFd < 0) return false;
+    LOG_INFO("Simulation server listening on {}", address);
+    return true;
+}
+
+void SimServer::start() {
+    stopping = false;
+    for (auto& shard : shards) {
+        Shard* owner = shard.get();
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->closed = false;
+        }
+        shard->thread = std::thread([this, owner]() { runShard(*owner); });
+    }
+    if (listenFd >= 0) {
+        acceptor = std::thread(&SimServer::acceptClients, this);
+    }
+}
+
+void SimServer::stop() {
+    stopping = true;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->wake.notify_all();
+    }
+
+    if (acceptor.joinable()) acceptor.join();
+    // Shards answer whatever is still queued on their way out, so no
+    // client is left waiting
+    for (auto& shard : shards) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto& client : clients) {
+            if (client->thread.joinable()) client->thread.join();
+        }
+        clients.clear();
+    }
+
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+    if (!unixPath.empty()) {
+        unlink(unixPath.c_str());
+        unixPath.clear();
+    }
+}
+
+void SimServer::runShard(Shard& shard) {
+#ifdef __linux__
+    if (shard.core >= 0) {
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        CPU_SET(shard.core, &cores);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) != 0) {
+            LOG_WARN("Cannot pin shard {} to core {}", shard.index, shard.core);
+        }
+    }
+#endif
+    // Each world runs on this thread alone; the cores are already busy
+    // with the other shards
+    SerialScope serial;
+
+    using Clock = std::chrono::steady_clock;
+    bool paced = options.tickRate > 0.0;
+    Clock::duration period = paced ? std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.tickRate)) : Clock::duration::zero();
+    Clock::time_point next = Clock::now();
+    std::vector<std::function<void()>> pending;
+
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            auto ready = [&]() { return stopping || !shard.commands.empty(); };
+            if (paced) {
+                shard.wake.wait_until(lock, next, ready);
+            } else if (shard.worlds.empty()) {
+                shard.wake.wait(lock, ready);
+            }
+            pending.swap(shard.commands);
+        }
+        for (auto& command : pending) {
+            command();
+        }
+        pending.clear();
+        if (stopping) break;
+
+        Clock::time_point start = Clock::now();
+        if (paced) {
+            // Woken early for commands; the tick is still due at next
+            if (start < next) continue;
+            // Far behind: skip the missed ticks rather than race to catch up
+            if (start - next > period) {
+                shard.overruns->add();
+                next = start;
+            }
+            next += period;
+        }
+
+        for (auto& hosted : shard.worlds) {
+            hosted->world.update((float)TICK_SECONDS);
+            hosted->ticks++;
+        }
+        shard.ticks->add();
+        shard.worldTicks->add(shard.worlds.size());
+        shard.tickSeconds->observe(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.closed = true;
+        pending.swap(shard.commands);
+    }
+    for (auto& command : pending) {
+        command();
+    }
+}
+
+std::string SimServer::runOnShard(Shard& shard, const std::function<std::string()>& work) {
+    auto result = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> reply = result->get_future();
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.closed) {
+            return "ERR server is not running";
+        }
+        shard.commands.push_back([work, result]() { result->set_value(work()); });
+        shard.wake.notify_one();
+    }
+    return reply.get();
+}
+
+SimServer::HostedWorld* SimServer::findWorld(Shard& shard, int worldId) {
+    for (auto& hosted : shard.worlds) {
+        if (hosted->id == worldId) return hosted.get();
+    }
+    return nullptr;
+}
+
+SimServer::Shard* SimServer::shardOf(int worldId) {
+    std::lock_guard<std::mutex> lock(directoryMutex);
+    auto it = worldShards.find(worldId);
+    return it == worldShards.end() ? nullptr : shards[it->second].get();
+}
+
+int SimServer::placeWorld() {
+    // The shard with the fewest worlds; call with directoryMutex held
+    std::vector<int> load(shards.size(), 0);
+    for (const auto& entry : worldShards) {
+        load[entry.second]++;
+    }
+    return (int)(std::min_element(load.begin(), load.end()) - load.begin());
+}
+
+std::string SimServer::execute(const std::string& line) {
+    std::vector<std::string> args = splitWords(line);
+    if (args.empty()) return "ERR empty command";
+    std::string command = args[0];
+    std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+    args.erase(args.begin());
+
+    if (command == "PING") return "OK";
+    if (command == "CREATE") return createWorld(args);
+    if (command == "LOAD") return loadWorld(args);
+    if (command == "LIST") return listWorlds();
+    if (command == "STATS") return describeStats();
+    if (command == "SHUTDOWN") {
+        shutdownRequested = true;
+        return "OK";
+    }
+    return worldCommand(command, args);
+}
+
+std::string SimServer::createWorld(const std::vector<std::string>& args) {
+    ScenarioOptions scenario;
+    for (const auto& arg : args) {
+        size_t equals = arg.find('=');
+        long value;
+        if (equals == std::string::npos || !parseInt(arg.substr(equals + 1), value) || value < 0) {
+            return "ERR bad option " + arg;
+        }
+        std::string key = arg.substr(0, equals);
+        if (key == "stations" && value >= 2) {
+            scenario.stationCount = (int)value;
+        } else if (key == "extra-lines") {
+            scenario.extraLineCount = (int)value;
+        } else if (key == "trains-per-line") {
+            scenario.trainsPerLine = (int)value;
+        } else if (key == "seed") {
+            scenario.seed = (uint32_t)value;
+        } else {
+            return "ERR bad option " + arg;
+        }
+    }
+
+    int worldId;
+    Shard* shard;
+    {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        worldId = nextWorldId++;
+        int index = placeWorld();
+        worldShards[worldId] = index;
+        shard = shards[index].get();
+    }
+
+    // Built on the shard's own thread, so its memory starts out near the
+    // core that will run it
+    std::string reply = runOnShard(*shard, [this, shard, worldId, scenario]() {
+        std::unique_ptr<HostedWorld> hosted(new HostedWorld());
+        hosted->id = worldId;
+        hosted->world.setReporting(false);
+        buildScenario(hosted->world, scenario);
+        shard->worlds.push_back(std::move(hosted));
+        shard->worldCount->set((double)shard->worlds.size());
+        return "OK " + std::to_string(worldId);
+    });
+    if (reply.compare(0, 2, "OK") != 0) {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        worldShards.erase(worldId);
+    }
+    return reply;
+}
+
+std::string SimServer::loadWorld(const std::vector<std::string>& args) {
+    if (args.size() != 1) return "ERR usage: LOAD <snapshot>";
+    std::string path = args[0];
+
+    int worldId;
+    Shard* shard;
+    {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        worldId = nextWorldId++;
+        int index = placeWorld();
+        worldShards[worldId] = index;
+        shard = shards[index].get();
+    }
+
+    std::string reply = runOnShard(*shard, [shard, worldId, path]() {
+        SnapshotReader reader;
+        if (!reader.open(path) || !World::validateSnapshot(reader)) {
+            return "ERR cannot load " + path;
+        }
+        std::unique_ptr<HostedWorld> hosted(new HostedWorld());
+        hosted->id = worldId;
+        hosted->world.setReporting(false);
+        hosted->world.loadSnapshot(reader);
+        shard->worlds.push_back(std::move(hosted));
+        shard->worldCount->set((double)shard->worlds.size());
+        return "OK " + std::to_string(worldId);
+    });
+    if (reply.compare(0, 2, "OK") != 0) {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        worldShards.erase(worldId);
+    }
+    return reply;
+}
+
+std::string SimServer::worldCommand(const std::string& command, const std::vector<std::string>& args) {
+    static const char* const worldCommands[] = {"STATE", "STATION", "LINE", "TRAIN", "REMOVE_TRAIN",
+                                                "REMOVE_LINE", "REMOVE_STATION", "SNAPSHOT", "DESTROY"};
+    if (std::find(std::begin(worldCommands), std::end(worldCommands), command) == std::end(worldCommands)) {
+        return "ERR unknown command " + command;
+    }
+    long worldId;
+    if (args.empty() || !parseInt(args[0], worldId)) {
+        return "ERR missing world";
+    }
+    Shard* shard = shardOf((int)worldId);
+    if (!shard) return "ERR no world " + args[0];
+
+    std::string reply = runOnShard(*shard, [this, shard, command, args, worldId]() -> std::string {
+        HostedWorld* hosted = findWorld(*shard, (int)worldId);
+        if (!hosted) return "ERR no world " + args[0];
+        World& world = hosted->world;
+        char buffer[256];
+
+        if (command == "STATE" && args.size() == 1) {
+            snprintf(buffer, sizeof(buffer),
+                     "OK world=%ld shard=%d tick=%" PRIu64 " clock=%.3f stations=%zu lines=%zu trains=%zu "
+                     "money=%.2f hash=%016" PRIx64,
+                     worldId, shard->index, hosted->ticks, world.getSimClock(), world.getStations().size(),
+                     world.getLines().size(), world.getTrains().size(), world.getEconomy().getMoney(),
+                     world.computeHash());
+            return buffer;
+        }
+        if (command == "STATION" && args.size() == 3) {
+            double lat, lon;
+            if (!parseDouble(args[1], lat) || !parseDouble(args[2], lon) ||
+                lat < -90.0 || lat > 90.0 || lon < -180.0 || lon > 180.0) {
+                return "ERR bad coordinates";
+            }
+            int stationId = world.getStations().nextIndex();
+            if (!world.placeStation(lat, lon)) return "ERR not enough money";
+            return "OK " + std::to_string(stationId);
+        }
+        if (command == "LINE" && args.size() == 3) {
+            long station1, station2;
+            if (!parseInt(args[1], station1) || !parseInt(args[2], station2) || station1 == station2 ||
+                !world.getStations().containsIndex((int)station1) ||
+                !world.getStations().containsIndex((int)station2)) {
+                return "ERR bad stations";
+            }
+            int lineId = world.getLines().nextIndex();
+            if (!world.buildLine((int)station1, (int)station2)) return "ERR not enough money";
+            return "OK " + std::to_string(lineId);
+        }
+        if (command == "TRAIN" && args.size() == 2) {
+            long lineId;
+            if (!parseInt(args[1], lineId) || !world.getLines().containsIndex((int)lineId)) {
+                return "ERR bad line";
+            }
+            int trainId = world.getTrains().nextIndex();
+            if (!world.addTrain((int)lineId)) return "ERR not enough money";
+            return "OK " + std::to_string(trainId);
+        }
+        if (command == "REMOVE_TRAIN" && args.size() == 2) {
+            long trainId;
+            if (!parseInt(args[1], trainId) || !world.removeTrain(world.getTrainHandle((int)trainId))) {
+                return "ERR bad train";
+            }
+            return "OK";
+        }
+        if (command == "REMOVE_LINE" && args.size() == 2) {
+            long lineId;
+            if (!parseInt(args[1], lineId) || !world.removeLine(world.getLineHandle((int)lineId))) {
+                return "ERR bad line";
+            }
+            return "OK";
+        }
+        if (command == "REMOVE_STATION" && args.size() == 2) {
+            long stationId;
+            if (!parseInt(args[1], stationId) || !world.removeStation(world.getStationHandle((int)stationId))) {
+                return "ERR bad station";
+            }
+            return "OK";
+        }
+        if (command == "SNAPSHOT" && args.size() <= 2) {
+            std::string path;
+            if (args.size() == 2) {
+                path = args[1];
+            } else {
+                mkdir(options.snapshotDirectory.c_str(), 0755);
+                path = options.snapshotDirectory + "/world-" + args[0] + ".tbsave";
+            }
+            SnapshotWorld header;
+            memset(&header, 0, sizeof(header));
+            if (!world.writeSnapshot(path, header)) return "ERR cannot write " + path;
+            return "OK " + path;
+        }
+        if (command == "DESTROY" && args.size() == 1) {
+            auto it = std::find_if(shard->worlds.begin(), shard->worlds.end(),
+                                   [hosted](const std::unique_ptr<HostedWorld>& w) { return w.get() == hosted; });
+            shard->worlds.erase(it);
+            shard->worldCount->set((double)shard->worlds.size());
+            return "OK";
+        }
+        return "ERR usage: " + command + " <world> ...";
+    });
+
+    if (command == "DESTROY" && reply == "OK") {
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        worldShards.erase((int)worldId);
+    }
+    return reply;
+}
+
+std::string SimServer::listWorlds() {
+    // Each shard describes its own worlds
+    std::vector<std::string> lines;
+    for (auto& shard : shards) {
+        Shard* owner = shard.get();
+        std::string part = runOnShard(*owner, [owner]() {
+            std::string out;
+            char buffer[160];
+            for (const auto& hosted : owner->worlds) {
+                snprintf(buffer, sizeof(buffer), "%d shard=%d tick=%" PRIu64 " stations=%zu trains=%zu money=%.2f\n",
+                         hosted->id, owner->index, hosted->ticks, hosted->world.getStations().size(),
+                         hosted->world.getTrains().size(), hosted->world.getEconomy().getMoney());
+                out += buffer;
+            }
+            return out;
+        });
+        if (part.compare(0, 3, "ERR") == 0) return part;
+        std::istringstream in(part);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+    }
+
+    std::string out = "OK " + std::to_string(lines.size());
+    for (const auto& line : lines) {
+        out += "\n" + line;
+    }
+    return out;
+}
+
+std::string SimServer::describeStats() {
+    std::vector<ShardStats> stats = getShardStats();
+    std::string out = "OK " + std::to_string(stats.size());
+    char buffer[160];
+    for (size_t i = 0; i < stats.size(); i++) {
+        snprintf(buffer, sizeof(buffer), "\nshard=%zu core=%d worlds=%d ticks=%" PRIu64 " world_ticks=%" PRIu64
+                 " overruns=%" PRIu64, i, stats[i].core, stats[i].worlds, stats[i].ticks, stats[i].worldTicks,
+                 stats[i].overruns);
+        out += buffer;
+    }
+    return out;
+}
+
+std::vector<ShardStats> SimServer::getShardStats() const {
+    std::vector<ShardStats> stats;
+    for (const auto& shard : shards) {
+        stats.push_back({shard->core, (int)shard->worldCount->get(), shard->ticks->get(),
+                         shard->worldTicks->get(), shard->overruns->get()});
+    }
+    return stats;
+}
+
+void SimServer::acceptClients() {
+    while (!stopping) {
+        pollfd ready = {listenFd, POLLIN, 0};
+        if (poll(&ready, 1, POLL_MS) <= 0 || !(ready.revents & POLLIN)) continue;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        // Reap connections that have closed
+        for (auto it = clients.begin(); it != clients.end();) {
+            if ((*it)->done) {
+                (*it)->thread.join();
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::unique_ptr<Client> client(new Client());
+        Client* state = client.get();
+        client->thread = std::thread([this, fd, state]() { serveClient(fd, *state); });
+        clients.push_back(std::move(client));
+    }
+}
+
+void SimServer::serveClient(int client, Client& state) {
+    std::string buffer;
+    char chunk[1024];
+    while (!stopping) {
+        size_t newline;
+        bool quit = false;
+        while (!quit && (newline = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+
+            std::vector<std::string> words = splitWords(line);
+            if (!words.empty() && (words[0] == "QUIT" || words[0] == "quit")) {
+                quit = true;
+                break;
+            }
+            std::string response = execute(line) + "\n";
+            quit = !sendAll(client, response.data(), response.size());
+        }
+        if (quit) break;
+        if (buffer.size() > MAX_LINE) {
+            const char* error = "ERR line too long\n";
+            sendAll(client, error, strlen(error));
+            break;
+        }
+
+        pollfd readable = {client, POLLIN, 0};
+        int ready = poll(&readable, 1, POLL_MS);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+        ssize_t received = recv(client, chunk, sizeof(chunk), 0);
+        if (received <= 0) break;
+        buffer.append(chunk, received);
+    }
+    close(client);
+    state.done = true;
+}
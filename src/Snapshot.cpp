@@ -0,0 +1,181 @@
+#include "Snapshot.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char SNAPSHOT_MAGIC[8] = {'T', 'B', 'S', 'N', 'A', 'P', '\0', '\0'};
+static const uint32_t ENDIAN_TAG = 0x01020304;
+static const size_t SECTION_ALIGNMENT = 16;
+
+struct SnapshotFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint32_t sectionCount;
+    uint32_t reserved;
+    uint64_t fileSize;
+};
+
+struct SnapshotSectionEntry {
+    uint32_t tag;
+    uint32_t stride;
+    uint64_t count;
+    uint64_t offset;
+};
+
+static size_t alignUp(size_t value) {
+    return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+void SnapshotWriter::addSection(SnapshotSection tag, const void* data, size_t stride, size_t count) {
+    sections.push_back({tag, data, stride, count});
+}
+
+void SnapshotWriter::write(std::vector<char>& buffer) const {
+    // Lay out the table first so every section offset is known up front
+    std::vector<SnapshotSectionEntry> table;
+    size_t offset = alignUp(sizeof(SnapshotFileHeader) + sections.size() * sizeof(SnapshotSectionEntry));
+    for (const auto& section : sections) {
+        table.push_back({(uint32_t)section.tag, (uint32_t)section.stride,
+                         (uint64_t)section.count, (uint64_t)offset});
+        offset = alignUp(offset + section.stride * section.count);
+    }
+
+    SnapshotFileHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SnapshotReader::FORMAT_VERSION;
+    header.endianTag = ENDIAN_TAG;
+    header.sectionCount = sections.size();
+    header.reserved = 0;
+    header.fileSize = offset;
+
+    // Zero-filled, so the alignment padding needs no writes of its own
+    buffer.assign(offset, 0);
+    memcpy(buffer.data(), &header, sizeof(header));
+    memcpy(buffer.data() + sizeof(header), table.data(), table.size() * sizeof(SnapshotSectionEntry));
+    for (size_t i = 0; i < sections.size(); i++) {
+        size_t bytes = sections[i].stride * sections[i].count;
+        if (bytes > 0) {
+            memcpy(buffer.data() + table[i].offset, sections[i].data, bytes);
+        }
+    }
+}
+
+bool SnapshotWriter::write(const std::string& path) const {
+    std::vector<char> buffer;
+    write(buffer);
+    return writeFile(path, buffer);
+}
+
+bool SnapshotWriter::writeFile(const std::string& path, const std::vector<char>& buffer) {
+    std::string tempPath = path + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR("Failed to create snapshot: {}", tempPath);
+        return false;
+    }
+    file.write(buffer.data(), buffer.size());
+    file.close();
+
+    if (!file) {
+        LOG_ERROR("Failed to write snapshot: {}", tempPath);
+        remove(tempPath.c_str());
+        return false;
+    }
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Failed to replace snapshot: {}", path);
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+SnapshotReader::SnapshotReader()
+    : mapping(nullptr)
+    , mappingSize(0)
+{}
+
+SnapshotReader::~SnapshotReader() {
+    close();
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SnapshotFileHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+
+    mapping = static_cast<const unsigned char*>(data);
+    mappingSize = info.st_size;
+
+    // Validate everything once here so views never need bounds checks
+    const SnapshotFileHeader* header = reinterpret_cast<const SnapshotFileHeader*>(mapping);
+    bool valid = memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->endianTag == ENDIAN_TAG &&
+                 header->version <= FORMAT_VERSION &&
+                 header->fileSize == mappingSize &&
+                 sizeof(SnapshotFileHeader) + header->sectionCount * sizeof(SnapshotSectionEntry) <= mappingSize;
+
+    if (valid) {
+        const SnapshotSectionEntry* table = reinterpret_cast<const SnapshotSectionEntry*>(mapping + sizeof(SnapshotFileHeader));
+        for (uint32_t i = 0; i < header->sectionCount && valid; i++) {
+            const SnapshotSectionEntry& entry = table[i];
+            valid = entry.offset % SECTION_ALIGNMENT == 0 &&
+                    entry.offset <= mappingSize &&
+                    (entry.stride == 0 || entry.count <= (mappingSize - entry.offset) / entry.stride);
+        }
+    }
+
+    if (!valid) {
+        LOG_ERROR("Snapshot is corrupt or from a newer version: {}", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SnapshotReader::close() {
+    if (mapping) {
+        munmap(const_cast<unsigned char*>(mapping), mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+bool SnapshotReader::hasSection(SnapshotSection tag) const {
+    const unsigned char* data;
+    size_t stride, count;
+    return findSection(tag, data, stride, count);
+}
+
+bool SnapshotReader::findSection(SnapshotSection tag, const unsigned char*& data,
+                                 size_t& stride, size_t& count) const {
+    if (!mapping) return false;
+
+    const SnapshotFileHeader* header = reinterpret_cast<const SnapshotFileHeader*>(mapping);
+    const SnapshotSectionEntry* table = reinterpret_cast<const SnapshotSectionEntry*>(mapping + sizeof(SnapshotFileHeader));
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        if (table[i].tag == (uint32_t)tag) {
+            data = mapping + table[i].offset;
+            stride = table[i].stride;
+            count = table[i].count;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,23 +1,26 @@
 #include "Station.h"
+#include <algorithm>
 
 Station::Station(int id, double lat, double lon, const std::string& name)
     : id(id)
     , lat(lat)
     , lon(lon)
     , name(name)
-    , passengerCount(0)
-    , buildCost(5000)
-    , maintenanceCost(100)
 {}
 
-void Station::addPassengers(int count) {
-    passengerCount += count;
-}
-
-void Station::removePassengers(int count) {
-    passengerCount = std::max(0, passengerCount - count);
+void Station::addPassengers(CohortArena& arena, int destination, int count, float spawnTime) {
+    waiting.add(arena, id, destination, count, spawnTime);
 }
 
 void Station::addConnectedLine(int lineId) {
     connectedLines.push_back(lineId);
 }
+
+void Station::removeConnectedLine(int lineId) {
+    // A handful of lines per station, so a scan is cheap
+    auto it = std::find(connectedLines.begin(), connectedLines.end(), lineId);
+    if (it != connectedLines.end()) {
+        *it = connectedLines.back();
+        connectedLines.pop_back();
+    }
+}
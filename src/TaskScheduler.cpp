@@ -0,0 +1,123 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+TaskScheduler::TaskScheduler(int workerCount)
+    : pendingTasks(0)
+    , stopping(false)
+{
+    workerCount = std::max(1, workerCount);
+
+    // One queue per background worker plus one shared by calling threads
+    for (int i = 0; i < workerCount; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (int i = 0; i < workerCount - 1; i++) {
+        workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::global() {
+    static TaskScheduler scheduler(std::max(1u, std::thread::hardware_concurrency()));
+    return scheduler;
+}
+
+bool TaskScheduler::popOrSteal(int index, Task& task) {
+    // Own queue first, newest task (still warm in cache)
+    {
+        WorkerQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Then steal the oldest task from a victim, which tends to be the largest
+    int count = queues.size();
+    for (int i = 1; i < count; i++) {
+        WorkerQueue& victim = *queues[(index + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::runTask(const Task& task) {
+    (*task.job->body)(task.begin, task.end);
+    task.job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskScheduler::workerLoop(int index) {
+    Task task;
+    while (true) {
+        if (popOrSteal(index, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || pendingTasks.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+void TaskScheduler::parallelFor(int begin, int end, int grain,
+                                const std::function<void(int, int)>& body) {
+    int count = end - begin;
+    if (count <= 0) return;
+
+    grain = std::max(1, grain);
+    int taskCount = (count + grain - 1) / grain;
+    if (taskCount == 1 || queues.size() == 1) {
+        body(begin, end);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.remaining.store(taskCount);
+
+    // Deal tasks round-robin so every worker starts with local work
+    int queueCount = queues.size();
+    for (int t = 0; t < taskCount; t++) {
+        int taskBegin = begin + t * grain;
+        Task task{&job, taskBegin, std::min(end, taskBegin + grain)};
+        WorkerQueue& queue = *queues[t % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks.fetch_add(taskCount);
+    }
+    wake.notify_all();
+
+    // Help out until our job is done; this may run other jobs' tasks too
+    int callerQueue = queueCount - 1;
+    Task task;
+    while (job.remaining.load(std::memory_order_acquire) > 0) {
+        if (popOrSteal(callerQueue, task)) {
+            runTask(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
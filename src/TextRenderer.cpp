@@ -0,0 +1,239 @@
+#include "TextRenderer.h"
+#include "RenderStats.h"
+#include "Log.h"
+#include <algorithm>
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer)
+    : renderer(renderer)
+    , useCounter(0)
+    , cacheHits(0)
+    , cacheMisses(0)
+{
+    cache.resize(CACHE_SIZE);
+    for (CachedText& entry : cache) {
+        entry.text.reserve(CACHE_TEXT_CAPACITY);
+        entry.quads.reserve(CACHE_TEXT_CAPACITY * 4);
+    }
+}
+
+TextRenderer::~TextRenderer() {
+    for (auto& pair : atlases) {
+        if (pair.second.texture) {
+            SDL_DestroyTexture(pair.second.texture);
+        }
+        if (pair.second.font) {
+            TTF_CloseFont(pair.second.font);
+        }
+    }
+    atlases.clear();
+}
+
+bool TextRenderer::init() {
+    if (TTF_Init() == -1) {
+        LOG_ERROR("TTF_Init failed: {}", TTF_GetError());
+        return false;
+    }
+    return true;
+}
+
+TextRenderer::GlyphAtlas* TextRenderer::getAtlas(int size) {
+    auto it = atlases.find(size);
+    if (it == atlases.end()) {
+        it = atlases.emplace(size, GlyphAtlas()).first;
+        if (!buildAtlas(it->second, size)) {
+            LOG_ERROR("Failed to build glyph atlas for size {}", size);
+        }
+    }
+    return it->second.texture ? &it->second : nullptr;
+}
+
+bool TextRenderer::buildAtlas(GlyphAtlas& atlas, int size) {
+    // Try to load a system font
+    const char* fontPaths[] = {
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+        "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf",
+        "/System/Library/Fonts/Helvetica.ttc",
+        "/usr/share/fonts/TTF/DejaVuSans.ttf"
+    };
+
+    for (const char* path : fontPaths) {
+        atlas.font = TTF_OpenFont(path, size);
+        if (atlas.font) {
+            break;
+        }
+    }
+    if (!atlas.font) {
+        LOG_ERROR("Failed to load font: {}", TTF_GetError());
+        return false;
+    }
+    atlas.lineHeight = TTF_FontHeight(atlas.font);
+
+    // Render every glyph in white - vertex colors tint them at draw time
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* rendered[GLYPH_COUNT];
+    SDL_Rect cells[GLYPH_COUNT];
+    int penX = 0;
+    int penY = 0;
+    int rowHeight = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        Uint16 c = (Uint16)(FIRST_GLYPH + i);
+        rendered[i] = TTF_RenderGlyph_Blended(atlas.font, c, white);
+
+        int minX, maxX, minY, maxY, advance = 0;
+        TTF_GlyphMetrics(atlas.font, c, &minX, &maxX, &minY, &maxY, &advance);
+        atlas.glyphs[i].advance = advance;
+
+        int w = rendered[i] ? rendered[i]->w : 0;
+        int h = rendered[i] ? rendered[i]->h : 0;
+        if (penX + w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        // One pixel gutter keeps linear filtering from bleeding neighbours in
+        cells[i] = {penX, penY, w, h};
+        penX += w + 1;
+        rowHeight = std::max(rowHeight, h);
+    }
+    int atlasHeight = std::max(penY + rowHeight, 1);
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, atlasHeight, 32,
+                                                          SDL_PIXELFORMAT_RGBA32);
+    bool ok = surface != nullptr;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        if (!rendered[i]) continue;
+        if (ok) {
+            // Copy alpha as-is instead of blending onto the empty atlas
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], nullptr, surface, &cells[i]);
+        }
+        SDL_FreeSurface(rendered[i]);
+    }
+
+    if (ok) {
+        atlas.texture = SDL_CreateTextureFromSurface(renderer, surface);
+        RenderStats::global().bytesUploaded += (uint64_t)surface->pitch * surface->h;
+        SDL_FreeSurface(surface);
+        ok = atlas.texture != nullptr;
+    }
+    if (!ok) {
+        LOG_ERROR("Failed to create glyph atlas: {}", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        Glyph& glyph = atlas.glyphs[i];
+        glyph.width = cells[i].w;
+        glyph.height = cells[i].h;
+        glyph.u0 = (float)cells[i].x / ATLAS_WIDTH;
+        glyph.v0 = (float)cells[i].y / atlasHeight;
+        glyph.u1 = (float)(cells[i].x + cells[i].w) / ATLAS_WIDTH;
+        glyph.v1 = (float)(cells[i].y + cells[i].h) / atlasHeight;
+    }
+    return true;
+}
+
+const TextRenderer::Glyph& TextRenderer::glyphFor(const GlyphAtlas& atlas, char c) const {
+    int index = (unsigned char)c - FIRST_GLYPH;
+    if (index < 0 || index >= GLYPH_COUNT) {
+        index = '?' - FIRST_GLYPH;
+    }
+    return atlas.glyphs[index];
+}
+
+TextRenderer::CachedText& TextRenderer::layout(GlyphAtlas* atlas, const std::string& text) {
+    // FNV-1a over the text, seeded by the atlas it was laid out with
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)(uintptr_t)atlas;
+    for (char c : text) {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+    }
+
+    useCounter++;
+    CachedText* oldest = &cache[0];
+    for (CachedText& entry : cache) {
+        if (entry.atlas == atlas && entry.hash == hash && entry.text == text) {
+            entry.lastUsed = useCounter;
+            cacheHits++;
+            return entry;
+        }
+        if (entry.lastUsed < oldest->lastUsed) {
+            oldest = &entry;
+        }
+    }
+
+    // Miss: lay the string out again in place of the least recently used
+    cacheMisses++;
+    CachedText& entry = *oldest;
+    entry.atlas = atlas;
+    entry.hash = hash;
+    entry.text = text;
+    entry.lastUsed = useCounter;
+    entry.quads.clear();
+
+    SDL_Color white = {255, 255, 255, 255};
+    int penX = 0;
+    for (char c : text) {
+        const Glyph& glyph = glyphFor(*atlas, c);
+        if (glyph.width > 0) {
+            float x0 = (float)penX;
+            float x1 = (float)(penX + glyph.width);
+            float y1 = (float)glyph.height;
+            entry.quads.push_back({{x0, 0.0f}, white, {glyph.u0, glyph.v0}});
+            entry.quads.push_back({{x1, 0.0f}, white, {glyph.u1, glyph.v0}});
+            entry.quads.push_back({{x0, y1}, white, {glyph.u0, glyph.v1}});
+            entry.quads.push_back({{x1, y1}, white, {glyph.u1, glyph.v1}});
+        }
+        penX += glyph.advance;
+    }
+    entry.width = penX;
+    return entry;
+}
+
+bool TextRenderer::draw(const std::string& text, int x, int y, int size, SDL_Color color) {
+    GlyphAtlas* atlas = getAtlas(size);
+    if (!atlas) return false;
+    if (text.empty()) return true;
+
+    const CachedText& laidOut = layout(atlas, text);
+    float offsetX = (float)x;
+    float offsetY = (float)y;
+    for (const SDL_Vertex& vertex : laidOut.quads) {
+        SDL_Vertex placed = vertex;
+        placed.position.x += offsetX;
+        placed.position.y += offsetY;
+        placed.color = color;
+        atlas->batch.push_back(placed);
+    }
+    return true;
+}
+
+bool TextRenderer::measure(const std::string& text, int size, int& width, int& height) {
+    GlyphAtlas* atlas = getAtlas(size);
+    if (!atlas) return false;
+
+    width = text.empty() ? 0 : layout(atlas, text).width;
+    height = atlas->lineHeight;
+    return true;
+}
+
+void TextRenderer::flush() {
+    for (auto& pair : atlases) {
+        GlyphAtlas& atlas = pair.second;
+        if (atlas.batch.empty()) continue;
+
+        size_t quadCount = atlas.batch.size() / 4;
+        while (quadIndices.size() < quadCount * 6) {
+            int base = (int)(quadIndices.size() / 6) * 4;
+            const int pattern[6] = {0, 1, 2, 2, 1, 3};
+            for (int offset : pattern) {
+                quadIndices.push_back(base + offset);
+            }
+        }
+
+        SDL_RenderGeometry(renderer, atlas.texture, atlas.batch.data(), (int)atlas.batch.size(),
+                           quadIndices.data(), (int)(quadCount * 6));
+        RenderStats::global().drawCalls++;
+        atlas.batch.clear();
+    }
+}
@@ -0,0 +1,205 @@
+#include "Timetable.h"
+#include "TrainLine.h"
+#include "Train.h"
+#include <algorithm>
+#include <cmath>
+
+Timetable::Timetable()
+    : headwaysStale(false)
+{}
+
+void Timetable::compile(const std::vector<TrainLine>& lines,
+                        const std::vector<Train>& trains,
+                        double simTime) {
+    // Schedules are indexed by line id, which can have gaps where lines
+    // were removed
+    size_t lineSlots = 0;
+    for (const auto& line : lines) {
+        lineSlots = std::max(lineSlots, (size_t)line.getId() + 1);
+    }
+    lineSchedules.assign(lineSlots, LineSchedule{0.0, 0});
+    std::vector<int> linePositions(lineSlots, -1);
+    for (size_t i = 0; i < lines.size(); i++) {
+        int lineId = lines[i].getId();
+        lineSchedules[lineId].legTime = lines[i].getLength() / Train::getDefaultSpeed() * 3600.0;
+        linePositions[lineId] = (int)i;
+    }
+    // Ids can outnumber trains once trains have been removed
+    size_t slotCount = trainSlots.size();
+    for (const auto& train : trains) {
+        slotCount = std::max(slotCount, (size_t)train.getId() + 1);
+    }
+    trainSlots.resize(slotCount, TrainSlot{-1, -1, -1, 0.0, 0.0, false});
+
+    // Trains grouped by line; waiting is a train not yet out of station1
+    std::vector<std::vector<int>> running(lineSlots);
+    std::vector<std::vector<int>> waiting(lineSlots);
+    for (const auto& train : trains) {
+        int lineId = train.getLineId();
+        if (lineId < 0 || lineId >= (int)lineSlots || linePositions[lineId] < 0) continue;
+
+        const TrainLine& line = lines[linePositions[lineId]];
+        TrainSlot& slot = trainSlots[train.getId()];
+
+        // Keep the epoch of trains that are already running so recompiling
+        // never teleports them
+        bool fresh = !slot.scheduled || slot.lineId != lineId;
+        slot.lineId = lineId;
+        slot.station1Id = line.getStation1();
+        slot.station2Id = line.getStation2();
+        slot.legTime = train.getSpeed() > 0 ? line.getLength() / train.getSpeed() * 3600.0 : 0.0;
+        slot.scheduled = true;
+        if (fresh || slot.epoch > simTime) {
+            waiting[lineId].push_back(train.getId());
+        } else {
+            running[lineId].push_back(train.getId());
+        }
+
+        LineSchedule& schedule = lineSchedules[lineId];
+        schedule.legTime = slot.legTime;
+        schedule.trainCount++;
+    }
+
+    for (size_t lineId = 0; lineId < lineSlots; lineId++) {
+        spaceDepartures(lineId, running[lineId], waiting[lineId], simTime);
+    }
+    headwaysStale = true;
+}
+
+void Timetable::spaceDepartures(int lineId, const std::vector<int>& running,
+                                std::vector<int>& waiting, double simTime) {
+    const LineSchedule& schedule = lineSchedules[lineId];
+    double period = 2.0 * schedule.legTime;
+    if (schedule.trainCount == 0 || period <= 0.0) {
+        for (int trainId : waiting) {
+            trainSlots[trainId].epoch = simTime;
+        }
+        return;
+    }
+
+    // Waiting trains leave station1 one even headway after another,
+    // following the last running train out, so trains added together
+    // don't run as a bunch. Id order keeps this independent of how the
+    // train array happens to be laid out.
+    double spacing = period / schedule.trainCount;
+    double lastDeparture = simTime - spacing; // with none running, the first leaves now
+    for (size_t i = 0; i < running.size(); i++) {
+        double epoch = trainSlots[running[i]].epoch;
+        double departure = epoch + std::floor((simTime - epoch) / period) * period;
+        lastDeparture = i == 0 ? departure : std::max(lastDeparture, departure);
+    }
+    std::sort(waiting.begin(), waiting.end());
+    double departure = std::max(simTime, lastDeparture + spacing);
+    for (int trainId : waiting) {
+        trainSlots[trainId].epoch = departure;
+        departure += spacing;
+    }
+}
+
+void Timetable::computeHeadways() const {
+    // The headway a rider sees: arriving at random, they land in a gap
+    // with odds proportional to its length, so bunched trains give a
+    // longer headway than the same trains evenly spaced
+    std::vector<std::vector<double>> phases(lineSchedules.size());
+    for (const TrainSlot& slot : trainSlots) {
+        if (!slot.scheduled) continue;
+        double period = 2.0 * lineSchedules[slot.lineId].legTime;
+        if (period <= 0.0) continue;
+        double phase = std::fmod(slot.epoch, period);
+        phases[slot.lineId].push_back(phase < 0.0 ? phase + period : phase);
+    }
+
+    headways.assign(lineSchedules.size(), 0.0);
+    for (size_t lineId = 0; lineId < lineSchedules.size(); lineId++) {
+        std::vector<double>& line = phases[lineId];
+        double period = 2.0 * lineSchedules[lineId].legTime;
+        if (line.empty()) {
+            headways[lineId] = period;
+            continue;
+        }
+        std::sort(line.begin(), line.end());
+        double weighted = 0.0;
+        for (size_t i = 0; i < line.size(); i++) {
+            double gap = i + 1 < line.size() ? line[i + 1] - line[i] : line[0] + period - line[i];
+            weighted += gap * gap;
+        }
+        headways[lineId] = weighted / period;
+    }
+    headwaysStale = false;
+}
+
+void Timetable::clear() {
+    lineSchedules.clear();
+    trainSlots.clear();
+    headways.clear();
+    headwaysStale = false;
+}
+
+bool Timetable::hasTrain(int trainId) const {
+    return trainId >= 0 && trainId < (int)trainSlots.size() && trainSlots[trainId].scheduled;
+}
+
+void Timetable::removeTrain(int trainId) {
+    if (hasTrain(trainId)) {
+        trainSlots[trainId].scheduled = false;
+        headwaysStale = true;
+    }
+}
+
+double Timetable::getEpoch(int trainId) const {
+    return hasTrain(trainId) ? trainSlots[trainId].epoch : 0.0;
+}
+
+void Timetable::setEpoch(int trainId, double epoch) {
+    if (hasTrain(trainId)) {
+        trainSlots[trainId].epoch = epoch;
+        headwaysStale = true;
+    }
+}
+
+TrainState Timetable::getTrainState(int trainId, double simTime) const {
+    TrainState state{0.0, true, -1, 0.0, 0};
+    if (!hasTrain(trainId)) return state;
+
+    const TrainSlot& slot = trainSlots[trainId];
+    state.nextStationId = slot.station2Id;
+
+    double elapsed = std::max(0.0, simTime - slot.epoch);
+    if (slot.legTime <= 0.0) {
+        state.nextArrivalTime = simTime;
+        return state;
+    }
+
+    // Triangle wave: even legs run station1 -> station2, odd legs run back
+    double legs = elapsed / slot.legTime;
+    long leg = (long)std::floor(legs);
+    double t = legs - leg;
+
+    state.legIndex = leg;
+    state.movingForward = (leg % 2) == 0;
+    state.position = state.movingForward ? t : 1.0 - t;
+    state.nextStationId = state.movingForward ? slot.station2Id : slot.station1Id;
+    state.nextArrivalTime = slot.epoch + (leg + 1) * slot.legTime;
+
+    return state;
+}
+
+double Timetable::getLegTime(int lineId) const {
+    if (lineId < 0 || lineId >= (int)lineSchedules.size()) return 0.0;
+    return lineSchedules[lineId].legTime;
+}
+
+double Timetable::getPeriod(int lineId) const {
+    return 2.0 * getLegTime(lineId);
+}
+
+double Timetable::getHeadway(int lineId) const {
+    if (getTrainCount(lineId) == 0) return 0.0;
+    if (headwaysStale) computeHeadways();
+    return headways[lineId];
+}
+
+int Timetable::getTrainCount(int lineId) const {
+    if (lineId < 0 || lineId >= (int)lineSchedules.size()) return 0;
+    return lineSchedules[lineId].trainCount;
+}
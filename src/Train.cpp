@@ -4,46 +4,28 @@
 Train::Train(int id, int lineId, int capacity)
     : id(id)
     , lineId(lineId)
-    , position(0.0)
-    , movingForward(true)
+    , linePosition(-1)
     , capacity(capacity)
-    , passengerCount(0)
+    , lastLeg(-1)
     , speed(DEFAULT_SPEED)
 {}
 
-void Train::update(float deltaTime, double lineLength) {
-    if (lineLength <= 0) return;
-
-    // Convert speed (km/h) to position change per second
-    double distancePerSecond = speed / 3600.0; // km per second
-    double positionChangePerSecond = distancePerSecond / lineLength;
-
-    double positionChange = positionChangePerSecond * deltaTime;
-
-    if (movingForward) {
-        position += positionChange;
-        if (position >= 1.0) {
-            position = 1.0;
-            reverse();
-        }
-    } else {
-        position -= positionChange;
-        if (position <= 0.0) {
-            position = 0.0;
-            reverse();
-        }
-    }
+int Train::boardPassengers(CohortArena& arena, CohortPool& platform,
+                           const std::function<bool(const PassengerCohort&)>& wantsToBoard) {
+    int available = capacity - onboard.getCount();
+    if (available <= 0) return 0;
+    return platform.transfer(arena, onboard, available, wantsToBoard);
 }
 
-void Train::reverse() {
-    movingForward = !movingForward;
-}
-
-void Train::boardPassengers(int count) {
-    int available = capacity - passengerCount;
-    passengerCount += std::min(count, available);
-}
-
-void Train::disembarkPassengers(int count) {
-    passengerCount = std::max(0, passengerCount - count);
+void Train::disembarkPassengers(CohortArena& arena, int stationId, CohortPool& platform,
+                                std::vector<CompletedTrip>& completed) {
+    // Lines are two-station shuttles, so nobody's fastest route stays aboard:
+    // riders either finish here or transfer on the platform
+    onboard.drain(arena, [&](const PassengerCohort& cohort) {
+        if (cohort.destination == stationId) {
+            completed.push_back({cohort.origin, cohort.destination, cohort.count, cohort.spawnTime, id});
+        } else {
+            platform.add(arena, cohort.origin, cohort.destination, cohort.count, cohort.spawnTime);
+        }
+    });
 }
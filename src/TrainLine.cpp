@@ -7,23 +7,17 @@ TrainLine::TrainLine(int id, int station1Id, int station2Id)
     , length(0.0)
 {}
 
-int TrainLine::getBuildCost() const {
-    return (int)(length * COST_PER_KM);
-}
-
-int TrainLine::getMaintenanceCost() const {
-    return (int)(length * MAINTENANCE_PER_KM);
-}
-
-void TrainLine::addTrain(int trainId) {
+int TrainLine::addTrain(int trainId) {
     trains.push_back(trainId);
+    return (int)trains.size() - 1;
 }
 
-void TrainLine::removeTrain(int trainId) {
-    for (auto it = trains.begin(); it != trains.end(); ++it) {
-        if (*it == trainId) {
-            trains.erase(it);
-            break;
-        }
+int TrainLine::removeTrainAt(int position) {
+    int moved = -1;
+    if (position != (int)trains.size() - 1) {
+        moved = trains.back();
+        trains[position] = moved;
     }
+    trains.pop_back();
+    return moved;
 }
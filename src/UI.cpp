@@ -1,62 +1,115 @@
 #include "UI.h"
+#include "RenderStats.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <algorithm>
-#include <iostream>
+#include <cstdio>
 
 UIRenderer::UIRenderer(SDL_Renderer* renderer)
     : renderer(renderer)
-{}
+    , text(renderer)
+    , panelRedraws(0)
+{
+    lineScratch.reserve(64);
+}
 
 UIRenderer::~UIRenderer() {
-    // Clean up fonts
-    for (auto& pair : fonts) {
-        if (pair.second) {
-            TTF_CloseFont(pair.second);
-        }
-    }
-    fonts.clear();
+    destroyPanel(mainMenuPanel);
+    destroyPanel(countrySelectPanel);
+    destroyPanel(infoPanel);
 }
 
 bool UIRenderer::init() {
-    if (TTF_Init() == -1) {
-        std::cerr << "TTF_Init failed: " << TTF_GetError() << std::endl;
-        return false;
+    return text.init();
+}
+
+// FNV-1a step over one panel input
+static uint64_t hashInput(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ull;
     }
-    return true;
+    return hash;
 }
 
-TTF_Font* UIRenderer::getFont(int size) {
-    // Check if we already have this font size loaded
-    auto it = fonts.find(size);
-    if (it != fonts.end()) {
-        return it->second;
+static uint64_t hashButtons(uint64_t hash, const std::vector<Button>& buttons) {
+    for (const auto& button : buttons) {
+        hash = hashInput(hash, ((uint64_t)(uint32_t)button.x << 32) | (uint32_t)button.y);
+        hash = hashInput(hash, (button.isHovered ? 1 : 0) | (button.isEnabled ? 2 : 0));
+        hash = hashInput(hash, std::hash<std::string>()(button.text));
     }
+    return hash;
+}
 
-    // Try to load a system font
-    const char* fontPaths[] = {
-        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
-        "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf",
-        "/System/Library/Fonts/Helvetica.ttc",
-        "/usr/share/fonts/TTF/DejaVuSans.ttf"
+struct PanelMetrics {
+    MetricCounter& redraws;
+    MetricCounter& reuses;
+};
+
+static PanelMetrics& panelMetrics() {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    static PanelMetrics metrics = {
+        registry.counter("trainbuilder_ui_panel_redraws_total", "UI panels drawn again because their contents changed"),
+        registry.counter("trainbuilder_ui_panel_reuses_total", "UI panels composited unchanged from their texture"),
     };
+    return metrics;
+}
 
-    TTF_Font* font = nullptr;
-    for (const char* path : fontPaths) {
-        font = TTF_OpenFont(path, size);
-        if (font) {
-            break;
+bool UIRenderer::beginPanel(RetainedPanel& panel, int width, int height, uint64_t inputHash) {
+    if (!SDL_RenderTargetSupported(renderer)) {
+        return true;
+    }
+
+    if (!panel.texture) {
+        panel.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!panel.texture) {
+            LOG_ERROR("Failed to create panel texture: {}", SDL_GetError());
+            return true;
         }
+        SDL_SetTextureBlendMode(panel.texture, SDL_BLENDMODE_BLEND);
+    }
+    if (panel.valid && panel.inputHash == inputHash) {
+        panelMetrics().reuses.add();
+        return false;
     }
 
-    if (!font) {
-        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        return nullptr;
+    panel.inputHash = inputHash;
+    panelRedraws++;
+    panelMetrics().redraws.add();
+    SDL_SetRenderTarget(renderer, panel.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    RenderStats::global().drawCalls++;
+    return true;
+}
+
+void UIRenderer::endPanel(RetainedPanel& panel) {
+    text.flush();
+    if (panel.texture) {
+        SDL_SetRenderTarget(renderer, nullptr);
+        panel.valid = true;
     }
+}
+
+void UIRenderer::compositePanel(const RetainedPanel& panel, int width, int height) {
+    if (!panel.valid) return;
+    SDL_Rect dstRect = {0, 0, width, height};
+    SDL_RenderCopy(renderer, panel.texture, nullptr, &dstRect);
+    RenderStats::global().drawCalls++;
+}
 
-    fonts[size] = font;
-    return font;
+void UIRenderer::destroyPanel(RetainedPanel& panel) {
+    if (panel.texture) {
+        SDL_DestroyTexture(panel.texture);
+        panel.texture = nullptr;
+    }
+    panel.valid = false;
 }
 
 void UIRenderer::drawRect(int x, int y, int w, int h, SDL_Color color, bool filled) {
+    // Queued text must stay on top of what was drawn before it
+    text.flush();
+
     SDL_Rect rect = {x, y, w, h};
     SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
     if (filled) {
@@ -64,17 +117,17 @@ void UIRenderer::drawRect(int x, int y, int w, int h, SDL_Color color, bool fill
     } else {
         SDL_RenderDrawRect(renderer, &rect);
     }
+    RenderStats::global().drawCalls++;
 }
 
-void UIRenderer::drawText(const std::string& text, int x, int y, int size, SDL_Color color) {
-    if (text.empty()) return;
+void UIRenderer::drawText(const std::string& str, int x, int y, int size, SDL_Color color) {
+    if (str.empty()) return;
 
-    TTF_Font* font = getFont(size);
-    if (!font) {
+    if (!text.draw(str, x, y, size, color)) {
         // Fallback to rectangle rendering if font loading failed
         int charWidth = size / 2;
         int charHeight = size;
-        for (size_t i = 0; i < text.length(); i++) {
+        for (size_t i = 0; i < str.length(); i++) {
             SDL_Rect charRect = {
                 x + (int)(i * charWidth),
                 y,
@@ -84,27 +137,7 @@ void UIRenderer::drawText(const std::string& text, int x, int y, int size, SDL_C
             SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
             SDL_RenderDrawRect(renderer, &charRect);
         }
-        return;
-    }
-
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), color);
-    if (!surface) {
-        std::cerr << "Failed to render text: " << TTF_GetError() << std::endl;
-        return;
-    }
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        std::cerr << "Failed to create texture: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(surface);
-        return;
     }
-
-    SDL_Rect dstRect = {x, y, surface->w, surface->h};
-    SDL_RenderCopy(renderer, texture, nullptr, &dstRect);
-
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
 }
 
 void UIRenderer::renderButton(const Button& button) {
@@ -124,12 +157,9 @@ void UIRenderer::renderButton(const Button& button) {
     drawRect(button.x, button.y, button.width, button.height, borderColor, false);
 
     // Button text (centered)
-    TTF_Font* font = getFont(20);
     int textWidth = 0;
     int textHeight = 0;
-    if (font) {
-        TTF_SizeText(font, button.text.c_str(), &textWidth, &textHeight);
-    } else {
+    if (!text.measure(button.text, 20, textWidth, textHeight)) {
         textWidth = button.text.length() * 10;
         textHeight = 20;
     }
@@ -138,51 +168,62 @@ void UIRenderer::renderButton(const Button& button) {
     drawText(button.text, textX, textY, 20, {255, 255, 255, 255});
 }
 
-void UIRenderer::renderText(const std::string& text, int x, int y, int size, SDL_Color color) {
-    drawText(text, x, y, size, color);
+void UIRenderer::renderText(const std::string& str, int x, int y, int size, SDL_Color color) {
+    drawText(str, x, y, size, color);
+    text.flush();
 }
 
 void UIRenderer::renderMainMenu(const std::vector<Button>& buttons) {
-    // Clear screen with dark background
-    SDL_SetRenderDrawColor(renderer, 30, 30, 40, 255);
-    SDL_RenderClear(renderer);
-
-    // Title
-    drawText("TRAIN BUILDER", 400, 150, 48, {255, 255, 255, 255});
-    drawText("Economic Railway Simulator", 350, 180, 20, {200, 200, 200, 255});
+    uint64_t inputHash = hashButtons(14695981039346656037ull, buttons);
+    if (beginPanel(mainMenuPanel, LAYOUT_WIDTH, LAYOUT_HEIGHT, inputHash)) {
+        // Clear screen with dark background
+        SDL_SetRenderDrawColor(renderer, 30, 30, 40, 255);
+        SDL_RenderClear(renderer);
+
+        // Title
+        drawText("TRAIN BUILDER", 400, 150, 48, {255, 255, 255, 255});
+        drawText("Economic Railway Simulator", 350, 180, 20, {200, 200, 200, 255});
+
+        // Render buttons
+        for (const auto& button : buttons) {
+            renderButton(button);
+        }
 
-    // Render buttons
-    for (const auto& button : buttons) {
-        renderButton(button);
+        // Footer
+        drawText("Use arrow keys and mouse to navigate", 350, 650, 16, {150, 150, 150, 255});
+        endPanel(mainMenuPanel);
     }
-
-    // Footer
-    drawText("Use arrow keys and mouse to navigate", 350, 650, 16, {150, 150, 150, 255});
+    compositePanel(mainMenuPanel, LAYOUT_WIDTH, LAYOUT_HEIGHT);
 }
 
 void UIRenderer::renderCountrySelect(const std::vector<Button>& buttons, int scrollOffset) {
-    // Clear screen
-    SDL_SetRenderDrawColor(renderer, 30, 30, 40, 255);
-    SDL_RenderClear(renderer);
-
-    // Title
-    drawText("SELECT A COUNTRY", 450, 50, 36, {255, 255, 255, 255});
-    drawText("Choose where to build your railway network", 320, 80, 18, {200, 200, 200, 255});
-
-    // Render country buttons (with scrolling)
-    for (const auto& button : buttons) {
-        if (button.y + button.height > 120 && button.y < 680) {
-            renderButton(button);
+    uint64_t inputHash = hashInput(hashButtons(14695981039346656037ull, buttons), scrollOffset);
+    if (beginPanel(countrySelectPanel, LAYOUT_WIDTH, LAYOUT_HEIGHT, inputHash)) {
+        // Clear screen
+        SDL_SetRenderDrawColor(renderer, 30, 30, 40, 255);
+        SDL_RenderClear(renderer);
+
+        // Title
+        drawText("SELECT A COUNTRY", 450, 50, 36, {255, 255, 255, 255});
+        drawText("Choose where to build your railway network", 320, 80, 18, {200, 200, 200, 255});
+
+        // Render country buttons (with scrolling)
+        for (const auto& button : buttons) {
+            if (button.y + button.height > 120 && button.y < 680) {
+                renderButton(button);
+            }
         }
-    }
 
-    // Scroll indicators
-    if (scrollOffset > 0) {
-        drawText("^ Scroll Up", 550, 100, 14, {150, 150, 150, 255});
-    }
-    if (buttons.size() > 10) {
-        drawText("v Scroll Down", 540, 680, 14, {150, 150, 150, 255});
+        // Scroll indicators
+        if (scrollOffset > 0) {
+            drawText("^ Scroll Up", 550, 100, 14, {150, 150, 150, 255});
+        }
+        if (buttons.size() > 10) {
+            drawText("v Scroll Down", 540, 680, 14, {150, 150, 150, 255});
+        }
+        endPanel(countrySelectPanel);
     }
+    compositePanel(countrySelectPanel, LAYOUT_WIDTH, LAYOUT_HEIGHT);
 }
 
 void UIRenderer::renderLoadingScreen(const std::string& countryName, int current, int total) {
@@ -218,27 +259,46 @@ void UIRenderer::renderLoadingScreen(const std::string& countryName, int current
 
     drawText(progressText, 560, 420, 18, {200, 200, 200, 255});
     drawText(percentText, 600, 370, 20, {255, 255, 255, 255});
+    text.flush();
 
     SDL_RenderPresent(renderer);
 }
 
-void UIRenderer::renderInfoPanel(double money, int stationCount, int lineCount) {
-    // Panel background
-    drawRect(10, 10, 250, 120, {0, 0, 0, 200}, true);
-    drawRect(10, 10, 250, 120, {100, 100, 100, 255}, false);
+void UIRenderer::renderInfoPanel(double money, int stationCount, int lineCount, bool refresh) {
+    // Only what is displayed counts - cents don't redraw the panel
+    uint64_t inputHash = 14695981039346656037ull;
+    inputHash = hashInput(inputHash, (uint64_t)(int64_t)money);
+    inputHash = hashInput(inputHash, ((uint64_t)(uint32_t)stationCount << 32) | (uint32_t)lineCount);
+
+    if (!refresh && infoPanel.valid) {
+        inputHash = infoPanel.inputHash;
+    }
 
-    // Money
-    std::string moneyStr = "Money: $" + std::to_string((int)money);
-    drawText(moneyStr, 20, 20, 18, {255, 255, 100, 255});
+    if (beginPanel(infoPanel, INFO_PANEL_WIDTH, INFO_PANEL_HEIGHT, inputHash)) {
+        // Panel background
+        drawRect(10, 10, 250, 120, {0, 0, 0, 200}, true);
+        drawRect(10, 10, 250, 120, {100, 100, 100, 255}, false);
 
-    // Stations
-    std::string stationsStr = "Stations: " + std::to_string(stationCount);
-    drawText(stationsStr, 20, 45, 16, {200, 200, 200, 255});
+        char line[64];
 
-    // Lines
-    std::string linesStr = "Lines: " + std::to_string(lineCount);
-    drawText(linesStr, 20, 70, 16, {200, 200, 200, 255});
+        // Money
+        snprintf(line, sizeof(line), "Money: $%d", (int)money);
+        lineScratch.assign(line);
+        drawText(lineScratch, 20, 20, 18, {255, 255, 100, 255});
 
-    // Controls hint
-    drawText("ESC: Menu", 20, 95, 14, {150, 150, 150, 255});
+        // Stations
+        snprintf(line, sizeof(line), "Stations: %d", stationCount);
+        lineScratch.assign(line);
+        drawText(lineScratch, 20, 45, 16, {200, 200, 200, 255});
+
+        // Lines
+        snprintf(line, sizeof(line), "Lines: %d", lineCount);
+        lineScratch.assign(line);
+        drawText(lineScratch, 20, 70, 16, {200, 200, 200, 255});
+
+        // Controls hint
+        drawText("ESC: Menu", 20, 95, 14, {150, 150, 150, 255});
+        endPanel(infoPanel);
+    }
+    compositePanel(infoPanel, INFO_PANEL_WIDTH, INFO_PANEL_HEIGHT);
 }
@@ -0,0 +1,779 @@
+#include "World.h"
+#include "Parallel.h"
+#include "Metrics.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+
+// Sim loop metrics, shared by every world in the process
+struct SimMetrics {
+    MetricCounter& ticks;
+    MetricHistogram& tickSeconds;
+    MetricCounter& passengers;
+    MetricCounter& abandoned;
+    MetricGauge& stations;
+    MetricGauge& lines;
+    MetricGauge& trains;
+    MetricGauge& simClock;
+    MetricGauge& routeCacheBytes;
+};
+
+static SimMetrics& simMetrics() {
+    MetricsRegistry& registry = MetricsRegistry::global();
+    static SimMetrics metrics = {
+        registry.counter("trainbuilder_ticks_total", "Simulation ticks run"),
+        registry.histogram("trainbuilder_tick_seconds", "Wall time of one simulation tick",
+                           MetricHistogram::exponentialBounds(0.00005, 2.0, 14)),
+        registry.counter("trainbuilder_passengers_delivered_total", "Passengers who reached their destination"),
+        registry.counter("trainbuilder_passengers_abandoned_total", "Passengers who gave up waiting for a train"),
+        registry.gauge("trainbuilder_stations", "Stations in the world"),
+        registry.gauge("trainbuilder_lines", "Lines in the world"),
+        registry.gauge("trainbuilder_trains", "Trains in the world"),
+        registry.gauge("trainbuilder_sim_clock_seconds", "Simulated time since the world began"),
+        registry.gauge("trainbuilder_route_cache_bytes", "Memory held by cached route trees"),
+    };
+    return metrics;
+}
+
+World::World(const EconomyConfig& economyConfig)
+    : economyConfig(economyConfig)
+    , economy(std::make_unique<Economy>(economyConfig))
+    , simClock(0.0)
+    , passengersDelivered(0)
+    , passengersAbandoned(0)
+    , journal(nullptr)
+    , reporting(true)
+{}
+
+void World::clear() {
+    economy = std::make_unique<Economy>(economyConfig);
+    economy->setPublishMetrics(reporting);
+    stations.clear();
+    trainLines.clear();
+    trains.clear();
+    timetable.clear();
+    demandModel.clear();
+    router.clear();
+    networkGraph.clear();
+    cohortArena.clear();
+    fareTable.clear();
+    simClock = 0.0;
+    passengersDelivered = 0;
+    passengersAbandoned = 0;
+}
+
+void World::setReporting(bool enabled) {
+    reporting = enabled;
+    economy->setPublishMetrics(enabled);
+}
+
+void World::setPopulation(const std::vector<PopulationCenter>& centers) {
+    demandModel.setPopulation(centers);
+}
+
+bool World::placeStation(double lat, double lon) {
+    if (!economy->canBuildStation()) {
+        if (reporting) LOG_INFO("Not enough money to build station!");
+        return false;
+    }
+
+    if (journal) {
+        journal->append(JournalRecordType::PLACE_STATION, simClock, {}, {lat, lon, economy->getMoney()});
+    }
+
+    int id = stations.nextIndex();
+    stations.emplace(id, lat, lon, "Station " + std::to_string(id + 1));
+    const Station& station = stations.atIndex(id);
+    economy->spendMoney(LedgerAccount::STATION, id, economy->getStationBuildCost());
+    networkGraph.appendStation(station);
+    economy->getLedger().setUpkeep(LedgerAccount::STATION, id, economy->getStationMaintenanceCost());
+    demandModel.addStation(id, lat, lon);
+    fareTable.addStation(id, lat, lon);
+    router.setStationCount(stations.slotCount());
+    if (reporting) {
+        LOG_INFO("Placed station at ({}, {})", lat, lon);
+        LOG_INFO("Money: ${}", economy->getMoney());
+    }
+    return true;
+}
+
+bool World::buildLine(int station1Id, int station2Id) {
+    if (station1Id == station2Id || !stations.containsIndex(station1Id) || !stations.containsIndex(station2Id)) {
+        return false;
+    }
+    double distance = fareTable.getDistance(station1Id, station2Id);
+    double cost = distance * economy->getLineBuildCostPerKm();
+    double moneyBefore = economy->getMoney();
+    int lineId = trainLines.nextIndex();
+    if (!economy->spendMoney(LedgerAccount::LINE, lineId, cost)) {
+        if (reporting) LOG_INFO("Not enough money!");
+        return false;
+    }
+
+    if (journal) {
+        journal->append(JournalRecordType::BUILD_LINE, simClock, {station1Id, station2Id}, {moneyBefore});
+    }
+
+    trainLines.emplace(lineId, station1Id, station2Id);
+    TrainLine& line = trainLines.atIndex(lineId);
+    line.setLength(distance);
+    stations.atIndex(station1Id).addConnectedLine(lineId);
+    stations.atIndex(station2Id).addConnectedLine(lineId);
+    economy->getLedger().setUpkeep(LedgerAccount::LINE, lineId, economy->getLineMaintenanceCost(distance));
+    compileNetwork();
+    networkGraph.addLine(line, (float)timetable.getLegTime(lineId));
+    updateLineRoute(lineId);
+    if (reporting) LOG_INFO("Built line: {} km, ${}", distance, cost);
+    return true;
+}
+
+bool World::addTrain(int lineId) {
+    int trainId = trains.nextIndex();
+    TrainHandle handle = trains.emplace(trainId, lineId, TRAIN_CAPACITY);
+    double moneyBefore = economy->getMoney();
+    if (!economy->spendMoney(LedgerAccount::TRAIN, trainId, economy->getTrainPurchaseCost())) {
+        trains.erase(handle);
+        if (reporting) LOG_INFO("Not enough money for a train!");
+        return false;
+    }
+
+    if (journal) {
+        journal->append(JournalRecordType::ADD_TRAIN, simClock, {lineId}, {moneyBefore});
+    }
+
+    trains.atIndex(trainId).setLinePosition(trainLines.atIndex(lineId).addTrain(trainId));
+    economy->getLedger().setUpkeep(LedgerAccount::TRAIN, trainId, economy->getTrainMaintenanceCost());
+    compileNetwork();
+    updateLineRoute(lineId);
+    if (reporting) LOG_INFO("Added train to line {}", lineId);
+    return true;
+}
+
+bool World::removeTrain(TrainHandle handle) {
+    const Train* train = trains.get(handle);
+    if (!train) return false;
+
+    int trainId = handle.index;
+    int lineId = train->getLineId();
+    if (journal) {
+        journal->append(JournalRecordType::REMOVE_TRAIN, simClock, {trainId}, {});
+    }
+
+    retireTrain(trainId);
+    compileNetwork();
+    updateLineRoute(lineId);
+    if (reporting) LOG_INFO("Removed train from line {}", lineId);
+    return true;
+}
+
+bool World::removeLine(LineHandle handle) {
+    if (!trainLines.contains(handle)) return false;
+
+    int lineId = handle.index;
+    if (journal) {
+        journal->append(JournalRecordType::REMOVE_LINE, simClock, {lineId}, {});
+    }
+
+    retireLine(lineId);
+    compileNetwork();
+    if (reporting) LOG_INFO("Removed line {}", lineId);
+    return true;
+}
+
+bool World::removeStation(StationHandle handle) {
+    if (!stations.contains(handle)) return false;
+
+    int stationId = handle.index;
+    if (journal) {
+        journal->append(JournalRecordType::REMOVE_STATION, simClock, {stationId}, {});
+    }
+
+    // Copied, since retiring a line edits the station's list
+    std::vector<int> connected = stations.atIndex(stationId).getConnectedLines();
+    for (int lineId : connected) {
+        retireLine(lineId);
+    }
+
+    // Riders from or to the station are lost with it, wherever they are
+    stations.atIndex(stationId).getWaiting().clear(cohortArena);
+    auto touches = [stationId](const PassengerCohort& cohort) {
+        return cohort.origin == stationId || cohort.destination == stationId;
+    };
+    for (auto& station : stations) {
+        station.getWaiting().remove(cohortArena, touches);
+    }
+    for (auto& train : trains) {
+        train.getOnboard().remove(cohortArena, touches);
+    }
+
+    demandModel.removeStation(stationId);
+    fareTable.removeStation(stationId);
+    router.removeStation(stationId);
+    economy->getLedger().setUpkeep(LedgerAccount::STATION, stationId, 0.0);
+    networkGraph.removeStation(stationId);
+    stations.erase(handle);
+    compileNetwork();
+    if (reporting) LOG_INFO("Removed station {}", stationId);
+    return true;
+}
+
+void World::retireTrain(int trainId) {
+    Train& train = trains.atIndex(trainId);
+    train.getOnboard().clear(cohortArena);
+    int moved = trainLines.atIndex(train.getLineId()).removeTrainAt(train.getLinePosition());
+    if (moved >= 0) {
+        trains.atIndex(moved).setLinePosition(train.getLinePosition());
+    }
+    economy->getLedger().setUpkeep(LedgerAccount::TRAIN, trainId, 0.0);
+    timetable.removeTrain(trainId);
+    trains.erase(trains.handleAt(trainId));
+}
+
+void World::retireLine(int lineId) {
+    const TrainLine& line = trainLines.atIndex(lineId);
+    while (!line.getTrains().empty()) {
+        retireTrain(line.getTrains().back());
+    }
+    stations.atIndex(line.getStation1()).removeConnectedLine(lineId);
+    stations.atIndex(line.getStation2()).removeConnectedLine(lineId);
+    economy->getLedger().setUpkeep(LedgerAccount::LINE, lineId, 0.0);
+    router.removeLine(lineId);
+    networkGraph.removeLine(lineId);
+    trainLines.erase(trainLines.handleAt(lineId));
+}
+
+void World::reorderNetwork() {
+    networkGraph.build(stations.values(), trainLines.values(), timetable, NetworkGraph::Ordering::HILBERT);
+}
+
+void World::compileNetwork() {
+    timetable.compile(trainLines.values(), trains.values(), simClock);
+}
+
+void World::updateLineRoute(int lineId) {
+    const TrainLine& line = trainLines.atIndex(lineId);
+    router.setLine(lineId, line.getStation1(), line.getStation2(),
+                   timetable.getLegTime(lineId), timetable.getHeadway(lineId));
+}
+
+void World::applyJournalRecord(const JournalRecord& record) {
+    simClock = record.simClock;
+
+    // Commands run against the balance they originally saw, since revenue
+    // between deltas is not replayed
+    switch (record.type) {
+        case JournalRecordType::PLACE_STATION:
+            economy->restore(record.values[2], economy->getMonthlyIncome(),
+                             economy->getMonthlyExpenses(), economy->getTimeAccumulator());
+            placeStation(record.values[0], record.values[1]);
+            break;
+        case JournalRecordType::BUILD_LINE:
+            economy->restore(record.values[0], economy->getMonthlyIncome(),
+                             economy->getMonthlyExpenses(), economy->getTimeAccumulator());
+            if (stations.containsIndex(record.ids[0]) && stations.containsIndex(record.ids[1])) {
+                buildLine(record.ids[0], record.ids[1]);
+            }
+            break;
+        case JournalRecordType::ADD_TRAIN:
+            economy->restore(record.values[0], economy->getMonthlyIncome(),
+                             economy->getMonthlyExpenses(), economy->getTimeAccumulator());
+            if (trainLines.containsIndex(record.ids[0])) {
+                addTrain(record.ids[0]);
+            }
+            break;
+        case JournalRecordType::REMOVE_TRAIN:
+            removeTrain(trains.handleAt(record.ids[0]));
+            break;
+        case JournalRecordType::REMOVE_LINE:
+            removeLine(trainLines.handleAt(record.ids[0]));
+            break;
+        case JournalRecordType::REMOVE_STATION:
+            removeStation(stations.handleAt(record.ids[0]));
+            break;
+        case JournalRecordType::ECONOMY:
+            economy->restore(record.values[0], record.values[1], record.values[2], (float)record.values[3]);
+            break;
+        case JournalRecordType::CAMERA:
+        case JournalRecordType::ROTATE:
+            break;
+    }
+}
+
+bool World::writeSnapshot(const std::string& path, SnapshotWorld header) const {
+    std::vector<char> buffer;
+    writeSnapshot(header, buffer);
+    return SnapshotWriter::writeFile(path, buffer);
+}
+
+void World::writeSnapshot(SnapshotWorld header, std::vector<char>& buffer) const {
+    header.simClock = simClock;
+    std::vector<SnapshotWorld> worldRecords{header};
+
+    std::vector<SnapshotEconomy> economyRecords{{economy->getMoney(), economy->getMonthlyIncome(),
+                                                 economy->getMonthlyExpenses(),
+                                                 economy->getTimeAccumulator(), 0}};
+
+    // Every table in id order, gaps left by removals included, so a loaded
+    // world reuses the same ids
+    std::vector<SnapshotStation> stationRecords;
+    std::vector<char> names;
+    std::vector<SnapshotCohort> cohortRecords;
+    stationRecords.reserve(stations.size());
+    for (int stationId = 0; stationId < (int)stations.slotCount(); stationId++) {
+        if (!stations.containsIndex(stationId)) continue;
+        const Station& station = stations.atIndex(stationId);
+        const std::string& name = station.getName();
+        stationRecords.push_back({station.getId(), (uint32_t)names.size(), (uint32_t)name.size(), 0,
+                                  station.getLat(), station.getLon()});
+        names.insert(names.end(), name.begin(), name.end());
+        for (int slot : station.getWaiting().getSlots()) {
+            const PassengerCohort& cohort = cohortArena.get(slot);
+            cohortRecords.push_back({CohortOwner::STATION, station.getId(), cohort.origin,
+                                     cohort.destination, cohort.count, cohort.spawnTime});
+        }
+    }
+
+    std::vector<SnapshotLine> lineRecords;
+    lineRecords.reserve(trainLines.size());
+    for (int lineId = 0; lineId < (int)trainLines.slotCount(); lineId++) {
+        if (!trainLines.containsIndex(lineId)) continue;
+        const TrainLine& line = trainLines.atIndex(lineId);
+        lineRecords.push_back({line.getId(), line.getStation1(), line.getStation2(), 0, line.getLength()});
+    }
+
+    std::vector<SnapshotTrain> trainRecords;
+    trainRecords.reserve(trains.size());
+    for (int trainId = 0; trainId < (int)trains.slotCount(); trainId++) {
+        if (!trains.containsIndex(trainId)) continue;
+        const Train& train = trains.atIndex(trainId);
+        trainRecords.push_back({train.getId(), train.getLineId(), train.getCapacity(), 0,
+                                (int64_t)train.getLastLeg(), timetable.getEpoch(train.getId())});
+        for (int slot : train.getOnboard().getSlots()) {
+            const PassengerCohort& cohort = cohortArena.get(slot);
+            cohortRecords.push_back({CohortOwner::TRAIN, train.getId(), cohort.origin,
+                                     cohort.destination, cohort.count, cohort.spawnTime});
+        }
+    }
+
+    std::vector<SnapshotPopulation> populationRecords;
+    for (const auto& center : demandModel.getPopulation()) {
+        populationRecords.push_back({center.lat, center.lon, center.radius, center.population, 0});
+    }
+
+    std::vector<SnapshotDemand> demandRecords;
+    std::vector<SnapshotDemandEntry> demandEntries;
+    demandRecords.reserve(stationRecords.size());
+    for (const SnapshotStation& station : stationRecords) {
+        int stationId = station.id;
+        const std::vector<DemandEntry>& row = demandModel.getDemandFrom(stationId);
+        demandRecords.push_back({stationId, (uint32_t)demandEntries.size(), (uint32_t)row.size(), 0,
+                                 demandModel.getCatchment(stationId), demandModel.getTripRate(stationId),
+                                 demandModel.getSpawnAccumulator(stationId)});
+        for (const DemandEntry& entry : row) {
+            demandEntries.push_back({entry.destination, entry.rate, entry.pending});
+        }
+    }
+
+    SnapshotWriter writer;
+    writer.addSection(SnapshotSection::WORLD, worldRecords);
+    writer.addSection(SnapshotSection::ECONOMY, economyRecords);
+    writer.addSection(SnapshotSection::STATIONS, stationRecords);
+    writer.addSection(SnapshotSection::STATION_NAMES, names);
+    writer.addSection(SnapshotSection::LINES, lineRecords);
+    writer.addSection(SnapshotSection::TRAINS, trainRecords);
+    writer.addSection(SnapshotSection::COHORTS, cohortRecords);
+    writer.addSection(SnapshotSection::POPULATION, populationRecords);
+    writer.addSection(SnapshotSection::DEMAND, demandRecords);
+    writer.addSection(SnapshotSection::DEMAND_ENTRIES, demandEntries);
+    writer.write(buffer);
+}
+
+bool World::validateSnapshot(const SnapshotReader& reader) {
+    auto world = reader.getSection<SnapshotWorld>(SnapshotSection::WORLD);
+    auto economyState = reader.getSection<SnapshotEconomy>(SnapshotSection::ECONOMY);
+    auto stationRecords = reader.getSection<SnapshotStation>(SnapshotSection::STATIONS);
+    auto names = reader.getSection<char>(SnapshotSection::STATION_NAMES);
+    auto lineRecords = reader.getSection<SnapshotLine>(SnapshotSection::LINES);
+    auto trainRecords = reader.getSection<SnapshotTrain>(SnapshotSection::TRAINS);
+    auto cohortRecords = reader.getSection<SnapshotCohort>(SnapshotSection::COHORTS);
+    auto demandRecords = reader.getSection<SnapshotDemand>(SnapshotSection::DEMAND);
+    auto demandEntries = reader.getSection<SnapshotDemandEntry>(SnapshotSection::DEMAND_ENTRIES);
+
+    if (world.empty() || economyState.empty()) {
+        LOG_ERROR("Saved game is missing its world state");
+        return false;
+    }
+
+    // Ids ascend but may have gaps where things were removed, so existence
+    // is a binary search over the record ids
+    auto exists = [](const auto& records, int id) {
+        size_t low = 0;
+        size_t high = records.size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (records[mid].id < id) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low < records.size() && records[low].id == id;
+    };
+    for (size_t i = 0; i < stationRecords.size(); i++) {
+        const SnapshotStation& record = stationRecords[i];
+        if (record.id < (i == 0 ? 0 : stationRecords[i - 1].id + 1) ||
+            (size_t)record.nameOffset + record.nameLength > names.size()) {
+            LOG_ERROR("Saved game has a corrupt station table");
+            return false;
+        }
+    }
+    for (size_t i = 0; i < lineRecords.size(); i++) {
+        const SnapshotLine& record = lineRecords[i];
+        if (record.id < (i == 0 ? 0 : lineRecords[i - 1].id + 1) ||
+            !exists(stationRecords, record.station1Id) || !exists(stationRecords, record.station2Id)) {
+            LOG_ERROR("Saved game has a corrupt line table");
+            return false;
+        }
+    }
+    for (size_t i = 0; i < trainRecords.size(); i++) {
+        const SnapshotTrain& record = trainRecords[i];
+        if (record.id < (i == 0 ? 0 : trainRecords[i - 1].id + 1) ||
+            !exists(lineRecords, record.lineId)) {
+            LOG_ERROR("Saved game has a corrupt train table");
+            return false;
+        }
+    }
+    for (size_t i = 0; i < cohortRecords.size(); i++) {
+        const SnapshotCohort& record = cohortRecords[i];
+        bool ownerExists = record.owner == CohortOwner::STATION
+            ? exists(stationRecords, record.ownerId)
+            : exists(trainRecords, record.ownerId);
+        if (!ownerExists || !exists(stationRecords, record.origin) ||
+            !exists(stationRecords, record.destination)) {
+            LOG_ERROR("Saved game has a corrupt passenger table");
+            return false;
+        }
+    }
+    // Saves without demand sections rebuild the matrix on load
+    if (!demandRecords.empty() && demandRecords.size() != stationRecords.size()) {
+        LOG_ERROR("Saved game has a corrupt demand table");
+        return false;
+    }
+    for (size_t i = 0; i < demandRecords.size(); i++) {
+        const SnapshotDemand& record = demandRecords[i];
+        if (record.stationId != stationRecords[i].id ||
+            (size_t)record.entryOffset + record.entryCount > demandEntries.size()) {
+            LOG_ERROR("Saved game has a corrupt demand table");
+            return false;
+        }
+    }
+    for (size_t i = 0; i < demandEntries.size(); i++) {
+        if (!exists(stationRecords, demandEntries[i].destination)) {
+            LOG_ERROR("Saved game has a corrupt demand table");
+            return false;
+        }
+    }
+    return true;
+}
+
+void World::loadSnapshot(const SnapshotReader& reader) {
+    auto world = reader.getSection<SnapshotWorld>(SnapshotSection::WORLD);
+    auto economyState = reader.getSection<SnapshotEconomy>(SnapshotSection::ECONOMY);
+    auto stationRecords = reader.getSection<SnapshotStation>(SnapshotSection::STATIONS);
+    auto names = reader.getSection<char>(SnapshotSection::STATION_NAMES);
+    auto lineRecords = reader.getSection<SnapshotLine>(SnapshotSection::LINES);
+    auto trainRecords = reader.getSection<SnapshotTrain>(SnapshotSection::TRAINS);
+    auto cohortRecords = reader.getSection<SnapshotCohort>(SnapshotSection::COHORTS);
+    auto populationRecords = reader.getSection<SnapshotPopulation>(SnapshotSection::POPULATION);
+    auto demandRecords = reader.getSection<SnapshotDemand>(SnapshotSection::DEMAND);
+    auto demandEntries = reader.getSection<SnapshotDemandEntry>(SnapshotSection::DEMAND_ENTRIES);
+
+    clear();
+    simClock = world[0].simClock;
+    economy->restore(economyState[0].money, economyState[0].monthlyIncome,
+                     economyState[0].monthlyExpenses, economyState[0].timeAccumulator);
+
+    std::vector<PopulationCenter> centers;
+    centers.reserve(populationRecords.size());
+    for (size_t i = 0; i < populationRecords.size(); i++) {
+        const SnapshotPopulation& record = populationRecords[i];
+        centers.push_back({record.lat, record.lon, record.radius, record.population});
+    }
+    demandModel.setPopulation(centers);
+
+    int stationCount = stationRecords.size();
+    int lineCount = lineRecords.size();
+    int trainCount = trainRecords.size();
+
+    Ledger& ledger = economy->getLedger();
+    stations.reserve(stationCount);
+    for (int i = 0; i < stationCount; i++) {
+        const SnapshotStation& record = stationRecords[i];
+        stations.emplaceAt(record.id, record.id, record.lat, record.lon,
+                           std::string(&names[record.nameOffset], record.nameLength));
+        ledger.setUpkeep(LedgerAccount::STATION, record.id, economy->getStationMaintenanceCost());
+    }
+    int stationSlots = stations.slotCount();
+    std::vector<double> lats(stationSlots);
+    std::vector<double> lons(stationSlots);
+    for (int i = 0; i < stationCount; i++) {
+        lats[stationRecords[i].id] = stationRecords[i].lat;
+        lons[stationRecords[i].id] = stationRecords[i].lon;
+    }
+    fareTable.setStations(lats, lons);
+    router.setStationCount(stationSlots);
+
+    trainLines.reserve(lineCount);
+    for (int i = 0; i < lineCount; i++) {
+        const SnapshotLine& record = lineRecords[i];
+        trainLines.emplaceAt(record.id, record.id, record.station1Id, record.station2Id);
+        TrainLine& line = trainLines.atIndex(record.id);
+        line.setLength(record.length);
+        stations.atIndex(record.station1Id).addConnectedLine(record.id);
+        stations.atIndex(record.station2Id).addConnectedLine(record.id);
+        ledger.setUpkeep(LedgerAccount::LINE, record.id, economy->getLineMaintenanceCost(record.length));
+    }
+
+    trains.reserve(trainCount);
+    for (int i = 0; i < trainCount; i++) {
+        const SnapshotTrain& record = trainRecords[i];
+        trains.emplaceAt(record.id, record.id, record.lineId, record.capacity);
+        Train& train = trains.atIndex(record.id);
+        train.setLastLeg(record.lastLeg);
+        train.setLinePosition(trainLines.atIndex(record.lineId).addTrain(record.id));
+        ledger.setUpkeep(LedgerAccount::TRAIN, record.id, economy->getTrainMaintenanceCost());
+    }
+
+    for (size_t i = 0; i < cohortRecords.size(); i++) {
+        const SnapshotCohort& record = cohortRecords[i];
+        CohortPool& pool = record.owner == CohortOwner::STATION
+            ? stations.atIndex(record.ownerId).getWaiting()
+            : trains.atIndex(record.ownerId).getOnboard();
+        pool.add(cohortArena, record.origin, record.destination, record.count, record.spawnTime);
+    }
+
+    // Derived structures are rebuilt in bulk rather than replayed per entity
+    compileNetwork();
+    for (int i = 0; i < trainCount; i++) {
+        timetable.setEpoch(trainRecords[i].id, trainRecords[i].epoch);
+    }
+    reorderNetwork();
+    if (demandRecords.empty()) {
+        demandModel.rebuild(networkGraph);
+    } else {
+        // Restoring the saved rows is linear in their size, where a rebuild
+        // is O(stations^2), and keeps the fractional trips in flight
+        std::vector<DemandEntry> row;
+        for (int i = 0; i < stationCount; i++) {
+            const SnapshotDemand& record = demandRecords[i];
+            row.clear();
+            for (uint32_t j = 0; j < record.entryCount; j++) {
+                const SnapshotDemandEntry& entry = demandEntries[record.entryOffset + j];
+                row.push_back({entry.destination, entry.rate, entry.pending});
+            }
+            demandModel.restoreStation(record.stationId, stationRecords[i].lat, stationRecords[i].lon,
+                                       record.catchment, record.rowTotal, record.spawnAccumulator, row);
+        }
+    }
+    for (int i = 0; i < lineCount; i++) {
+        updateLineRoute(lineRecords[i].id);
+    }
+}
+
+bool World::foldJournal(const std::string& snapshotPath, const std::string& journalBase,
+                        int firstSegment, int endSegment, const SnapshotWorld& header,
+                        const std::string& targetPath, const EconomyConfig& economyConfig) {
+    SnapshotReader reader;
+    if (!reader.open(snapshotPath) || !validateSnapshot(reader)) return false;
+
+    // Off the game thread, so it must not compete for the shared pool
+    SerialScope serial;
+    World folded(economyConfig);
+    folded.setReporting(false);
+    folded.loadSnapshot(reader);
+
+    std::vector<JournalRecord> records;
+    for (int segment = firstSegment; segment < endSegment; segment++) {
+        Journal::readSegment(Journal::segmentPath(journalBase, segment), records);
+    }
+    for (const JournalRecord& record : records) {
+        folded.applyJournalRecord(record);
+    }
+    return folded.writeSnapshot(targetPath, header);
+}
+
+uint64_t World::computeHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    auto mixValue = [&mix](auto value) { mix(&value, sizeof(value)); };
+
+    // Everything in id order - removals reorder the dense arrays
+    mixValue(simClock);
+    mixValue(economy->getMoney());
+    for (int stationId = 0; stationId < (int)stations.slotCount(); stationId++) {
+        if (!stations.containsIndex(stationId)) continue;
+        const Station& station = stations.atIndex(stationId);
+        mixValue(station.getLat());
+        mixValue(station.getLon());
+        mixValue(station.getPassengerCount());
+    }
+    for (int lineId = 0; lineId < (int)trainLines.slotCount(); lineId++) {
+        if (!trainLines.containsIndex(lineId)) continue;
+        const TrainLine& line = trainLines.atIndex(lineId);
+        mixValue(line.getStation1());
+        mixValue(line.getStation2());
+        mixValue(line.getLength());
+    }
+    for (int trainId = 0; trainId < (int)trains.slotCount(); trainId++) {
+        if (!trains.containsIndex(trainId)) continue;
+        const Train& train = trains.atIndex(trainId);
+        mixValue(train.getLineId());
+        mixValue(train.getLastLeg());
+        mixValue(train.getPassengerCount());
+    }
+    return hash;
+}
+
+void World::update(float deltaTime) {
+    auto tickStart = std::chrono::steady_clock::now();
+    simClock += deltaTime;
+
+    // Only trees invalidated by network edits are recomputed
+    router.update(networkGraph);
+
+    // Passenger demand from the gravity model
+    tripRequests.clear();
+    demandModel.generate(deltaTime, tripRequests);
+    float spawnTime = CohortArena::bucketTime(simClock);
+    for (const auto& trip : tripRequests) {
+        // Nobody sets out for a station the network cannot reach
+        if (router.isReachable(trip.origin, trip.destination)) {
+            stations.atIndex(trip.origin).addPassengers(cohortArena, trip.destination, trip.count, spawnTime);
+        }
+    }
+
+    // Cohorts are keyed by spawn bucket, so expiring once per bucket keeps
+    // at most MAX_WAIT / SPAWN_BUCKET of them per platform and destination
+    uint64_t abandoned = 0;
+    if (spawnTime != CohortArena::bucketTime(simClock - deltaTime)) {
+        abandoned = expireWaiting((float)(spawnTime - MAX_WAIT));
+        passengersAbandoned += abandoned;
+    }
+
+    updateTrains();
+
+    // Fares for journeys that reached their destination, in station order
+    fareTable.billTrips(completedTrips, economy->getTicketPricePerKm(), tripFares);
+    uint64_t passengers = 0;
+    for (size_t i = 0; i < completedTrips.size(); i++) {
+        const CompletedTrip& trip = completedTrips[i];
+        double fare = tripFares[i];
+        economy->recordRevenue(LedgerAccount::STATION, trip.origin, fare);
+        economy->recordRevenue(LedgerAccount::LINE, trains.atIndex(trip.trainId).getLineId(), fare);
+        economy->recordRevenue(LedgerAccount::TRAIN, trip.trainId, fare);
+        passengers += trip.count;
+    }
+    passengersDelivered += passengers;
+
+    // Closes the tick once its fares are in the ledger
+    economy->update(deltaTime);
+
+    if (!reporting) return;
+    SimMetrics& metrics = simMetrics();
+    metrics.ticks.add();
+    metrics.passengers.add(passengers);
+    metrics.abandoned.add(abandoned);
+    metrics.stations.set((double)stations.size());
+    metrics.lines.set((double)trainLines.size());
+    metrics.trains.set((double)trains.size());
+    metrics.simClock.set(simClock);
+    metrics.routeCacheBytes.set((double)router.getCacheBytes());
+    metrics.tickSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - tickStart).count());
+}
+
+uint64_t World::expireWaiting(float cutoff) {
+    // Riders only ever wait on platforms: a train empties at its next stop
+    uint64_t dropped = 0;
+    for (auto& station : stations) {
+        dropped += station.getWaiting().expire(cohortArena, cutoff);
+    }
+    return dropped;
+}
+
+void World::updateTrains() {
+    // Phase 1 (parallel, per line): lines only interact at stations, so
+    // detecting each train's arrival is independent work
+    lineArrivals.resize(trainLines.slotCount());
+    parallelFor(0, trainLines.slotCount(), [&](int begin, int end) {
+        for (int lineId = begin; lineId < end; lineId++) {
+            std::vector<Arrival>& out = lineArrivals[lineId];
+            out.clear();
+            if (!trainLines.containsIndex(lineId)) continue;
+
+            const TrainLine& line = trainLines.atIndex(lineId);
+            for (int trainId : line.getTrains()) {
+                Train& train = trains.atIndex(trainId);
+                TrainState state = timetable.getTrainState(trainId, simClock);
+                if (state.legIndex == train.getLastLeg()) continue;
+                train.setLastLeg(state.legIndex);
+
+                // Heading for nextStationId means the train just reached the other end
+                int stationId = state.nextStationId == line.getStation1() ? line.getStation2() : line.getStation1();
+                out.push_back({lineId, trainId, stationId, state.nextStationId});
+            }
+        }
+    }, 16);
+
+    // Phase 2 (serial merge): group arrivals by station, in line then train
+    // id order inside each group so shared stations resolve the same way no
+    // matter how many cores ran phase 1 or how removals shuffled the lines
+    arrivals.clear();
+    for (const auto& out : lineArrivals) {
+        arrivals.insert(arrivals.end(), out.begin(), out.end());
+    }
+    std::sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) {
+        if (a.stationId != b.stationId) return a.stationId < b.stationId;
+        if (a.lineId != b.lineId) return a.lineId < b.lineId;
+        return a.trainId < b.trainId;
+    });
+
+    arrivalGroups.clear();
+    for (size_t i = 0; i < arrivals.size(); i++) {
+        if (i == 0 || arrivals[i].stationId != arrivals[i - 1].stationId) {
+            arrivalGroups.push_back(i);
+        }
+    }
+    arrivalGroups.push_back(arrivals.size());
+
+    // Phase 3 (parallel, per station): alight then board. A train arrives at
+    // one station per tick, so each task owns its platform and its trains.
+    int groupCount = arrivalGroups.size() - 1;
+    groupCompleted.resize(groupCount);
+    parallelFor(0, groupCount, [&](int begin, int end) {
+        for (int g = begin; g < end; g++) {
+            std::vector<CompletedTrip>& completed = groupCompleted[g];
+            completed.clear();
+
+            for (int i = arrivalGroups[g]; i < arrivalGroups[g + 1]; i++) {
+                const Arrival& arrival = arrivals[i];
+                Train& train = trains.atIndex(arrival.trainId);
+                CohortPool& platform = stations.atIndex(arrival.stationId).getWaiting();
+
+                train.disembarkPassengers(cohortArena, arrival.stationId, platform, completed);
+                train.boardPassengers(cohortArena, platform, [&](const PassengerCohort& cohort) {
+                    return router.getNextStation(arrival.stationId, cohort.destination) == arrival.nextStationId;
+                });
+            }
+        }
+    }, 4);
+
+    completedTrips.clear();
+    for (int g = 0; g < groupCount; g++) {
+        completedTrips.insert(completedTrips.end(), groupCompleted[g].begin(), groupCompleted[g].end());
+    }
+}
@@ -0,0 +1,118 @@
+#include "World.h"
+#include "Scenario.h"
+#include "Snapshot.h"
+#include "AllocationStats.h"
+#include "MetricsExporter.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Runs the simulation without SDL: a synthetic scenario or a saved game,
+// stepped for a fixed number of ticks as fast as possible.
+
+static const double TICK_SECONDS = 1.0 / 60.0;
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--load <snapshot>] [--stations <n>] [--extra-lines <n>]"
+              << " [--trains-per-line <n>] [--seed <n>] [--ticks <n>]\n"
+              << "       [--metrics <[host:]port|unix:path>] [--metrics-file <path>] [--metrics-interval <s>]"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    ScenarioOptions scenario;
+    std::string loadPath;
+    long ticks = 3600;
+    std::string metricsAddress;
+    std::string metricsFile;
+    double metricsInterval = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--load") == 0 && hasValue) {
+            loadPath = argv[++i];
+        } else if (strcmp(argv[i], "--stations") == 0 && hasValue) {
+            scenario.stationCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--extra-lines") == 0 && hasValue) {
+            scenario.extraLineCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trains-per-line") == 0 && hasValue) {
+            scenario.trainsPerLine = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            scenario.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics") == 0 && hasValue) {
+            metricsAddress = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-file") == 0 && hasValue) {
+            metricsFile = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && hasValue) {
+            metricsInterval = atof(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    MetricsExporter metrics;
+    if (!metricsAddress.empty() && !metrics.listen(metricsAddress)) {
+        return 1;
+    }
+    if (!metricsFile.empty()) {
+        metrics.writeFile(metricsFile, metricsInterval);
+    }
+    metrics.start();
+
+    World world;
+    if (!loadPath.empty()) {
+        SnapshotReader reader;
+        if (!reader.open(loadPath) || !World::validateSnapshot(reader)) {
+            LOG_ERROR("Cannot load {}", loadPath);
+            return 1;
+        }
+        world.loadSnapshot(reader);
+    } else {
+        buildScenario(world, scenario);
+    }
+    std::cout << "World: " << world.getStations().size() << " stations, " << world.getLines().size()
+              << " lines, " << world.getTrains().size() << " trains" << std::endl;
+
+    std::vector<double> tickTimes;
+    tickTimes.reserve(ticks);
+    // The first tick sizes every scratch buffer; count allocations after it
+    AllocationCounts steadyStart;
+    auto start = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; tick++) {
+        auto tickStart = std::chrono::steady_clock::now();
+        world.update((float)TICK_SECONDS);
+        tickTimes.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - tickStart).count());
+        if (tick == 0) {
+            steadyStart = AllocationStats::total();
+        }
+    }
+    double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (!tickTimes.empty()) {
+        std::sort(tickTimes.begin(), tickTimes.end());
+        std::cout << "Headless run: " << tickTimes.size() << " ticks in " << total << " ms ("
+                  << tickTimes.size() * 1000.0 / total << " ticks/s), p50 "
+                  << tickTimes[tickTimes.size() / 2] << " ms, p99 "
+                  << tickTimes[tickTimes.size() * 99 / 100] << " ms, max "
+                  << tickTimes.back() << " ms per tick" << std::endl;
+    }
+    if (AllocationStats::enabled() && ticks > 1) {
+        // What remains is waiting-passenger pools growing, amortized
+        AllocationCounts steadyEnd = AllocationStats::total();
+        std::cout << "Allocations after the first tick: "
+                  << (double)(steadyEnd.allocations - steadyStart.allocations) / (ticks - 1) << " ("
+                  << (double)(steadyEnd.bytes - steadyStart.bytes) / (ticks - 1) << " bytes) per tick"
+                  << std::endl;
+    }
+    std::cout << "World hash " << std::hex << world.computeHash() << std::dec
+              << ", money $" << (long)world.getEconomy().getMoney() << std::endl;
+    metrics.stop();
+    return 0;
+}
@@ -1,16 +1,85 @@
 #include "Game.h"
+#include "MetricsExporter.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--record <log>] [--replay <log>] [--headless]\n"
+              << "       " << program << " --render-bench <frames> [--country <code>] [--stations <n>]\n"
+              << "Display: [--window <width>x<height>] [--frame-budget <ms>] [--fixed-resolution]\n"
+              << "Metrics: [--metrics <[host:]port|unix:path>] [--metrics-file <path>] [--metrics-interval <s>]\n"
+              << "Logging: [--log-level <trace|debug|info|warn|error>]" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
+    GameOptions options;
+    std::string metricsAddress;
+    std::string metricsFile;
+    double metricsInterval = 10.0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        } else if (strcmp(argv[i], "--render-bench") == 0 && i + 1 < argc) {
+            options.renderBenchFrames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--country") == 0 && i + 1 < argc) {
+            options.benchCountry = argv[++i];
+        } else if (strcmp(argv[i], "--stations") == 0 && i + 1 < argc) {
+            options.benchStations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.windowWidth, &options.windowHeight) != 2 ||
+                options.windowWidth <= 0 || options.windowHeight <= 0) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc) {
+            options.frameBudgetMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--fixed-resolution") == 0) {
+            options.dynamicResolution = false;
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsAddress = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+            metricsInterval = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            LogLevel level;
+            if (!Log::parseLevel(argv[++i], level)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            Log::setLevel(level);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    MetricsExporter metrics;
+    if (!metricsAddress.empty() && !metrics.listen(metricsAddress)) {
+        return 1;
+    }
+    if (!metricsFile.empty()) {
+        metrics.writeFile(metricsFile, metricsInterval);
+    }
+    metrics.start();
+
     Game game;
 
-    if (!game.init()) {
-        std::cerr << "Failed to initialize game!" << std::endl;
+    if (!game.init(options)) {
+        LOG_ERROR("Failed to initialize game!");
         return 1;
     }
 
     game.run();
     game.cleanup();
+    metrics.stop();
 
-    return 0;
+    return game.getExitCode();
 }
@@ -0,0 +1,127 @@
+#include "SimServer.h"
+#include "MetricsExporter.h"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Hosts many worlds behind a local socket; see SimServer for the protocol.
+// Optionally starts with a batch of synthetic worlds and stops after a
+// fixed time, reporting throughput, for measuring how shards scale.
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void onSignal(int) {
+    interrupted = 1;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--listen <[host:]port|unix:path>] [--shards <n>] [--tick-rate <hz>]"
+              << " [--no-pin] [--snapshot-dir <dir>]\n"
+              << "       [--worlds <n>] [--stations <n>] [--extra-lines <n>] [--trains-per-line <n>] [--seed <n>]"
+              << " [--duration <s>]\n"
+              << "       [--metrics <[host:]port|unix:path>] [--metrics-file <path>] [--metrics-interval <s>]"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    SimServerOptions options;
+    std::string listenAddress = "unix:trainbuilder.sock";
+    int worlds = 0;
+    std::string scenario;
+    long seed = 1;
+    double duration = 0.0;
+    std::string metricsAddress;
+    std::string metricsFile;
+    double metricsInterval = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--listen") == 0 && hasValue) {
+            listenAddress = argv[++i];
+        } else if (strcmp(argv[i], "--shards") == 0 && hasValue) {
+            options.shardCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && hasValue) {
+            options.tickRate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--no-pin") == 0) {
+            options.pinShards = false;
+        } else if (strcmp(argv[i], "--snapshot-dir") == 0 && hasValue) {
+            options.snapshotDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--worlds") == 0 && hasValue) {
+            worlds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stations") == 0 && hasValue) {
+            scenario += std::string(" stations=") + argv[++i];
+        } else if (strcmp(argv[i], "--extra-lines") == 0 && hasValue) {
+            scenario += std::string(" extra-lines=") + argv[++i];
+        } else if (strcmp(argv[i], "--trains-per-line") == 0 && hasValue) {
+            scenario += std::string(" trains-per-line=") + argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && hasValue) {
+            duration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics") == 0 && hasValue) {
+            metricsAddress = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-file") == 0 && hasValue) {
+            metricsFile = argv[++i];
+        } else if (strcmp(argv[i], "--metrics-interval") == 0 && hasValue) {
+            metricsInterval = atof(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    MetricsExporter metrics;
+    if (!metricsAddress.empty() && !metrics.listen(metricsAddress)) {
+        return 1;
+    }
+    if (!metricsFile.empty()) {
+        metrics.writeFile(metricsFile, metricsInterval);
+    }
+
+    SimServer server(options);
+    if (!server.listen(listenAddress)) {
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    metrics.start();
+    server.start();
+
+    // Every world gets its own seed, so no two are the same network
+    for (int i = 0; i < worlds; i++) {
+        std::string reply = server.execute("CREATE seed=" + std::to_string(seed + i) + scenario);
+        if (reply.compare(0, 2, "OK") != 0) {
+            std::cerr << "Cannot create world: " << reply << std::endl;
+            return 1;
+        }
+    }
+    std::cout << server.getShardCount() << " shards hosting " << worlds << " worlds" << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    uint64_t startTicks = 0;
+    for (const auto& shard : server.getShardStats()) {
+        startTicks += shard.worldTicks;
+    }
+    while (!interrupted && !server.isShutdownRequested()) {
+        if (duration > 0.0 && std::chrono::duration<double>(Clock::now() - start).count() >= duration) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    server.stop();
+    metrics.stop();
+
+    uint64_t worldTicks = 0;
+    std::vector<ShardStats> stats = server.getShardStats();
+    for (size_t i = 0; i < stats.size(); i++) {
+        std::cout << "Shard " << i << " (core " << stats[i].core << "): " << stats[i].worlds << " worlds, "
+                  << stats[i].ticks << " ticks, " << stats[i].overruns << " overruns" << std::endl;
+        worldTicks += stats[i].worldTicks;
+    }
+    std::cout << "Server ran " << elapsed << " s: " << (worldTicks - startTicks) / elapsed
+              << " world ticks/s" << std::endl;
+    return 0;
+}
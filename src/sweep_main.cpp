@@ -0,0 +1,282 @@
+#include "World.h"
+#include "Scenario.h"
+#include "Parallel.h"
+#include "ColumnTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+// Runs the headless simulation over a grid of economy and scenario
+// parameters, one world per grid point, all points in parallel. Results
+// go to a columnar file for analysis and optionally a CSV.
+
+static const double TICK_SECONDS = 1.0 / 60.0;
+
+static const char* SCENARIO_PARAMETERS[] = {"stations", "extra-lines", "trains-per-line", "seed"};
+
+struct SweepParameter {
+    std::string name;
+    std::vector<double> values;
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --param <name>=<a,b,c|start:stop:step> [--param ...] [--ticks <n>]\n"
+              << "       [--stations <n>] [--extra-lines <n>] [--trains-per-line <n>] [--seed <n>]\n"
+              << "       [--bankrupt-below <money>] [--early-stop] [--out <path>] [--csv <path>]\n"
+              << "Parameters:";
+    for (const char* name : SCENARIO_PARAMETERS) {
+        std::cerr << " " << name;
+    }
+    for (const auto& name : EconomyConfig::fieldNames()) {
+        std::cerr << " " << name;
+    }
+    std::cerr << std::endl;
+}
+
+static bool isScenarioParameter(const std::string& name) {
+    for (const char* parameter : SCENARIO_PARAMETERS) {
+        if (name == parameter) return true;
+    }
+    return false;
+}
+
+static bool setScenarioParameter(ScenarioOptions& scenario, const std::string& name, double value) {
+    if (name == "stations") scenario.stationCount = (int)value;
+    else if (name == "extra-lines") scenario.extraLineCount = (int)value;
+    else if (name == "trains-per-line") scenario.trainsPerLine = (int)value;
+    else if (name == "seed") scenario.seed = (uint32_t)value;
+    else return false;
+    return true;
+}
+
+// "name=a,b,c" or "name=start:stop:step", stop inclusive
+static bool parseParameter(const std::string& text, SweepParameter& parameter) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos || equals == 0) return false;
+    parameter.name = text.substr(0, equals);
+    std::string values = text.substr(equals + 1);
+    EconomyConfig probe;
+    if (!isScenarioParameter(parameter.name) && !probe.field(parameter.name)) return false;
+
+    if (values.find(':') != std::string::npos) {
+        double start, stop, step;
+        char trailing;
+        if (sscanf(values.c_str(), "%lf:%lf:%lf%c", &start, &stop, &step, &trailing) != 3) return false;
+        if (step <= 0.0 || stop < start) return false;
+        // Count steps up front so rounding cannot drop or add the last value
+        long count = (long)std::floor((stop - start) / step + 1e-9) + 1;
+        for (long i = 0; i < count; i++) {
+            parameter.values.push_back(start + i * step);
+        }
+    } else {
+        size_t begin = 0;
+        while (begin <= values.size()) {
+            size_t comma = values.find(',', begin);
+            if (comma == std::string::npos) comma = values.size();
+            std::string item = values.substr(begin, comma - begin);
+            char* end = nullptr;
+            double value = strtod(item.c_str(), &end);
+            if (item.empty() || *end != '\0') return false;
+            parameter.values.push_back(value);
+            begin = comma + 1;
+        }
+    }
+    return !parameter.values.empty();
+}
+
+struct SweepResult {
+    double finalMoney;
+    double minMoney;
+    double income;
+    double spent;
+    double construction;
+    uint64_t passengers;
+    long ticks;
+    long bankruptTick; // -1 when solvent throughout
+    int stations;
+    int lines;
+    int trains;
+};
+
+int main(int argc, char* argv[]) {
+    std::vector<SweepParameter> parameters;
+    ScenarioOptions baseScenario;
+    // Every point builds the same network, so the swept build costs show
+    // up as each point's construction debt
+    baseScenario.chargeConstruction = true;
+    long ticks = 216000; // one simulated hour
+    double bankruptBelow = 0.0;
+    // Off by default: fares only arrive once trains finish their first legs,
+    // often after upkeep has already bankrupted the point
+    bool earlyStop = false;
+    std::string outPath = "sweep.tbcols";
+    std::string csvPath;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--param") == 0 && hasValue) {
+            SweepParameter parameter;
+            if (!parseParameter(argv[++i], parameter)) {
+                std::cerr << "Bad parameter: " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            parameters.push_back(parameter);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--stations") == 0 && hasValue) {
+            baseScenario.stationCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--extra-lines") == 0 && hasValue) {
+            baseScenario.extraLineCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trains-per-line") == 0 && hasValue) {
+            baseScenario.trainsPerLine = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            baseScenario.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--bankrupt-below") == 0 && hasValue) {
+            bankruptBelow = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--early-stop") == 0) {
+            earlyStop = true;
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            csvPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (parameters.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    size_t pointCount = 1;
+    for (const auto& parameter : parameters) {
+        pointCount *= parameter.values.size();
+    }
+    std::cout << "Sweeping " << pointCount << " points of " << ticks << " ticks on " << getWorkerCount()
+              << " workers" << std::endl;
+
+    std::vector<SweepResult> results(pointCount);
+    std::mutex progressMutex;
+    size_t finished = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    // One point per task: points are whole simulations, each run serially
+    // on its worker, so the pool is never asked to split a single tick
+    parallelFor(0, (int)pointCount, [&](int begin, int end) {
+        SerialScope serial;
+        for (int point = begin; point < end; point++) {
+            EconomyConfig config;
+            ScenarioOptions scenario = baseScenario;
+            // Last parameter varies fastest
+            size_t index = point;
+            for (size_t p = parameters.size(); p-- > 0;) {
+                const SweepParameter& parameter = parameters[p];
+                double value = parameter.values[index % parameter.values.size()];
+                index /= parameter.values.size();
+                if (!setScenarioParameter(scenario, parameter.name, value)) {
+                    *config.field(parameter.name) = value;
+                }
+            }
+
+            World world(config);
+            world.setReporting(false);
+            buildScenario(world, scenario);
+
+            SweepResult& result = results[point];
+            result.construction = world.getEconomy().getTotalSpent();
+            result.minMoney = world.getEconomy().getMoney();
+            result.bankruptTick = -1;
+            long tick = 0;
+            while (tick < ticks) {
+                world.update(TICK_SECONDS);
+                tick++;
+                double money = world.getEconomy().getMoney();
+                result.minMoney = std::min(result.minMoney, money);
+                // Running the network, not paying off its construction, is
+                // what bankrupts a point
+                if (money + result.construction < bankruptBelow && result.bankruptTick < 0) {
+                    result.bankruptTick = tick;
+                    if (earlyStop) break;
+                }
+            }
+
+            const Economy& economy = world.getEconomy();
+            result.finalMoney = economy.getMoney();
+            result.income = economy.getTotalIncome();
+            result.spent = economy.getTotalSpent();
+            result.passengers = world.getPassengersDelivered();
+            result.ticks = tick;
+            result.stations = (int)world.getStations().size();
+            result.lines = (int)world.getLines().size();
+            result.trains = (int)world.getTrains().size();
+
+            std::lock_guard<std::mutex> lock(progressMutex);
+            finished++;
+            std::cout << "[" << finished << "/" << pointCount << "] point " << point << ": money $"
+                      << (long)result.finalMoney << (result.bankruptTick >= 0 ? " bankrupt at tick " : "")
+                      << (result.bankruptTick >= 0 ? std::to_string(result.bankruptTick) : "") << std::endl;
+        }
+    }, 1);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ColumnTable table(pointCount);
+    std::vector<int> parameterColumns;
+    for (const auto& parameter : parameters) {
+        parameterColumns.push_back(table.addColumn(parameter.name, ColumnType::FLOAT64));
+    }
+    int finalMoneyColumn = table.addColumn("final_money", ColumnType::FLOAT64);
+    int minMoneyColumn = table.addColumn("min_money", ColumnType::FLOAT64);
+    int incomeColumn = table.addColumn("income", ColumnType::FLOAT64);
+    int spentColumn = table.addColumn("spent", ColumnType::FLOAT64);
+    int constructionColumn = table.addColumn("construction", ColumnType::FLOAT64);
+    int passengersColumn = table.addColumn("passengers", ColumnType::INT64);
+    int ticksColumn = table.addColumn("ticks", ColumnType::INT64);
+    int bankruptColumn = table.addColumn("bankrupt", ColumnType::INT64);
+    int bankruptTickColumn = table.addColumn("bankrupt_tick", ColumnType::INT64);
+    // Prefixed, so they never clash with the scenario parameters' columns
+    int stationsColumn = table.addColumn("built_stations", ColumnType::INT64);
+    int linesColumn = table.addColumn("built_lines", ColumnType::INT64);
+    int trainsColumn = table.addColumn("built_trains", ColumnType::INT64);
+
+    long totalTicks = 0;
+    size_t bankruptCount = 0;
+    for (size_t point = 0; point < pointCount; point++) {
+        size_t index = point;
+        for (size_t p = parameters.size(); p-- > 0;) {
+            table.set(parameterColumns[p], point, parameters[p].values[index % parameters[p].values.size()]);
+            index /= parameters[p].values.size();
+        }
+        const SweepResult& result = results[point];
+        table.set(finalMoneyColumn, point, result.finalMoney);
+        table.set(minMoneyColumn, point, result.minMoney);
+        table.set(incomeColumn, point, result.income);
+        table.set(spentColumn, point, result.spent);
+        table.set(constructionColumn, point, result.construction);
+        table.set(passengersColumn, point, (int64_t)result.passengers);
+        table.set(ticksColumn, point, (int64_t)result.ticks);
+        table.set(bankruptColumn, point, (int64_t)(result.bankruptTick >= 0));
+        table.set(bankruptTickColumn, point, (int64_t)result.bankruptTick);
+        table.set(stationsColumn, point, (int64_t)result.stations);
+        table.set(linesColumn, point, (int64_t)result.lines);
+        table.set(trainsColumn, point, (int64_t)result.trains);
+        totalTicks += result.ticks;
+        bankruptCount += result.bankruptTick >= 0;
+    }
+
+    std::cout << "Swept " << pointCount << " points in " << elapsed << " s (" << totalTicks / elapsed
+              << " ticks/s), " << bankruptCount << " bankrupt" << std::endl;
+    if (!table.writeColumnar(outPath)) return 1;
+    std::cout << "Wrote " << outPath << std::endl;
+    if (!csvPath.empty()) {
+        if (!table.writeCsv(csvPath)) return 1;
+        std::cout << "Wrote " << csvPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "Economy.h"
+#include "Metrics.h"
+#include "World.h"
+#include "Scenario.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("A tick's revenue closes into that tick", "[economy]") {
+    Economy economy;
+    economy.setPublishMetrics(false);
+    economy.recordRevenue(LedgerAccount::STATION, 0, 12.5);
+    economy.recordRevenue(LedgerAccount::LINE, 0, 12.5);
+    economy.recordCost(LedgerAccount::TRAIN, 0, 4.0);
+    economy.update(1.0f / 60.0f);
+
+    LedgerPeriod tick = economy.getLedger().getTicks().get(0);
+    CHECK(tick.revenue == Approx(12.5));
+    CHECK(tick.costs == Approx(4.0));
+}
+
+TEST_CASE("Settlement charges upkeep and recorded costs", "[economy]") {
+    Economy economy;
+    double money = economy.getMoney();
+    economy.getLedger().setUpkeep(LedgerAccount::STATION, 0, 100.0);
+    economy.getLedger().setUpkeep(LedgerAccount::TRAIN, 3, 200.0);
+    economy.recordCost(LedgerAccount::LINE, 1, 50.0);
+    economy.recordRevenue(LedgerAccount::STATION, 0, 80.0);
+    CHECK(economy.getMonthlyExpenses() == Approx(50.0));
+
+    economy.update(30.0f);
+    CHECK(economy.getMoney() == Approx(money + 80.0 - 350.0));
+    CHECK(economy.getTotalSpent() == Approx(350.0));
+    CHECK(economy.getLedger().getMonths().get(0).costs == Approx(350.0));
+    CHECK(economy.getLedger().getMonths().get(0).revenue == Approx(80.0));
+
+    // The settled month is published with its upkeep, then a new one starts
+    MetricsRegistry& registry = MetricsRegistry::global();
+    CHECK(registry.gauge("trainbuilder_month_expenses", "").get() == Approx(350.0));
+    CHECK(registry.gauge("trainbuilder_month_income", "").get() == Approx(80.0));
+    CHECK(economy.getMonthlyExpenses() == 0.0);
+    CHECK(economy.getMonthlyIncome() == 0.0);
+}
+
+TEST_CASE("Construction is recorded in the ledger as it is paid", "[economy]") {
+    World world;
+    world.setReporting(false);
+    const Economy& economy = world.getEconomy();
+    double startingMoney = economy.getMoney();
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.placeStation(52.30, 4.90));
+    REQUIRE(world.buildLine(0, 1));
+    REQUIRE(world.buildLine(1, 2));
+    REQUIRE(world.addTrain(0));
+    REQUIRE(world.addTrain(1));
+
+    const Ledger& ledger = economy.getLedger();
+    double recorded = 0.0;
+    for (int id = 0; id < 3; id++) {
+        recorded += ledger.getCosts(LedgerAccount::STATION, id);
+    }
+    for (int id = 0; id < 2; id++) {
+        recorded += ledger.getCosts(LedgerAccount::LINE, id) + ledger.getCosts(LedgerAccount::TRAIN, id);
+    }
+    double spent = startingMoney - economy.getMoney();
+    CHECK(ledger.getCosts(LedgerAccount::TRAIN, 1) == Approx(economy.getTrainPurchaseCost()));
+    CHECK(recorded == Approx(spent));
+    CHECK(economy.getTotalSpent() == Approx(spent));
+    CHECK(economy.getMonthlyExpenses() == Approx(spent));
+
+    // Settlement books the purchases into the month but charges only the
+    // upkeep on top of them
+    while (ledger.getMonths().getCount() == 0) {
+        world.update(1.0f);
+    }
+    double month = ledger.getMonths().get(0).costs;
+    CHECK(month > spent);
+    CHECK(economy.getTotalSpent() == Approx(month));
+    CHECK(economy.getMoney() == Approx(startingMoney - month + economy.getTotalIncome()));
+}
+
+TEST_CASE("Every fare lands in the tick it was earned", "[economy]") {
+    World world;
+    world.setReporting(false);
+    ScenarioOptions options;
+    options.stationCount = 40;
+    options.extraLineCount = 20;
+    options.populationCenters = 10;
+    // A small box, so trains arrive within the run
+    options.maxLat = options.minLat + 0.1;
+    options.maxLon = options.minLon + 0.1;
+    buildScenario(world, options);
+
+    // Fewer ticks than the tick history holds, so the series covers them all
+    const Economy& economy = world.getEconomy();
+    int ticks = 1000;
+    double earned = 0.0;
+    bool anyEarned = false;
+    for (int tick = 0; tick < ticks; tick++) {
+        double before = economy.getTotalIncome();
+        world.update(1.0f);
+        double income = economy.getTotalIncome() - before;
+        CHECK(economy.getLedger().getTicks().get(0).revenue == Approx(income));
+        earned += income;
+        anyEarned = anyEarned || income > 0.0;
+    }
+    REQUIRE(anyEarned);
+    CHECK(economy.getLedger().getTicks().sum(ticks).revenue == Approx(earned));
+}
+
+TEST_CASE("A charged scenario builds its whole network as a debt", "[economy]") {
+    // A default sweep point: the network costs far more than the starting
+    // money
+    ScenarioOptions options;
+    options.chargeConstruction = true;
+    World world;
+    world.setReporting(false);
+    buildScenario(world, options);
+    const Economy& economy = world.getEconomy();
+    CHECK(world.getStations().size() == (size_t)options.stationCount);
+    CHECK(world.getLines().size() >= (size_t)options.stationCount - 1);
+    CHECK(world.getTrains().size() == world.getLines().size() * options.trainsPerLine);
+    CHECK(economy.getMoney() < 0.0);
+    CHECK(economy.getMoney() == Approx(economy.getConfig().startingMoney - economy.getTotalSpent()));
+
+    // Dearer stations build the same network for more
+    EconomyConfig dear;
+    dear.stationBuildCost *= 2.0;
+    World dearWorld(dear);
+    dearWorld.setReporting(false);
+    buildScenario(dearWorld, options);
+    CHECK(dearWorld.getLines().size() == world.getLines().size());
+    CHECK(dearWorld.getTrains().size() == world.getTrains().size());
+    CHECK(dearWorld.getEconomy().getTotalSpent() ==
+          Approx(economy.getTotalSpent() + options.stationCount * economy.getStationBuildCost()));
+}
+
+TEST_CASE("Sweeping the ticket price changes a charged scenario's income", "[economy]") {
+    ScenarioOptions options;
+    options.stationCount = 40;
+    options.extraLineCount = 20;
+    options.populationCenters = 10;
+    options.maxLat = options.minLat + 0.1;
+    options.maxLon = options.minLon + 0.1;
+    options.chargeConstruction = true;
+
+    double income[2];
+    double prices[2] = {0.01, 100.0};
+    for (int i = 0; i < 2; i++) {
+        EconomyConfig config;
+        config.ticketPricePerKm = prices[i];
+        World world(config);
+        world.setReporting(false);
+        buildScenario(world, options);
+        for (int tick = 0; tick < 600; tick++) {
+            world.update(1.0f);
+        }
+        REQUIRE(world.getPassengersDelivered() > 0);
+        income[i] = world.getEconomy().getTotalIncome();
+    }
+    CHECK(income[1] == Approx(income[0] * 10000.0));
+}
@@ -0,0 +1,75 @@
+#include "FrameGovernor.h"
+#include <catch2/catch.hpp>
+
+static FrameGovernorOptions governorOptions() {
+    FrameGovernorOptions options;
+    options.budgetMs = 10.0;
+    options.minScale = 0.5f;
+    options.scaleStep = 0.25f;
+    return options;
+}
+
+// Enough frames at a steady cost for the average to settle and the
+// governor to act on it
+static void runFrames(FrameGovernor& governor, int frames, double workMs) {
+    for (int i = 0; i < frames; i++) {
+        governor.endFrame(workMs);
+    }
+}
+
+// Frames over budget until the governor moves, at most a second's worth
+static void stepDown(FrameGovernor& governor) {
+    int level = governor.getLevel();
+    for (int i = 0; i < 60 && governor.getLevel() == level; i++) {
+        governor.endFrame(20.0);
+    }
+}
+
+TEST_CASE("The governor sheds work before lowering the resolution", "[governor]") {
+    FrameGovernor governor(governorOptions());
+    runFrames(governor, 200, 5.0);
+    CHECK(governor.getLevel() == 0);
+    CHECK(governor.getResolutionScale() == 1.0f);
+
+    // One level at a time, cheapest work first
+    stepDown(governor);
+    CHECK(governor.getLevel() == 1);
+    CHECK(governor.isShed(SheddableWork::OVERLAY_UPDATES));
+    CHECK_FALSE(governor.isShed(SheddableWork::TILE_PREFETCH));
+
+    stepDown(governor);
+    stepDown(governor);
+    CHECK(governor.getLevel() == 3);
+    CHECK(governor.isShed(SheddableWork::TRAIN_DETAIL));
+    CHECK(governor.getResolutionScale() == 1.0f);
+
+    // Then the scene scales down, but never below the floor
+    stepDown(governor);
+    CHECK(governor.getResolutionScale() == Approx(0.75f));
+    runFrames(governor, 300, 20.0);
+    CHECK(governor.getResolutionScale() == Approx(0.5f));
+    CHECK(governor.getScaledFrames() > 0);
+}
+
+TEST_CASE("The governor steps back up only with headroom", "[governor]") {
+    FrameGovernor governor(governorOptions());
+    stepDown(governor);
+    REQUIRE(governor.getLevel() == 1);
+
+    // Just under budget is not enough headroom to give work back
+    runFrames(governor, 500, 9.0);
+    CHECK(governor.getLevel() == 1);
+
+    runFrames(governor, 500, 2.0);
+    CHECK(governor.getLevel() == 0);
+    CHECK_FALSE(governor.isShed(SheddableWork::OVERLAY_UPDATES));
+}
+
+TEST_CASE("A disabled governor never steps down", "[governor]") {
+    FrameGovernorOptions options = governorOptions();
+    options.enabled = false;
+    FrameGovernor governor(options);
+    runFrames(governor, 300, 50.0);
+    CHECK(governor.getLevel() == 0);
+    CHECK(governor.getResolutionScale() == 1.0f);
+}
@@ -0,0 +1,213 @@
+#include "Geodesy.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Built twice: once against the core's kernel and, as
+// trainbuilder_geodesy_avx2_tests, against an AVX2 build of Geodesy.cpp
+#ifdef TRAINBUILDER_TEST_AVX2
+static bool kernelSupported() { return __builtin_cpu_supports("avx2"); }
+#else
+static bool kernelSupported() { return true; }
+#endif
+
+// A sphere is within 0.5% of the WGS-84 ellipsoid at any range
+static const double SPHERE_MAX_ERROR = 5e-3;
+// Batch kernels against haversineKm, relative
+static const double BATCH_MAX_ERROR = 1e-10;
+
+struct CityPair {
+    const char* name;
+    double lat1, lon1, lat2, lon2;
+    double geodesicKm; // WGS-84 (Vincenty)
+};
+
+static const CityPair CITY_PAIRS[] = {
+    {"Amsterdam-Utrecht", 52.3676, 4.9041, 52.0907, 5.1214, 34.202},
+    {"Amsterdam-Rotterdam", 52.3676, 4.9041, 51.9244, 4.4777, 57.306},
+    {"London-Paris", 51.5074, -0.1278, 48.8566, 2.3522, 343.923},
+    {"Berlin-Munich", 52.5200, 13.4050, 48.1351, 11.5820, 504.689},
+    {"Madrid-Barcelona", 40.4168, -3.7038, 41.3874, 2.1686, 506.300},
+    {"Oslo-Tromso", 59.9139, 10.7522, 69.6492, 18.9553, 1150.950},
+    {"New York-Los Angeles", 40.7128, -74.0060, 34.0522, -118.2437, 3944.422},
+    {"Sydney-Tokyo", -33.8688, 151.2093, 35.6762, 139.6503, 7792.175},
+    {"Quito-Singapore", -0.1807, -78.4678, 1.3521, 103.8198, 19743.446},
+};
+
+TEST_CASE("Great-circle distances match city-pair geodesics", "[geodesy]") {
+    for (const CityPair& pair : CITY_PAIRS) {
+        INFO(pair.name);
+        double d = haversineKm(pair.lat1, pair.lon1, pair.lat2, pair.lon2);
+        CHECK(std::abs(d - pair.geodesicKm) <= pair.geodesicKm * SPHERE_MAX_ERROR);
+        CHECK(haversineKm(pair.lat2, pair.lon2, pair.lat1, pair.lon1) == Approx(d).epsilon(1e-12));
+    }
+}
+
+TEST_CASE("The batch kernel matches city pairs", "[geodesy]") {
+    if (!kernelSupported()) {
+        WARN("CPU lacks AVX2, skipped");
+        return;
+    }
+    // One origin against every destination, so the count also exercises
+    // the scalar tail after the vector lanes
+    const CityPair& origin = CITY_PAIRS[0];
+    std::vector<double> lats, lons;
+    for (const CityPair& pair : CITY_PAIRS) {
+        lats.push_back(pair.lat2);
+        lons.push_back(pair.lon2);
+    }
+    std::vector<double> out(lats.size());
+    haversineKmBatch(origin.lat1, origin.lon1, lats.data(), lons.data(), lats.size(), out.data());
+
+    for (size_t i = 0; i < lats.size(); i++) {
+        INFO(CITY_PAIRS[i].name);
+        double expected = haversineKm(origin.lat1, origin.lon1, lats[i], lons[i]);
+        CHECK(std::abs(out[i] - expected) <= expected * BATCH_MAX_ERROR + 1e-9);
+    }
+
+    // Pairs sharing the origin are checked against their own geodesic too
+    CHECK(std::abs(out[0] - CITY_PAIRS[0].geodesicKm) <= CITY_PAIRS[0].geodesicKm * SPHERE_MAX_ERROR);
+    CHECK(std::abs(out[1] - CITY_PAIRS[1].geodesicKm) <= CITY_PAIRS[1].geodesicKm * SPHERE_MAX_ERROR);
+}
+
+TEST_CASE("The batch kernel matches haversineKm everywhere", "[geodesy]") {
+    if (!kernelSupported()) {
+        WARN("CPU lacks AVX2, skipped");
+        return;
+    }
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> latDist(-89.0, 89.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+
+    const size_t count = 1003;
+    std::vector<double> lats(count), lons(count), out(count);
+    for (int origin = 0; origin < 20; origin++) {
+        double lat = latDist(gen);
+        double lon = lonDist(gen);
+        for (size_t i = 0; i < count; i++) {
+            lats[i] = latDist(gen);
+            lons[i] = lonDist(gen);
+        }
+        // Include the origin itself and its antipode
+        lats[0] = lat;
+        lons[0] = lon;
+        lats[1] = -lat;
+        lons[1] = lon > 0 ? lon - 180.0 : lon + 180.0;
+
+        haversineKmBatch(lat, lon, lats.data(), lons.data(), count, out.data());
+        for (size_t i = 0; i < count; i++) {
+            double expected = haversineKm(lat, lon, lats[i], lons[i]);
+            REQUIRE(std::abs(out[i] - expected) <= expected * BATCH_MAX_ERROR + 1e-9);
+        }
+        CHECK(out[0] < 1e-9);
+        CHECK(out[1] == Approx(M_PI * EARTH_RADIUS_KM).epsilon(1e-9));
+    }
+}
+
+TEST_CASE("fastDistanceKm stays within its stated error", "[geodesy]") {
+    for (const CityPair& pair : CITY_PAIRS) {
+        INFO(pair.name);
+        double expected = haversineKm(pair.lat1, pair.lon1, pair.lat2, pair.lon2);
+        double d = fastDistanceKm(pair.lat1, pair.lon1, pair.lat2, pair.lon2);
+        CHECK(std::abs(d - expected) <= expected * FAST_DISTANCE_MAX_ERROR);
+    }
+
+    // Short hops up to 80 degrees of latitude, where the flat-earth
+    // branch is taken
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> latDist(-80.0, 80.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+    std::uniform_real_distribution<double> offsetDist(-0.5, 0.5);
+    for (int i = 0; i < 10000; i++) {
+        double lat1 = latDist(gen);
+        double lon1 = lonDist(gen);
+        double lat2 = std::max(-80.0, std::min(80.0, lat1 + offsetDist(gen)));
+        double lon2 = lon1 + offsetDist(gen);
+        double expected = haversineKm(lat1, lon1, lat2, lon2);
+        double d = fastDistanceKm(lat1, lon1, lat2, lon2);
+        REQUIRE(std::abs(d - expected) <= expected * FAST_DISTANCE_MAX_ERROR + 1e-9);
+    }
+}
+
+struct TilePoint {
+    const char* name;
+    double lat, lon;
+    double tileX, tileY; // fractional tile position at zoom 10
+};
+
+static const TilePoint TILE_POINTS[] = {
+    {"Amsterdam", 52.3676, 4.9041, 525.949440, 336.537267},
+    {"London", 51.5074, -0.1278, 511.636480, 340.506135},
+    {"Sydney", -33.8688, 151.2093, 942.106453, 614.494465},
+    {"Null Island", 0.0, 0.0, 512.0, 512.0},
+    {"Antimeridian, Mercator limit", 85.0511287798, 180.0, 1024.0, 0.0},
+};
+
+TEST_CASE("Mercator matches slippy-map tile positions", "[geodesy]") {
+    for (const TilePoint& point : TILE_POINTS) {
+        INFO(point.name);
+        CHECK(lonToMercatorX(point.lon) * 1024.0 == Approx(point.tileX).margin(1e-5));
+        CHECK(latToMercatorY(point.lat) * 1024.0 == Approx(point.tileY).margin(1e-5));
+        CHECK(mercatorXToLon(point.tileX / 1024.0) == Approx(point.lon).margin(1e-8));
+        CHECK(mercatorYToLat(point.tileY / 1024.0) == Approx(point.lat).margin(1e-8));
+    }
+}
+
+TEST_CASE("Mercator round-trips, one point or a batch", "[geodesy]") {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> latDist(-85.0, 85.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+
+    // Odd, so any unrolled loop has a tail
+    const size_t count = 1003;
+    std::vector<double> lats(count), lons(count), xs(count), ys(count);
+    for (size_t i = 0; i < count; i++) {
+        lats[i] = latDist(gen);
+        lons[i] = lonDist(gen);
+    }
+    latLonToMercatorBatch(lats.data(), lons.data(), count, xs.data(), ys.data());
+
+    for (size_t i = 0; i < count; i++) {
+        REQUIRE(xs[i] == lonToMercatorX(lons[i]));
+        REQUIRE(ys[i] == latToMercatorY(lats[i]));
+        REQUIRE(mercatorXToLon(xs[i]) == Approx(lons[i]).margin(1e-9));
+        REQUIRE(mercatorYToLat(ys[i]) == Approx(lats[i]).margin(1e-9));
+    }
+}
+
+TEST_CASE("A local frame keeps short distances within its stated error", "[geodesy]") {
+    // Axes: a degree north is the same everywhere, a degree east shrinks
+    // with the origin's latitude
+    LocalFrame frame(60.0, 10.0);
+    double east, north;
+    frame.toLocal(60.0, 10.0, east, north);
+    CHECK(east == 0.0);
+    CHECK(north == 0.0);
+    frame.toLocal(61.0, 11.0, east, north);
+    CHECK(north == Approx(EARTH_RADIUS_KM * M_PI / 180.0));
+    CHECK(east == Approx(EARTH_RADIUS_KM * M_PI / 180.0 * 0.5));
+
+    // Points within 20 km, below 60 degrees, against the sphere
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> latDist(-60.0, 60.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+    std::uniform_real_distribution<double> offsetDist(-14.0, 14.0);
+    for (int i = 0; i < 1000; i++) {
+        double originLat = latDist(gen);
+        double originLon = lonDist(gen);
+        LocalFrame local(originLat, originLon);
+        double offsetEast = offsetDist(gen);
+        double offsetNorth = offsetDist(gen);
+
+        double lat, lon;
+        local.toLatLon(offsetEast, offsetNorth, lat, lon);
+        local.toLocal(lat, lon, east, north);
+        REQUIRE(east == Approx(offsetEast).margin(1e-9));
+        REQUIRE(north == Approx(offsetNorth).margin(1e-9));
+
+        double expected = haversineKm(originLat, originLon, lat, lon);
+        double d = std::sqrt(east * east + north * north);
+        REQUIRE(std::abs(d - expected) <= expected * 1e-3 + 1e-9);
+    }
+}
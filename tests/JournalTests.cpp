@@ -0,0 +1,183 @@
+#include "Journal.h"
+#include "Snapshot.h"
+#include "World.h"
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+
+// A fresh directory per test, so stale segments never leak into replay
+static std::string makeJournalBase(const char* name) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return (directory / "autosave.journal").string();
+}
+
+static void buildWorld(World& world) {
+    world.setReporting(false);
+    world.setPopulation({{52.37, 4.90, 5.0, 800000}, {52.33, 4.95, 5.0, 800000}});
+}
+
+// Every record of every segment from the first one on, as Game replays them
+static std::vector<JournalRecord> readFrom(const std::string& basePath, int segment) {
+    std::vector<JournalRecord> records;
+    while (Journal::readSegment(Journal::segmentPath(basePath, segment), records)) {
+        segment++;
+    }
+    return records;
+}
+
+TEST_CASE("A crashed session recovers from its snapshot and journal", "[journal]") {
+    std::string basePath = makeJournalBase("trainbuilder_journal_recovery");
+    std::string snapshotPath = basePath + ".tbsave";
+
+    World world;
+    buildWorld(world);
+    Journal journal;
+    REQUIRE(journal.open(basePath, 0));
+    world.setJournal(&journal);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.buildLine(0, 1));
+    REQUIRE(world.addTrain(0));
+    for (int tick = 0; tick < 100; tick++) {
+        world.update(1.0f);
+    }
+
+    // Compaction: the snapshot covers everything before the rotation
+    SnapshotWorld header{};
+    header.journalSegment = journal.rotate();
+    REQUIRE(world.writeSnapshot(snapshotPath, header));
+    Journal::removeSegmentsBefore(basePath, header.journalSegment);
+
+    for (int tick = 0; tick < 50; tick++) {
+        world.update(1.0f);
+    }
+    REQUIRE(world.placeStation(52.30, 4.90));
+    REQUIRE(world.buildLine(1, 2));
+    REQUIRE(world.addTrain(1));
+    REQUIRE(world.addTrain(0));
+    REQUIRE(world.removeTrain(world.getTrainHandle(0)));
+    double money = world.getEconomy().getMoney();
+
+    // The process dies; only what reached disk survives
+    journal.close();
+    world.setJournal(nullptr);
+
+    World recovered;
+    buildWorld(recovered);
+    SnapshotReader reader;
+    REQUIRE(reader.open(snapshotPath));
+    REQUIRE(World::validateSnapshot(reader));
+    recovered.loadSnapshot(reader);
+    int segment = reader.getSection<SnapshotWorld>(SnapshotSection::WORLD)[0].journalSegment;
+    for (const JournalRecord& record : readFrom(basePath, segment)) {
+        recovered.applyJournalRecord(record);
+    }
+
+    CHECK(recovered.getStations().size() == world.getStations().size());
+    CHECK(recovered.getLines().size() == world.getLines().size());
+    CHECK(recovered.getTrains().size() == world.getTrains().size());
+    CHECK(recovered.getTrain(recovered.getTrainHandle(0)) == nullptr);
+    CHECK(recovered.getTrain(recovered.getTrainHandle(1)) != nullptr);
+    CHECK(recovered.getTrain(recovered.getTrainHandle(2)) != nullptr);
+    CHECK(recovered.getLines().atIndex(1).getStation2() == 2);
+    CHECK(recovered.getEconomy().getMoney() == Approx(money));
+    std::filesystem::remove_all(std::filesystem::path(basePath).parent_path());
+}
+
+TEST_CASE("Folding the journal into a snapshot matches recovering from it", "[journal]") {
+    std::string basePath = makeJournalBase("trainbuilder_journal_fold");
+    std::string snapshotPath = basePath + ".tbsave";
+    std::string foldedPath = basePath + ".folded.tbsave";
+
+    World world;
+    buildWorld(world);
+    SnapshotWorld header{};
+    REQUIRE(world.writeSnapshot(snapshotPath, header));
+    Journal journal;
+    REQUIRE(journal.open(basePath, 0));
+    world.setJournal(&journal);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.buildLine(0, 1));
+    REQUIRE(world.addTrain(0));
+    for (int tick = 0; tick < 100; tick++) {
+        world.update(1.0f);
+    }
+    REQUIRE(world.placeStation(52.30, 4.90));
+
+    // Compaction as the game does it, without touching the live world
+    header.journalSegment = journal.rotate();
+    journal.waitForSegment(header.journalSegment);
+    REQUIRE(World::foldJournal(snapshotPath, basePath, 0, header.journalSegment, header, foldedPath));
+
+    REQUIRE(world.buildLine(1, 2));
+    REQUIRE(world.addTrain(1));
+    journal.close();
+    world.setJournal(nullptr);
+
+    // Recovered either way, the worlds are the same
+    World fromOld;
+    World fromFolded;
+    for (World* recovered : {&fromOld, &fromFolded}) {
+        buildWorld(*recovered);
+        SnapshotReader reader;
+        REQUIRE(reader.open(recovered == &fromOld ? snapshotPath : foldedPath));
+        REQUIRE(World::validateSnapshot(reader));
+        recovered->loadSnapshot(reader);
+        int segment = reader.getSection<SnapshotWorld>(SnapshotSection::WORLD)[0].journalSegment;
+        for (const JournalRecord& record : readFrom(basePath, segment)) {
+            recovered->applyJournalRecord(record);
+        }
+    }
+    CHECK(fromFolded.getStations().size() == 3);
+    CHECK(fromFolded.getLines().size() == 2);
+    CHECK(fromFolded.getTrains().size() == 2);
+    CHECK(fromFolded.computeHash() == fromOld.computeHash());
+    std::filesystem::remove_all(std::filesystem::path(basePath).parent_path());
+}
+
+TEST_CASE("Replay stops at a torn or damaged record", "[journal]") {
+    std::string basePath = makeJournalBase("trainbuilder_journal_torn");
+    std::string path = Journal::segmentPath(basePath, 0);
+
+    World world;
+    buildWorld(world);
+    Journal journal;
+    REQUIRE(journal.open(basePath, 0));
+    world.setJournal(&journal);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.placeStation(52.30, 4.90));
+    journal.close();
+    world.setJournal(nullptr);
+    REQUIRE(readFrom(basePath, 0).size() == 3);
+
+    // A write cut short by the crash
+    std::filesystem::resize_file(path, 2 * sizeof(JournalRecord) + sizeof(JournalRecord) / 2);
+    CHECK(readFrom(basePath, 0).size() == 2);
+
+    // A flipped byte inside the second record
+    {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        REQUIRE(file);
+        std::fseek(file, sizeof(JournalRecord) + offsetof(JournalRecord, values), SEEK_SET);
+        int byte = std::fgetc(file);
+        std::fseek(file, sizeof(JournalRecord) + offsetof(JournalRecord, values), SEEK_SET);
+        std::fputc(byte ^ 0x40, file);
+        std::fclose(file);
+    }
+    std::vector<JournalRecord> records = readFrom(basePath, 0);
+    REQUIRE(records.size() == 1);
+
+    World recovered;
+    buildWorld(recovered);
+    for (const JournalRecord& record : records) {
+        recovered.applyJournalRecord(record);
+    }
+    CHECK(recovered.getStations().size() == 1);
+    CHECK(recovered.getStations().atIndex(0).getLat() == world.getStations().atIndex(0).getLat());
+    std::filesystem::remove_all(std::filesystem::path(basePath).parent_path());
+}
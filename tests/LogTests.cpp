@@ -0,0 +1,77 @@
+#include "Log.h"
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+// Points a standard stream's descriptor at a file until destroyed, so the
+// log writer's output can be read back
+class RedirectScope {
+public:
+    RedirectScope(std::FILE* stream, const std::string& path)
+        : stream(stream)
+        , fd(fileno(stream))
+    {
+        std::fflush(stream);
+        saved = dup(fd);
+        int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(file, fd);
+        close(file);
+    }
+    ~RedirectScope() {
+        std::fflush(stream);
+        dup2(saved, fd);
+        close(saved);
+    }
+
+private:
+    std::FILE* stream;
+    int fd;
+    int saved;
+};
+
+TEST_CASE("A full log ring drops and counts rather than blocking", "[log]") {
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string outPath = (directory / "trainbuilder_log_test.out").string();
+    std::string errPath = (directory / "trainbuilder_log_test.err").string();
+
+    // Far more than the ring's 4096 slots, faster than the writer drains them
+    const int burst = 1 << 18;
+    Log::flush();
+    uint64_t before = Log::getDroppedCount();
+    {
+        RedirectScope out(stdout, outPath);
+        RedirectScope err(stderr, errPath);
+        for (int i = 0; i < burst; i++) {
+            LOG_INFO("message {}", i);
+        }
+        Log::flush();
+        // The ring is usable again once drained
+        LOG_INFO("after the burst");
+        Log::flush();
+    }
+    uint64_t dropped = Log::getDroppedCount() - before;
+    CHECK(dropped > 0);
+
+    // Every message was either written or counted as dropped
+    std::ifstream written(outPath);
+    std::string line;
+    std::string last;
+    long lines = 0;
+    while (std::getline(written, line)) {
+        lines++;
+        last = line;
+    }
+    CHECK(lines + (long)dropped == burst + 1);
+    CHECK(last == "after the burst");
+
+    std::ifstream errors(errPath);
+    std::string report((std::istreambuf_iterator<char>(errors)), std::istreambuf_iterator<char>());
+    CHECK(report.find("Log queue full, dropped") != std::string::npos);
+    std::remove(outPath.c_str());
+    std::remove(errPath.c_str());
+}
@@ -0,0 +1,99 @@
+#include "NetworkGraph.h"
+#include "World.h"
+#include "Scenario.h"
+#include <catch2/catch.hpp>
+#include <tuple>
+#include <vector>
+
+typedef std::tuple<int, int, float, float> EdgeView; // target station, line, length, time
+
+// A station's edges in station-id terms, so graphs numbered differently
+// can be compared
+static std::vector<EdgeView> edgesOf(const NetworkGraph& graph, int stationId) {
+    std::vector<EdgeView> edges;
+    int node = graph.toNode(stationId);
+    for (int e = graph.edgeBegin(node); e < graph.edgeEnd(node); e++) {
+        edges.emplace_back(graph.toStation(graph.getTarget(e)), graph.getLine(e),
+                           graph.getLength(e), graph.getTravelTime(e));
+    }
+    return edges;
+}
+
+// The world's patched graph against a full build of the same network
+static void checkMatchesBuild(const World& world) {
+    const NetworkGraph& patched = world.getNetworkGraph();
+    NetworkGraph built;
+    built.build(world.getStations().values(), world.getLines().values(), world.getTimetable());
+
+    REQUIRE(patched.getNodeCount() == built.getNodeCount());
+    REQUIRE(patched.getEdgeCount() == built.getEdgeCount());
+    REQUIRE(patched.getStationSlotCount() == built.getStationSlotCount());
+    for (int stationId = 0; stationId < built.getStationSlotCount(); stationId++) {
+        INFO("station " << stationId);
+        REQUIRE((patched.toNode(stationId) < 0) == (built.toNode(stationId) < 0));
+        if (built.toNode(stationId) < 0) continue;
+
+        int node = patched.toNode(stationId);
+        CHECK(patched.toStation(node) == stationId);
+        CHECK(patched.getLat(node) == built.getLat(built.toNode(stationId)));
+        CHECK(patched.getLon(node) == built.getLon(built.toNode(stationId)));
+        CHECK(edgesOf(patched, stationId) == edgesOf(built, stationId));
+    }
+}
+
+TEST_CASE("Patching the graph matches rebuilding it", "[graph]") {
+    World world;
+    world.setReporting(false);
+    ScenarioOptions options;
+    options.stationCount = 30;
+    options.extraLineCount = 15;
+    options.populationCenters = 5;
+    // A small box, so the edits below stay affordable
+    options.maxLat = options.minLat + 0.1;
+    options.maxLon = options.minLon + 0.1;
+    buildScenario(world, options);
+    checkMatchesBuild(world);
+
+    // Lines out of id order, so new edges land mid-row
+    REQUIRE(world.removeLine(world.getLineHandle(3)));
+    REQUIRE(world.removeLine(world.getLineHandle(10)));
+    checkMatchesBuild(world);
+    REQUIRE(world.buildLine(0, 20));
+    REQUIRE(world.buildLine(5, 25));
+    checkMatchesBuild(world);
+
+    // A station in the middle of the numbering, with all its lines
+    REQUIRE(world.removeStation(world.getStationHandle(12)));
+    checkMatchesBuild(world);
+    // And the highest id, which shrinks the slot count
+    REQUIRE(world.removeStation(world.getStationHandle(29)));
+    checkMatchesBuild(world);
+
+    REQUIRE(world.placeStation(options.minLat + 0.05, options.minLon + 0.05));
+    REQUIRE(world.buildLine(12, 0));
+    checkMatchesBuild(world);
+}
+
+TEST_CASE("A Hilbert build renumbers nodes without changing the network", "[graph]") {
+    World world;
+    world.setReporting(false);
+    ScenarioOptions options;
+    options.stationCount = 50;
+    options.extraLineCount = 25;
+    options.populationCenters = 5;
+    buildScenario(world, options);
+
+    NetworkGraph plain;
+    plain.build(world.getStations().values(), world.getLines().values(), world.getTimetable());
+    NetworkGraph ordered;
+    ordered.build(world.getStations().values(), world.getLines().values(), world.getTimetable(),
+                  NetworkGraph::Ordering::HILBERT);
+
+    bool renumbered = false;
+    for (int stationId = 0; stationId < plain.getStationSlotCount(); stationId++) {
+        REQUIRE(ordered.toStation(ordered.toNode(stationId)) == stationId);
+        renumbered = renumbered || ordered.toNode(stationId) != plain.toNode(stationId);
+        CHECK(edgesOf(ordered, stationId) == edgesOf(plain, stationId));
+    }
+    CHECK(renumbered);
+}
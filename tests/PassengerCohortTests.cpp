@@ -0,0 +1,118 @@
+#include "PassengerCohort.h"
+#include "World.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("Cohorts with the same key merge", "[cohort]") {
+    CohortArena arena;
+    CohortPool pool;
+    pool.add(arena, 0, 1, 10, 0.0f);
+    pool.add(arena, 0, 1, 5, 0.0f);
+    pool.add(arena, 0, 1, 5, 300.0f);
+    pool.add(arena, 0, 2, 5, 0.0f);
+    CHECK(pool.getCount() == 25);
+    CHECK(pool.getCohortCount() == 3);
+    CHECK(arena.getLiveCount() == 3);
+}
+
+TEST_CASE("Cohorts still merge after others leave the pool", "[cohort]") {
+    CohortArena arena;
+    CohortPool platform;
+    CohortPool train;
+    for (int destination = 1; destination <= 4; destination++) {
+        platform.add(arena, 0, destination, 10, 0.0f);
+    }
+
+    // Removals reorder the pool; lookups must follow the cohorts
+    platform.transfer(arena, train, 100, [](const PassengerCohort& cohort) { return cohort.destination == 1; });
+    platform.remove(arena, [](const PassengerCohort& cohort) { return cohort.destination == 2; });
+    platform.add(arena, 0, 4, 5, 0.0f);
+    platform.add(arena, 0, 3, 5, 0.0f);
+    platform.add(arena, 0, 2, 5, 0.0f);
+    CHECK(platform.getCohortCount() == 3);
+    CHECK(platform.getCount() == 35);
+
+    // A cohort arriving by transfer merges into one already riding
+    train.add(arena, 0, 3, 1, 0.0f);
+    platform.transfer(arena, train, 100, [](const PassengerCohort& cohort) { return cohort.destination == 3; });
+    CHECK(train.getCohortCount() == 2);
+    CHECK(train.getCount() == 26);
+    CHECK(arena.getLiveCount() == 4);
+
+    platform.clear(arena);
+    platform.add(arena, 0, 4, 5, 0.0f);
+    CHECK(platform.getCohortCount() == 1);
+    CHECK(platform.getCount() == 5);
+}
+
+TEST_CASE("Transfers split at the limit", "[cohort]") {
+    CohortArena arena;
+    CohortPool platform;
+    CohortPool train;
+    platform.add(arena, 0, 1, 30, 0.0f);
+    platform.add(arena, 0, 2, 30, 0.0f);
+
+    int moved = platform.transfer(arena, train, 20, [](const PassengerCohort& cohort) {
+        return cohort.destination == 1;
+    });
+    CHECK(moved == 20);
+    CHECK(train.getCount() == 20);
+    CHECK(platform.getCount() == 40);
+    CHECK(platform.getCohortCount() == 2);
+}
+
+TEST_CASE("Expiry drops only cohorts older than the cutoff", "[cohort]") {
+    CohortArena arena;
+    CohortPool pool;
+    pool.add(arena, 0, 1, 10, 0.0f);
+    pool.add(arena, 0, 1, 20, 300.0f);
+    pool.add(arena, 0, 2, 40, 600.0f);
+
+    CHECK(pool.expire(arena, 300.0f) == 10);
+    CHECK(pool.getCount() == 60);
+    CHECK(pool.getCohortCount() == 2);
+    CHECK(arena.getLiveCount() == 2);
+
+    CHECK(pool.expire(arena, 300.0f) == 0);
+    CHECK(pool.expire(arena, 1e9f) == 60);
+    CHECK(pool.getCount() == 0);
+    CHECK(arena.getLiveCount() == 0);
+}
+
+// Two busy towns a short shuttle apart
+static void buildShuttle(World& world) {
+    world.setReporting(false);
+    world.setPopulation({{52.37, 4.90, 5.0, 800000}, {52.33, 4.95, 5.0, 800000}});
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.buildLine(0, 1));
+    REQUIRE(world.addTrain(0));
+}
+
+TEST_CASE("A new train boards on its first departure", "[cohort]") {
+    World world;
+    buildShuttle(world);
+
+    // Let riders gather while the first train is away
+    for (int tick = 0; tick < 600; tick++) {
+        world.update(1.0f);
+    }
+    REQUIRE(world.getStations().atIndex(0).getPassengerCount() > 0);
+
+    REQUIRE(world.addTrain(0));
+    int trainId = world.getLines().atIndex(0).getTrains().back();
+    world.update(1.0f);
+    CHECK(world.getTrains().atIndex(trainId).getPassengerCount() > 0);
+}
+
+TEST_CASE("Riders give up after the maximum wait", "[cohort]") {
+    World world;
+    buildShuttle(world);
+
+    // One train cannot keep up, so the platforms only ever grow
+    double horizon = World::MAX_WAIT * 2;
+    for (int tick = 0; tick < (int)horizon; tick++) {
+        world.update(1.0f);
+    }
+    CHECK(world.getPassengersAbandoned() > 0);
+    CHECK(world.getPassengersDelivered() > 0);
+}
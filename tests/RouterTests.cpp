@@ -0,0 +1,126 @@
+#include "Router.h"
+#include "World.h"
+#include "Scenario.h"
+#include <catch2/catch.hpp>
+
+// A standalone router over a scenario world's network
+static void addLines(Router& router, const World& world) {
+    const Timetable& timetable = world.getTimetable();
+    router.setStationCount(world.getStations().slotCount());
+    for (const TrainLine& line : world.getLines()) {
+        router.setLine(line.getId(), line.getStation1(), line.getStation2(),
+                       timetable.getLegTime(line.getId()), timetable.getHeadway(line.getId()));
+    }
+}
+
+static void buildWorld(World& world) {
+    ScenarioOptions options;
+    options.stationCount = 60;
+    options.extraLineCount = 30;
+    options.populationCenters = 10;
+    world.setReporting(false);
+    buildScenario(world, options);
+}
+
+TEST_CASE("An evicting router answers like an unbounded one", "[router]") {
+    World world;
+    buildWorld(world);
+    int count = world.getStations().slotCount();
+
+    Router unbounded;
+    Router evicting;
+    evicting.setCacheBudget(0);
+    addLines(unbounded, world);
+    addLines(evicting, world);
+
+    // Every update() empties the evicting cache, so each round rebuilds
+    for (int round = 0; round < 3; round++) {
+        unbounded.update(world.getNetworkGraph());
+        evicting.update(world.getNetworkGraph());
+        CHECK(evicting.getCachedTreeCount() == 0);
+        for (int to = 0; to < count; to++) {
+            for (int from = 0; from < count; from++) {
+                REQUIRE(evicting.getJourneyTime(from, to) == unbounded.getJourneyTime(from, to));
+                REQUIRE(evicting.getNextStation(from, to) == unbounded.getNextStation(from, to));
+            }
+        }
+    }
+    CHECK(unbounded.getCachedTreeCount() == count);
+}
+
+TEST_CASE("The route cache is trimmed to its budget", "[router]") {
+    World world;
+    buildWorld(world);
+    int count = world.getStations().slotCount();
+
+    Router router;
+    addLines(router, world);
+    router.update(world.getNetworkGraph());
+    for (int to = 0; to < count; to++) {
+        router.isReachable(0, to);
+    }
+    size_t perTree = router.getCacheBytes() / count;
+    router.setCacheBudget(perTree * 10);
+
+    // Touch a few trees again so they are the most recently used
+    router.update(world.getNetworkGraph());
+    for (int to = 0; to < 5; to++) {
+        router.isReachable(0, to);
+    }
+    router.update(world.getNetworkGraph());
+    CHECK(router.getCacheBytes() <= perTree * 10);
+    CHECK(router.getCachedTreeCount() == 10);
+    CHECK(router.getCachedTreeCount() == (int)(router.getCacheBytes() / perTree));
+}
+
+TEST_CASE("The route cache budget is enforced once per tick", "[router]") {
+    World world;
+    buildWorld(world);
+    int count = world.getStations().slotCount();
+
+    Router router;
+    addLines(router, world);
+    router.update(world.getNetworkGraph());
+    router.isReachable(0, 0);
+    size_t perTree = router.getCacheBytes();
+    router.setCacheBudget(perTree * 10);
+
+    // Within a tick every tree queried stays, however far over budget
+    for (int to = 0; to < count; to++) {
+        router.isReachable(0, to);
+    }
+    CHECK(router.getCachedTreeCount() == count);
+    CHECK(router.getCacheBytes() > perTree * 10);
+
+    router.update(world.getNetworkGraph());
+    CHECK(router.getCacheBytes() <= perTree * 10);
+}
+
+TEST_CASE("Stations added later are unreachable until connected", "[router]") {
+    World world;
+    world.setReporting(false);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.buildLine(0, 1));
+    REQUIRE(world.addTrain(0));
+
+    Router router;
+    addLines(router, world);
+    router.update(world.getNetworkGraph());
+    REQUIRE(router.isReachable(0, 1));
+
+    // The cached tree for station 1 predates station 2
+    REQUIRE(world.placeStation(52.30, 4.90));
+    router.setStationCount(world.getStations().slotCount());
+    router.update(world.getNetworkGraph());
+    CHECK_FALSE(router.isReachable(2, 1));
+    CHECK(router.getNextLine(2, 1) == -1);
+
+    REQUIRE(world.buildLine(1, 2));
+    REQUIRE(world.addTrain(1));
+    addLines(router, world);
+    router.update(world.getNetworkGraph());
+    CHECK(router.isReachable(2, 1));
+    CHECK(router.isReachable(2, 0));
+    CHECK(router.getNextStation(2, 0) == 1);
+}
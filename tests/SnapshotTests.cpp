@@ -0,0 +1,122 @@
+#include "Scenario.h"
+#include "Snapshot.h"
+#include "World.h"
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <filesystem>
+
+static std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static void buildWorld(World& world) {
+    ScenarioOptions options;
+    options.stationCount = 40;
+    options.extraLineCount = 20;
+    options.populationCenters = 10;
+    options.maxLat = options.minLat + 0.1;
+    options.maxLon = options.minLon + 0.1;
+    world.setReporting(false);
+    buildScenario(world, options);
+}
+
+static bool load(World& world, const std::string& path) {
+    SnapshotReader reader;
+    if (!reader.open(path) || !World::validateSnapshot(reader)) {
+        return false;
+    }
+    world.setReporting(false);
+    world.loadSnapshot(reader);
+    return true;
+}
+
+TEST_CASE("A loaded snapshot hashes like the world it came from", "[snapshot]") {
+    World world;
+    buildWorld(world);
+    for (int tick = 0; tick < 300; tick++) {
+        world.update(1.0f);
+    }
+    REQUIRE(world.getPassengersDelivered() > 0);
+
+    std::string path = tempPath("trainbuilder_snapshot_test.tbsave");
+    REQUIRE(world.writeSnapshot(path, SnapshotWorld{}));
+    World loaded;
+    REQUIRE(load(loaded, path));
+    std::remove(path.c_str());
+
+    CHECK(loaded.computeHash() == world.computeHash());
+    CHECK(loaded.getStations().size() == world.getStations().size());
+    CHECK(loaded.getTrains().size() == world.getTrains().size());
+    CHECK(loaded.getDemandModel().getNonZeroCount() == world.getDemandModel().getNonZeroCount());
+}
+
+TEST_CASE("A loaded snapshot keeps ticking like the original", "[snapshot]") {
+    World world;
+    buildWorld(world);
+    for (int tick = 0; tick < 300; tick++) {
+        world.update(1.0f);
+    }
+
+    std::string path = tempPath("trainbuilder_snapshot_resume.tbsave");
+    REQUIRE(world.writeSnapshot(path, SnapshotWorld{}));
+    World loaded;
+    REQUIRE(load(loaded, path));
+    std::remove(path.c_str());
+
+    // The saved demand rows carry their pending trips, so both spawn the
+    // same riders from here on
+    for (int tick = 0; tick < 600; tick++) {
+        world.update(1.0f);
+        loaded.update(1.0f);
+        REQUIRE(loaded.computeHash() == world.computeHash());
+    }
+}
+
+TEST_CASE("A snapshot keeps the ids removals left behind", "[snapshot]") {
+    World world;
+    buildWorld(world);
+    for (int tick = 0; tick < 300; tick++) {
+        world.update(1.0f);
+    }
+    // Holes in the middle of every table and at the end of the lines'
+    REQUIRE(world.removeStation(world.getStationHandle(7)));
+    REQUIRE(world.removeLine(world.getLineHandle((int)world.getLines().slotCount() - 1)));
+    REQUIRE(world.removeTrain(world.getTrainHandle(world.getLines().values()[0].getTrains()[0])));
+    for (int tick = 0; tick < 100; tick++) {
+        world.update(1.0f);
+    }
+
+    std::string path = tempPath("trainbuilder_snapshot_removals.tbsave");
+    REQUIRE(world.writeSnapshot(path, SnapshotWorld{}));
+    World loaded;
+    REQUIRE(load(loaded, path));
+    std::remove(path.c_str());
+    REQUIRE(loaded.computeHash() == world.computeHash());
+    CHECK_FALSE(loaded.getStations().containsIndex(7));
+
+    // New entities land in the same slots in both; the scenario's upkeep
+    // has spent the starting money by now
+    world.getEconomy().earnMoney(1e6);
+    loaded.getEconomy().earnMoney(1e6);
+    REQUIRE(world.placeStation(52.10, 4.80));
+    REQUIRE(loaded.placeStation(52.10, 4.80));
+    REQUIRE(world.buildLine(7, 0));
+    REQUIRE(loaded.buildLine(7, 0));
+    for (int tick = 0; tick < 600; tick++) {
+        world.update(1.0f);
+        loaded.update(1.0f);
+        REQUIRE(loaded.computeHash() == world.computeHash());
+    }
+}
+
+TEST_CASE("A truncated snapshot is rejected", "[snapshot]") {
+    World world;
+    buildWorld(world);
+    std::string path = tempPath("trainbuilder_snapshot_truncated.tbsave");
+    REQUIRE(world.writeSnapshot(path, SnapshotWorld{}));
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    World loaded;
+    CHECK_FALSE(load(loaded, path));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,76 @@
+#include "Timetable.h"
+#include "World.h"
+#include <catch2/catch.hpp>
+
+// One line a few km long and nothing else
+static void buildLine(World& world) {
+    world.setReporting(false);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.33, 4.95));
+    REQUIRE(world.buildLine(0, 1));
+}
+
+static void runUntil(World& world, double simTime) {
+    while (world.getSimClock() < simTime) {
+        world.update(1.0f);
+    }
+}
+
+TEST_CASE("Trains added together leave an even headway apart", "[timetable]") {
+    World world;
+    buildLine(world);
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(world.addTrain(0));
+    }
+
+    const Timetable& timetable = world.getTimetable();
+    double period = timetable.getPeriod(0);
+    REQUIRE(period > 0.0);
+    CHECK(timetable.getEpoch(0) == Approx(0.0));
+    CHECK(timetable.getEpoch(1) == Approx(period / 3.0));
+    CHECK(timetable.getEpoch(2) == Approx(2.0 * period / 3.0));
+    CHECK(timetable.getHeadway(0) == Approx(period / 3.0));
+
+    // A train waits at station1 until its departure
+    TrainState waiting = timetable.getTrainState(2, period / 2.0);
+    CHECK(waiting.position == 0.0);
+    CHECK(waiting.legIndex == 0);
+    CHECK(waiting.nextArrivalTime == Approx(2.0 * period / 3.0 + timetable.getLegTime(0)));
+}
+
+TEST_CASE("A train added later follows the last departure", "[timetable]") {
+    World world;
+    buildLine(world);
+    REQUIRE(world.addTrain(0));
+    const Timetable& timetable = world.getTimetable();
+    double period = timetable.getPeriod(0);
+
+    // Early in the first train's second round trip
+    runUntil(world, period * 1.1);
+    REQUIRE(world.addTrain(0));
+    CHECK(timetable.getEpoch(0) == Approx(0.0));
+    CHECK(timetable.getEpoch(1) == Approx(period * 1.5));
+    CHECK(timetable.getHeadway(0) == Approx(period / 2.0));
+
+    // Running trains keep their epochs through later compiles
+    REQUIRE(world.addTrain(0));
+    CHECK(timetable.getEpoch(0) == Approx(0.0));
+}
+
+TEST_CASE("The headway reflects bunched trains", "[timetable]") {
+    World world;
+    buildLine(world);
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(world.addTrain(0));
+    }
+    const Timetable& timetable = world.getTimetable();
+    double period = timetable.getPeriod(0);
+    runUntil(world, period);
+
+    // Gaps of two thirds and one third of the period: a rider is twice as
+    // likely to arrive in the long one
+    REQUIRE(world.removeTrain(world.getTrainHandle(1)));
+    CHECK(timetable.getTrainCount(0) == 2);
+    CHECK(timetable.getHeadway(0) == Approx(period * 5.0 / 9.0));
+    CHECK(timetable.getHeadway(0) > period / 2.0);
+}
@@ -0,0 +1,157 @@
+#include "World.h"
+#include "Scenario.h"
+#include <catch2/catch.hpp>
+
+static const float TICK_SECONDS = 1.0f / 60.0f;
+
+static ScenarioOptions smallScenario() {
+    ScenarioOptions options;
+    options.stationCount = 40;
+    options.extraLineCount = 20;
+    options.populationCenters = 10;
+    return options;
+}
+
+TEST_CASE("Scenarios are deterministic", "[world]") {
+    World first;
+    World second;
+    first.setReporting(false);
+    second.setReporting(false);
+    buildScenario(first, smallScenario());
+    buildScenario(second, smallScenario());
+    CHECK(first.computeHash() == second.computeHash());
+
+    for (int tick = 0; tick < 600; tick++) {
+        first.update(TICK_SECONDS);
+        second.update(TICK_SECONDS);
+    }
+    CHECK(first.computeHash() == second.computeHash());
+    CHECK(first.getEconomy().getMoney() == second.getEconomy().getMoney());
+}
+
+TEST_CASE("The seed changes the network", "[world]") {
+    World first;
+    World second;
+    first.setReporting(false);
+    second.setReporting(false);
+    ScenarioOptions options = smallScenario();
+    buildScenario(first, options);
+    options.seed = 2;
+    buildScenario(second, options);
+    CHECK(first.computeHash() != second.computeHash());
+}
+
+TEST_CASE("Commands charge the economy", "[world]") {
+    World world;
+    world.setReporting(false);
+    const Economy& economy = world.getEconomy();
+    double money = economy.getMoney();
+
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.09, 5.12));
+    CHECK(economy.getMoney() == Approx(money - 2 * economy.getStationBuildCost()));
+    money = economy.getMoney();
+
+    REQUIRE(world.buildLine(0, 1));
+    double lineCost = world.getDistance(0, 1) * economy.getLineBuildCostPerKm();
+    CHECK(economy.getMoney() == Approx(money - lineCost));
+    money = economy.getMoney();
+
+    REQUIRE(world.addTrain(0));
+    CHECK(economy.getMoney() == Approx(money - economy.getTrainPurchaseCost()));
+    CHECK(world.getLines().atIndex(0).getTrains().size() == 1u);
+}
+
+TEST_CASE("A removed train's handle goes null", "[world]") {
+    World world;
+    world.setReporting(false);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.09, 5.12));
+    REQUIRE(world.buildLine(0, 1));
+    REQUIRE(world.addTrain(0));
+
+    TrainHandle handle = world.getTrainHandle(0);
+    REQUIRE(world.getTrain(handle) != nullptr);
+    CHECK(world.removeTrain(handle));
+    CHECK(world.getTrain(handle) == nullptr);
+    CHECK_FALSE(world.removeTrain(handle));
+    CHECK(world.getLines().atIndex(0).getTrains().empty());
+}
+
+TEST_CASE("Trains left on a line keep their positions", "[world]") {
+    World world;
+    world.setReporting(false);
+    REQUIRE(world.placeStation(52.37, 4.90));
+    REQUIRE(world.placeStation(52.09, 5.12));
+    REQUIRE(world.buildLine(0, 1));
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(world.addTrain(0));
+    }
+
+    // The last train fills the first one's place
+    REQUIRE(world.removeTrain(world.getTrainHandle(0)));
+    REQUIRE(world.removeTrain(world.getTrainHandle(2)));
+    const std::vector<int>& lineTrains = world.getLines().atIndex(0).getTrains();
+    REQUIRE(lineTrains.size() == 2u);
+    for (int position = 0; position < (int)lineTrains.size(); position++) {
+        CHECK(world.getTrains().atIndex(lineTrains[position]).getLinePosition() == position);
+    }
+    CHECK(world.removeTrain(world.getTrainHandle(3)));
+    CHECK(world.removeTrain(world.getTrainHandle(1)));
+    CHECK(lineTrains.empty());
+}
+
+TEST_CASE("A removed station takes its lines and trains with it", "[world]") {
+    World world;
+    world.setReporting(false);
+    ScenarioOptions options = smallScenario();
+    // A small box, so trains arrive within the run
+    options.maxLat = options.minLat + 0.1;
+    options.maxLon = options.minLon + 0.1;
+    buildScenario(world, options);
+    for (int tick = 0; tick < 300; tick++) {
+        world.update(1.0f);
+    }
+
+    int stationId = 5;
+    StationHandle station = world.getStationHandle(stationId);
+    std::vector<LineHandle> lines;
+    std::vector<TrainHandle> trains;
+    for (int lineId : world.getStation(station)->getConnectedLines()) {
+        lines.push_back(world.getLineHandle(lineId));
+        for (int trainId : world.getLines().atIndex(lineId).getTrains()) {
+            trains.push_back(world.getTrainHandle(trainId));
+        }
+    }
+    REQUIRE_FALSE(lines.empty());
+    REQUIRE_FALSE(trains.empty());
+    size_t stationCount = world.getStations().size();
+    size_t lineCount = world.getLines().size();
+
+    REQUIRE(world.removeStation(station));
+    CHECK(world.getStation(station) == nullptr);
+    for (LineHandle line : lines) {
+        CHECK(world.getLine(line) == nullptr);
+    }
+    for (TrainHandle train : trains) {
+        CHECK(world.getTrain(train) == nullptr);
+    }
+    CHECK(world.getStations().size() == stationCount - 1);
+    CHECK(world.getLines().size() == lineCount - lines.size());
+    CHECK_FALSE(world.removeStation(station));
+
+    // The rest of the network keeps running around the hole
+    for (int tick = 0; tick < 300; tick++) {
+        world.update(1.0f);
+    }
+    CHECK(world.getPassengersDelivered() > 0);
+
+    // The next station takes the slot under a new generation
+    world.getEconomy().earnMoney(1e6);
+    REQUIRE(world.placeStation(52.10, 4.80));
+    StationHandle replacement = world.getStationHandle(stationId);
+    CHECK(replacement.index == station.index);
+    CHECK(replacement != station);
+    CHECK(world.getStation(station) == nullptr);
+    CHECK(world.getStation(replacement) != nullptr);
+}